@@ -0,0 +1,438 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+#ifndef SEGGER_JLINK_SDK_DRTM_ALLOCATION_TRACKER_H_
+#define SEGGER_JLINK_SDK_DRTM_ALLOCATION_TRACKER_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Registry of the live blocks allocated via
+     * `allocator`, thus via the server `malloc()` function.
+     *
+     * @details
+     * The GDB server has no call to end a plug-in session, and the
+     * plug-in lives as long as the server process, so blocks that
+     * are never freed accumulate over long sessions. Each block
+     * allocated by the tracker is preceded by a small header that
+     * links it in a doubly linked list, so registering and
+     * unregistering a block are O(1) and need no other memory.
+     *
+     * The tracker keeps the number of live blocks and bytes and
+     * their peaks, can print them via the backend `output_debug()`
+     * and can return all live blocks to the server in one sweep,
+     * with `release_all()` or at destruction, for example when the
+     * plug-in library is unloaded:
+     *
+     * @code{.cpp}
+     * static allocation_tracker<rtos_plugin_server_api_t> tracker
+     *   { api };
+     *
+     * tracking_allocator<thread_t, rtos_plugin_server_api_t> a
+     *   { &tracker };
+     * @endcode
+     *
+     * Tracking is optional; containers use it by replacing
+     * `allocator` with `tracking_allocator`.
+     */
+    template<typename S>
+      class allocation_tracker
+      {
+      public:
+
+        using server_api_t = S;
+
+        /**
+         * @brief Allocation statistics.
+         */
+        struct stats_t
+        {
+          // Blocks and bytes currently allocated.
+          std::size_t live_blocks;
+          std::size_t live_bytes;
+          // Largest number of blocks and bytes simultaneously allocated.
+          std::size_t peak_blocks;
+          std::size_t peak_bytes;
+          // Allocations since construction.
+          std::size_t allocations;
+        };
+
+      public:
+
+        allocation_tracker (const server_api_t* api) noexcept :
+            blocks_ (api), //
+            stats_
+              { }
+        {
+#if defined(DEBUG)
+          printf ("%s(%p) @%p\n", __func__, api, this);
+#endif /* defined(DEBUG) */
+
+          head_.prev = &head_;
+          head_.next = &head_;
+          head_.bytes = 0;
+        }
+
+        // The rule of five.
+        allocation_tracker (const allocation_tracker&) = delete;
+        allocation_tracker (allocation_tracker&&) = delete;
+        allocation_tracker&
+        operator= (const allocation_tracker&) = delete;
+        allocation_tracker&
+        operator= (allocation_tracker&&) = delete;
+
+        /**
+         * @details
+         * The blocks still live are returned to the server; the
+         * tracker must outlive the containers using it.
+         */
+        ~allocation_tracker ()
+        {
+          release_all ();
+        }
+
+      public:
+
+        /**
+         * @brief Allocate and register a block.
+         *
+         * @param [in] bytes Size of the block.
+         *
+         * @return Pointer to the block, aligned to max_align_t. NULL,
+         *  if the memory could not be allocated.
+         */
+        void*
+        allocate (std::size_t bytes)
+        {
+          if (bytes / sizeof(block_t) > blocks_.max_size () - 2)
+            {
+              return nullptr;
+            }
+
+          block_t* block = blocks_.allocate (units_ (bytes));
+
+#if defined(DEBUG)
+          printf ("%s(%zu)=%p %p\n", __func__, bytes, block, this);
+#endif /* defined(DEBUG) */
+
+          if (block == nullptr)
+            {
+              return nullptr;
+            }
+
+          block->bytes = bytes;
+          block->prev = &head_;
+          block->next = head_.next;
+          head_.next->prev = block;
+          head_.next = block;
+
+          ++stats_.allocations;
+          if (++stats_.live_blocks > stats_.peak_blocks)
+            {
+              stats_.peak_blocks = stats_.live_blocks;
+            }
+          stats_.live_bytes += bytes;
+          if (stats_.live_bytes > stats_.peak_bytes)
+            {
+              stats_.peak_bytes = stats_.live_bytes;
+            }
+
+          return block + 1;
+        }
+
+        /**
+         * @brief Unregister a block and return it to the server.
+         */
+        void
+        deallocate (void* p) noexcept
+        {
+          if (p == nullptr)
+            {
+              return;
+            }
+
+#if defined(DEBUG)
+          printf ("%s(%p) %p\n", __func__, p, this);
+#endif /* defined(DEBUG) */
+
+          block_t* block = static_cast<block_t*> (p) - 1;
+          assert(block->next->prev == block && block->prev->next == block);
+
+          block->prev->next = block->next;
+          block->next->prev = block->prev;
+
+          assert(stats_.live_blocks > 0);
+          --stats_.live_blocks;
+          stats_.live_bytes -= block->bytes;
+
+          blocks_.deallocate (block, units_ (block->bytes));
+        }
+
+        /**
+         * @brief Return all live blocks to the server.
+         *
+         * @details
+         * All pointers to blocks allocated by the tracker become
+         * invalid; containers still using them must not be used
+         * or destroyed afterwards.
+         *
+         * @return The number of blocks released.
+         */
+        std::size_t
+        release_all (void) noexcept
+        {
+          std::size_t count = 0;
+          block_t* block = head_.next;
+          while (block != &head_)
+            {
+              block_t* next = block->next;
+              blocks_.deallocate (block, units_ (block->bytes));
+              block = next;
+              ++count;
+            }
+
+          head_.prev = &head_;
+          head_.next = &head_;
+          stats_.live_blocks = 0;
+          stats_.live_bytes = 0;
+          return count;
+        }
+
+        /**
+         * @brief Check if a block was allocated by the tracker and
+         *  is still live.
+         *
+         * @details
+         * It walks all live blocks; intended for assertions.
+         */
+        bool
+        owns (const void* p) const noexcept
+        {
+          for (const block_t* block = head_.next; block != &head_; block =
+              block->next)
+            {
+              if (static_cast<const void*> (block + 1) == p)
+                {
+                  return true;
+                }
+            }
+          return false;
+        }
+
+        inline const stats_t&
+        stats (void) const noexcept
+        {
+          return stats_;
+        }
+
+        inline const server_api_t*
+        get_api (void) const noexcept
+        {
+          return blocks_.get_api ();
+        }
+
+        /**
+         * @brief Print the statistics via the backend `output_debug()`.
+         *
+         * @param [in] backend The backend, of any type with an
+         *  `output_debug()` function.
+         * @param [in] name Prefix of the line, like the plug-in name.
+         */
+        template<typename B>
+          void
+          report (B& backend, const char* name) const
+          {
+            backend.output_debug (
+                "%s: %zu live blocks, %zu bytes; "
+                "peak %zu blocks, %zu bytes; %zu allocations",
+                name, stats_.live_blocks, stats_.live_bytes,
+                stats_.peak_blocks, stats_.peak_bytes, stats_.allocations);
+          }
+
+      private:
+
+        // Its alignment keeps the following block aligned.
+        struct alignas(std::max_align_t) block_t
+        {
+          block_t* prev;
+          block_t* next;
+          std::size_t bytes;
+        };
+
+        /**
+         * @brief Get the size, in `block_t` units, of a header
+         *  followed by `bytes` bytes.
+         */
+        static inline std::size_t
+        units_ (std::size_t bytes) noexcept
+        {
+          return 1 + bytes / sizeof(block_t)
+              + ((bytes % sizeof(block_t) != 0) ? 1 : 0);
+        }
+
+      private:
+
+        allocator<block_t, server_api_t> blocks_;
+        // Sentinel of the circular list of live blocks.
+        block_t head_;
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief A standard allocator that allocates memory via
+     * an allocation tracker.
+     *
+     * @details
+     * It is an `allocator` whose blocks are registered in the
+     * tracker.
+     */
+    template<typename T, typename S>
+      class tracking_allocator : public allocator<T, S>
+      {
+      public:
+
+        // Standard types.
+        using value_type = T;
+        using server_api_t = S;
+        using tracker_t = allocation_tracker<S>;
+
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+            "over-aligned types are not supported");
+
+      public:
+
+        tracking_allocator (tracker_t* tracker) noexcept :
+            allocator<T, S> (tracker->get_api ())
+        {
+          tracker_ = tracker;
+        }
+
+        tracking_allocator (tracking_allocator const & a) = default;
+
+        template<typename U>
+          tracking_allocator (tracking_allocator<U, S> const & other) noexcept :
+              allocator<T, S> (other.get_api ())
+          {
+            tracker_ = other.get_tracker ();
+          }
+
+        tracking_allocator&
+        operator= (tracking_allocator const & a) = default;
+
+        value_type*
+        allocate (std::size_t objects)
+        {
+          if (objects > this->max_size ())
+            {
+              throw std::system_error (
+                  std::error_code (EINVAL, std::system_category ()));
+            }
+
+          return static_cast<value_type*> (tracker_->allocate (
+              objects * sizeof(value_type)));
+        }
+
+        void
+        deallocate (value_type* p,
+                    std::size_t objects __attribute__((unused))) noexcept
+        {
+          assert(objects <= this->max_size ());
+          tracker_->deallocate (p);
+        }
+
+        tracking_allocator
+        select_on_container_copy_construction (void) const noexcept
+        {
+          return *this;
+        }
+
+        tracker_t*
+        get_tracker (void) const noexcept
+        {
+          return tracker_;
+        }
+
+      private:
+        tracker_t* tracker_;
+      };
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator== (tracking_allocator<T, S> const & a,
+                  tracking_allocator<U, S> const & b) noexcept
+      {
+        return a.get_tracker () == b.get_tracker ();
+      }
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator!= (tracking_allocator<T, S> const & a,
+                  tracking_allocator<U, S> const & b) noexcept
+      {
+        return a.get_tracker () != b.get_tracker ();
+      }
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_ALLOCATION_TRACKER_H_ */
@@ -37,20 +37,118 @@
  * Internet: www.segger.com        Support:  support@segger.com
  */
 
+#ifndef SEGGER_JLINK_SDK_DRTM_BACKEND_H_
+#define SEGGER_JLINK_SDK_DRTM_BACKEND_H_
+
 #include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
 #include <stdio.h>
 
 #if defined(__cplusplus)
 
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-instrumentation.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-hex.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-struct.h>
+
 #include <cstring>
 #include <cassert>
 #include <cstdarg>
+#include <algorithm>
 
 namespace segger
 {
   namespace drtm
   {
 
+    /**
+     * @brief Compute the hash of a symbol name (32-bits FNV-1a).
+     *
+     * @details
+     * Being `constexpr`, it can be evaluated at compile time.
+     */
+    constexpr uint32_t
+    symbol_hash (const char* name)
+    {
+      uint32_t hash = 2166136261u;
+      for (; *name != '\0'; ++name)
+        {
+          hash ^= static_cast<uint8_t> (*name);
+          hash *= 16777619u;
+        }
+      return hash;
+    }
+
+    constexpr bool
+    symbol_equals (const char* a, const char* b)
+    {
+      for (; *a != '\0' && *a == *b; ++a, ++b)
+        {
+          ;
+        }
+      return *a == *b;
+    }
+
+    /**
+     * @brief Not `constexpr`, so that reaching it while evaluating
+     *  `symbol_index()` at compile time fails the build.
+     */
+    inline std::size_t
+    symbol_index_not_found (std::size_t count)
+    {
+      return count;
+    }
+
+    /**
+     * @brief Find at compile time the index of a symbol in a list
+     *  of names.
+     *
+     * @details
+     * The list must have the same order as the symbols table
+     * returned by `RTOS_GetSymbols()`, and the result is intended
+     * to be passed to `backend::get_symbol_address<N>()`:
+     *
+     * @code{.cpp}
+     * constexpr const char* names[] = { "os_rtos_idle_thread", ... };
+     * constexpr std::size_t idle_index = symbol_index (names, names[0]);
+     * addr = backend.get_symbol_address<idle_index> ();
+     * @endcode
+     *
+     * A name not in the list, for example misspelled, makes the
+     * compile time evaluation fail, with an error that mentions
+     * `symbol_index_not_found()`.
+     *
+     * @return The symbol index; at run time, N if not found.
+     */
+    template<std::size_t N>
+      constexpr std::size_t
+      symbol_index (const char* const (&names)[N], const char* name)
+      {
+        const uint32_t hash = symbol_hash (name);
+        for (std::size_t i = 0; i < N; ++i)
+          {
+            if (names[i] != nullptr && symbol_hash (names[i]) == hash
+                && symbol_equals (names[i], name))
+              {
+                return i;
+              }
+          }
+        return symbol_index_not_found (N);
+      }
+
+    /**
+     * @brief Severity levels of the backend output functions.
+     */
+    enum class log_level
+      : int
+        {
+          none = 0, //
+          error, //
+          warning, //
+          info, //
+          debug
+      };
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
 
@@ -60,20 +158,59 @@ namespace segger
      *
      * Due to the lack of varargs variants of the output functions,
      * these are re-implemented using `snprintf()`.
+     *
+     * Messages above the log level `L` are discarded by a check
+     * known at compile time, before the arguments are walked, so
+     * the formatting code is dropped; `set_log_level()` further
+     * filters messages at run time. The format strings are checked
+     * by the compiler, like those of `printf()`.
+     *
+     * All calls to the server memory and output functions go
+     * through the instrumentation policy `I`; the default
+     * `null_instrumentation` adds no code.
      */
-    template<typename T, typename U>
+    template<typename T, typename U, log_level L = log_level::debug,
+        typename I = null_instrumentation>
       class backend
       {
       public:
 
         constexpr static std::size_t tmp_buf_size_bytes = 256;
+        constexpr static std::size_t batch_max_span_bytes = 1024;
+        constexpr static log_level max_log_level = L;
         using server_api_t = T;
         using symbols_t = U;
+        using instrumentation_t = I;
 
         // Common types; will be propagated where needed.
         using target_addr_t = rtos_plugin_target_addr_t;
         using thread_id_t = rtos_plugin_thread_id_t;
 
+        /**
+         * @brief Read cache statistics.
+         */
+        struct cache_stats_t
+        {
+          // Line lookups served from the cache.
+          std::size_t hits;
+          // Line lookups that required a target read.
+          std::size_t misses;
+          // Reads larger than a line, forwarded to the server.
+          std::size_t bypasses;
+          // Line fills that failed, served by a direct read.
+          std::size_t fill_errors;
+        };
+
+        /**
+         * @brief A target memory range to be read by `read_batch()`.
+         */
+        struct read_request_t
+        {
+          target_addr_t addr;
+          std::size_t bytes;
+          uint8_t* out_array;
+        };
+
       public:
         /**
          * @brief Construct a SEGGER J-Link backend.
@@ -81,7 +218,26 @@ namespace segger
          * @param api Pointer to C API.
          */
         backend (const server_api_t* api, const symbols_t* symbols) :
-            api_ (api), symbols_ (symbols)
+            api_ (api), symbols_ (symbols), //
+            cache_data_ (nullptr), //
+            cache_tags_ (nullptr), //
+            cache_line_size_bytes_ (0), //
+            cache_lines_ (0), //
+            cache_generation_ (1), //
+            cache_stats_
+              { }, //
+            batch_gap_bytes_ (32), //
+            writes_buf_ (api, tmp_buf_size_bytes), //
+            writes_count_ (0), //
+            write_combining_ (false), //
+            target_little_endian_ (probe_little_endian_ (api)), //
+            symbol_slots_ (nullptr), //
+            symbol_slots_count_ (0), //
+            log_buf_ (api, 2 * tmp_buf_size_bytes), //
+            log_threshold_bytes_ (0), //
+            log_channel_ (channel_t::output), //
+            log_level_ (L), //
+            instrumentation_ ()
         {
 #if defined(DEBUG)
           printf ("%s(%p, %p) @%p\n", __func__, api, symbols, this);
@@ -97,27 +253,198 @@ namespace segger
         backend&
         operator= (backend&&) = delete;
 
-        ~backend () = default;
+        ~backend ()
+        {
+          disable_output_buffering ();
+          disable_cache ();
+          discard_writes ();
+
+          if (symbol_slots_ != nullptr)
+            {
+              allocator<symbol_slot_t, server_api_t> slots_allocator
+                { api_ };
+              slots_allocator.deallocate (symbol_slots_, symbol_slots_count_);
+            }
+        }
 
       public:
 
+        /**
+         * @brief Enable the target memory read cache.
+         *
+         * @details
+         * Small reads are served from blocks of `line_size_bytes`
+         * fetched with a single `read_byte_array()` call. The cache
+         * is direct mapped, with `lines` entries; both values must
+         * be powers of 2.
+         *
+         * Target memory is assumed not to change while the cache
+         * is valid, so `invalidate_cache()` must be called each time
+         * the target was running, usually at the beginning of
+         * `RTOS_UpdateThreads()`.
+         *
+         * @param [in] line_size_bytes Size of a cache line.
+         * @param [in] lines Number of cache lines.
+         *
+         * @retval 0 The cache was enabled.
+         * @retval <0 Allocating the cache failed.
+         */
+        int
+        enable_cache (std::size_t line_size_bytes = 64, std::size_t lines = 64)
+        {
+          assert(line_size_bytes != 0);
+          assert((line_size_bytes & (line_size_bytes - 1)) == 0);
+          assert(lines != 0);
+          assert((lines & (lines - 1)) == 0);
+
+          disable_cache ();
+
+          allocator<uint8_t, server_api_t> data_allocator
+            { api_ };
+          allocator<cache_tag_t, server_api_t> tags_allocator
+            { api_ };
+
+          cache_data_ = data_allocator.allocate (line_size_bytes * lines);
+          cache_tags_ = tags_allocator.allocate (lines);
+          if (cache_data_ == nullptr || cache_tags_ == nullptr)
+            {
+              if (cache_data_ != nullptr)
+                {
+                  data_allocator.deallocate (cache_data_,
+                                             line_size_bytes * lines);
+                  cache_data_ = nullptr;
+                }
+              if (cache_tags_ != nullptr)
+                {
+                  tags_allocator.deallocate (cache_tags_, lines);
+                  cache_tags_ = nullptr;
+                }
+              return -1;
+            }
+
+          for (std::size_t i = 0; i < lines; ++i)
+            {
+              cache_tags_[i].addr = 0;
+              cache_tags_[i].generation = 0;
+            }
+
+          cache_line_size_bytes_ = line_size_bytes;
+          cache_lines_ = lines;
+          cache_generation_ = 1;
+          cache_stats_ = cache_stats_t
+            { };
+
+          return 0;
+        }
+
+        /**
+         * @brief Disable the read cache and release its memory.
+         */
+        void
+        disable_cache (void)
+        {
+          if (cache_lines_ == 0)
+            {
+              return;
+            }
+
+          allocator<uint8_t, server_api_t> data_allocator
+            { api_ };
+          allocator<cache_tag_t, server_api_t> tags_allocator
+            { api_ };
+
+          data_allocator.deallocate (cache_data_,
+                                     cache_line_size_bytes_ * cache_lines_);
+          tags_allocator.deallocate (cache_tags_, cache_lines_);
+
+          cache_data_ = nullptr;
+          cache_tags_ = nullptr;
+          cache_line_size_bytes_ = 0;
+          cache_lines_ = 0;
+        }
+
+        /**
+         * @brief Discard all cached target memory, in O(1).
+         */
+        void
+        invalidate_cache (void)
+        {
+          if (++cache_generation_ == 0)
+            {
+              // On wrap around, old tags might match again.
+              for (std::size_t i = 0; i < cache_lines_; ++i)
+                {
+                  cache_tags_[i].generation = 0;
+                }
+              cache_generation_ = 1;
+            }
+        }
+
+        inline bool
+        is_cache_enabled (void) const
+        {
+          return cache_lines_ != 0;
+        }
+
+        inline const cache_stats_t&
+        cache_stats (void) const
+        {
+          return cache_stats_;
+        }
+
         target_addr_t
         get_symbol_address (const char* name)
         {
           assert(name != nullptr);
 
-          const symbols_t* p = symbols_;
-          for (; p->name; ++p)
+          if (symbol_slots_ == nullptr && !build_symbols_index_ ())
             {
-              if (std::strcmp (name, p->name) == 0)
+              // Could not allocate the index, fall back to a scan.
+              const symbols_t* p = symbols_;
+              for (; p->name; ++p)
                 {
-                  return p->address;
+                  if (std::strcmp (name, p->name) == 0)
+                    {
+                      return p->address;
+                    }
                 }
+
+              return 0;
             }
 
-          return 0;
+          const uint32_t hash = symbol_hash (name);
+          const std::size_t mask = symbol_slots_count_ - 1;
+          for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+            {
+              const symbol_slot_t& slot = symbol_slots_[i];
+              if (slot.index == 0)
+                {
+                  return 0;
+                }
+              if (slot.hash == hash
+                  && std::strcmp (name, symbols_[slot.index - 1].name) == 0)
+                {
+                  return symbols_[slot.index - 1].address;
+                }
+            }
         }
 
+        /**
+         * @brief Get the address of a symbol by its position in
+         *  the symbols table.
+         *
+         * @details
+         * Intended for use with an index computed at compile time
+         * by `symbol_index()`; no string compares are performed.
+         */
+        template<std::size_t N>
+          inline target_addr_t
+          get_symbol_address (void)
+          {
+            assert(N < symbols_count_ ());
+            return symbols_[N].address;
+          }
+
         /**
          * @brief Output a formatted log message to J-Link GDB server window.
          *
@@ -125,13 +452,19 @@ namespace segger
          * If a log file is specified, the message will also be printed to
          * the log file.
          */
-        int
+        __attribute__((format(printf, 2, 3))) int
         output (const char* fmt, ...)
         {
+          // Check before walking the arguments.
+          if (!is_log_enabled (log_level::info))
+            {
+              return 0;
+            }
+
           std::va_list args;
           va_start(args, fmt);
 
-          int ret = voutput (fmt, args);
+          int ret = vemit_ (channel_t::output, fmt, args);
 
           va_end(args);
           return ret;
@@ -140,11 +473,11 @@ namespace segger
         int
         voutput (const char* fmt, va_list args)
         {
-          char buf[tmp_buf_size_bytes];
-
-          int ret = vsnprintf (buf, sizeof(buf), fmt, args);
-          api_->output (buf);
-          return ret;
+          if (!is_log_enabled (log_level::info))
+            {
+              return 0;
+            }
+          return vemit_ (channel_t::output, fmt, args);
         }
 
         /**
@@ -154,13 +487,18 @@ namespace segger
          * Outputs to the debug channel are suppressed in non-debug builds of
          * the J-Link GDB Server.
          */
-        int
+        __attribute__((format(printf, 2, 3))) int
         output_debug (const char* fmt, ...)
         {
+          if (!is_log_enabled (log_level::debug))
+            {
+              return 0;
+            }
+
           std::va_list args;
           va_start(args, fmt);
 
-          int ret = voutput_debug (fmt, args);
+          int ret = vemit_ (channel_t::debug, fmt, args);
 
           va_end(args);
           return ret;
@@ -169,11 +507,11 @@ namespace segger
         int
         voutput_debug (const char* fmt, std::va_list args)
         {
-          char buf[tmp_buf_size_bytes];
-
-          int ret = vsnprintf (buf, sizeof(buf), fmt, args);
-          api_->output_debug (buf);
-          return ret;
+          if (!is_log_enabled (log_level::debug))
+            {
+              return 0;
+            }
+          return vemit_ (channel_t::debug, fmt, args);
         }
 
         /**
@@ -183,13 +521,18 @@ namespace segger
          * The line starts with “WARNING: ”. If a log file is specified, the
          * message will also be printed to the log file.
          */
-        int
+        __attribute__((format(printf, 2, 3))) int
         output_warning (const char* fmt, ...)
         {
+          if (!is_log_enabled (log_level::warning))
+            {
+              return 0;
+            }
+
           std::va_list args;
           va_start(args, fmt);
 
-          int ret = voutput_warning (fmt, args);
+          int ret = vemit_ (channel_t::warning, fmt, args);
 
           va_end(args);
           return ret;
@@ -198,14 +541,11 @@ namespace segger
         int
         voutput_warning (const char* fmt, va_list args)
         {
-          char buf[tmp_buf_size_bytes];
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-nonliteral"
-          int ret = vsnprintf (buf, sizeof(buf), fmt, args);
-#pragma GCC diagnostic pop
-          api_->output_warning (buf);
-          return ret;
+          if (!is_log_enabled (log_level::warning))
+            {
+              return 0;
+            }
+          return vemit_ (channel_t::warning, fmt, args);
         }
 
         /**
@@ -215,13 +555,18 @@ namespace segger
          * The line starts with “ERROR: ”. If a log file is specified, the
          * message will also be printed to the log file.
          */
-        int
+        __attribute__((format(printf, 2, 3))) int
         output_error (const char* fmt, ...)
         {
+          if (!is_log_enabled (log_level::error))
+            {
+              return 0;
+            }
+
           std::va_list args;
           va_start(args, fmt);
 
-          int ret = voutput_error (fmt, args);
+          int ret = vemit_ (channel_t::error, fmt, args);
 
           va_end(args);
           return ret;
@@ -230,21 +575,160 @@ namespace segger
         int
         voutput_error (const char* fmt, va_list args)
         {
-          char buf[tmp_buf_size_bytes];
+          if (!is_log_enabled (log_level::error))
+            {
+              return 0;
+            }
+          return vemit_ (channel_t::error, fmt, args);
+        }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-nonliteral"
-          int ret = vsnprintf (buf, sizeof(buf), fmt, args);
-#pragma GCC diagnostic pop
-          api_->output_error (buf);
-          return ret;
+        /**
+         * @brief Get the instrumentation policy object, for example
+         *  to dump the `call_instrumentation` counters.
+         */
+        inline instrumentation_t&
+        instrumentation (void)
+        {
+          return instrumentation_;
+        }
+
+        /**
+         * @brief Check if messages of a given level are output.
+         *
+         * @details
+         * For levels above `L` the result is known at compile time.
+         */
+        inline bool
+        is_log_enabled (log_level level) const
+        {
+          return level <= L && level <= log_level_;
+        }
+
+        /**
+         * @brief Set the run time log level.
+         *
+         * @details
+         * Messages above this level are discarded before formatting.
+         * Levels above `L` are always discarded.
+         */
+        inline void
+        set_log_level (log_level level)
+        {
+          log_level_ = level;
+        }
+
+        /**
+         * @brief Buffer the log and debug messages.
+         *
+         * @details
+         * Messages passed to `output()` and `output_debug()` are
+         * accumulated, one per line, in a growable buffer, and passed
+         * to the server in a single call by `flush_output()`, when the
+         * buffer exceeds `threshold_bytes`, or when a message for
+         * another channel is issued. Warnings and errors are never
+         * delayed.
+         *
+         * To preserve the timing of the log, plug-ins are expected to
+         * flush at the end of each `RTOS_*` function, usually by
+         * creating an `output_guard`.
+         *
+         * @param [in] threshold_bytes Buffer size that triggers a flush.
+         */
+        void
+        enable_output_buffering (std::size_t threshold_bytes = 4096)
+        {
+          assert(threshold_bytes != 0);
+
+          log_threshold_bytes_ = threshold_bytes;
+        }
+
+        /**
+         * @brief Flush the buffered messages and stop buffering.
+         */
+        void
+        disable_output_buffering (void)
+        {
+          flush_output ();
+          log_threshold_bytes_ = 0;
+          log_buf_.release ();
         }
 
+        /**
+         * @brief Pass the buffered messages to the server.
+         */
+        void
+        flush_output (void)
+        {
+          if (log_buf_.empty ())
+            {
+              return;
+            }
+
+          // The server terminates the last line; there is always
+          // room for the final '\0'.
+          std::size_t size_bytes = log_buf_.size ();
+          if (log_buf_[size_bytes - 1] == '\n')
+            {
+              --size_bytes;
+            }
+          log_buf_.data ()[size_bytes] = '\0';
+
+          emit_direct_ (log_channel_, log_buf_.data ());
+          log_buf_.clear ();
+        }
+
+        /**
+         * @brief Flush the buffered output when leaving a scope,
+         *  usually an `RTOS_*` function.
+         */
+        class output_guard
+        {
+        public:
+
+          output_guard (backend& b) :
+              backend_ (b)
+          {
+            ;
+          }
+
+          output_guard (const output_guard&) = delete;
+          output_guard&
+          operator= (const output_guard&) = delete;
+
+          ~output_guard ()
+          {
+            backend_.flush_output ();
+          }
+
+        private:
+
+          backend& backend_;
+        };
+
+        /**
+         * @brief Get the server API, for layers allocating memory
+         *  through it.
+         */
+        inline const server_api_t*
+        get_api (void) const
+        {
+          return api_;
+        }
+
+        /**
+         * @brief Tell the target byte order.
+         *
+         * @details
+         * The SEGGER API does not provide it directly; it is
+         * probed once, at construction, with the server
+         * `load_long()`, so that the values encoded here match
+         * those written by the server `write_short()` and
+         * `write_long()`.
+         */
         inline bool
         is_target_little_endian (void)
         {
-          // SEGGER API does not provide this.
-          return true;
+          return target_little_endian_;
         }
 
         /**
@@ -264,7 +748,11 @@ namespace segger
         read_byte_array (target_addr_t addr, uint8_t* out_array,
                          std::size_t bytes)
         {
-          return api_->read_byte_array (addr, out_array, bytes);
+          if (cache_lines_ != 0)
+            {
+              return cached_read_ (addr, out_array, bytes);
+            }
+          return server_read_byte_array_ (addr, out_array, bytes);
         }
 
         /**
@@ -282,7 +770,14 @@ namespace segger
         inline int
         read_byte (target_addr_t addr, uint8_t* out_value)
         {
-          return api_->read_byte (addr, out_value);
+          if (cache_lines_ != 0)
+            {
+              return cached_read_ (addr, out_value, 1);
+            }
+          auto stamp = instrumentation_.begin ();
+          int ret = api_->read_byte (addr, out_value);
+          instrumentation_.end (server_function::read_byte, 1, stamp);
+          return ret;
         }
 
         /**
@@ -300,7 +795,20 @@ namespace segger
         inline int
         read_short (target_addr_t addr, uint16_t* out_value)
         {
-          return api_->read_short (addr, out_value);
+          if (cache_lines_ != 0)
+            {
+              uint8_t buf[2];
+              int ret = cached_read_ (addr, &buf[0], sizeof(buf));
+              if (ret >= 0)
+                {
+                  *out_value = load_short (&buf[0]);
+                }
+              return ret;
+            }
+          auto stamp = instrumentation_.begin ();
+          int ret = api_->read_short (addr, out_value);
+          instrumentation_.end (server_function::read_short, 2, stamp);
+          return ret;
         }
 
         /**
@@ -318,7 +826,20 @@ namespace segger
         inline int
         read_long (target_addr_t addr, uint32_t* out_value)
         {
-          return api_->read_long (addr, out_value);
+          if (cache_lines_ != 0)
+            {
+              uint8_t buf[4];
+              int ret = cached_read_ (addr, &buf[0], sizeof(buf));
+              if (ret >= 0)
+                {
+                  *out_value = load_long (&buf[0]);
+                }
+              return ret;
+            }
+          auto stamp = instrumentation_.begin ();
+          int ret = api_->read_long (addr, out_value);
+          instrumentation_.end (server_function::read_long, 4, stamp);
+          return ret;
         }
 
         /**
@@ -346,77 +867,404 @@ namespace segger
         }
 
         /**
-         * @brief Write memory to the target system.
+         * @brief Read a whole structure from the target system.
          *
          * @details
-         * If necessary, the target CPU is halted in order to read memory.
+         * The structure is fetched with a single `read_byte_array()`
+         * call; its fields are later decoded with the target
+         * byte order by `target_struct::get()`.
          *
-         * @param [in] addr Target address to write to.
-         * @param [in] array Pointer to buffer for target memory.
-         * @param [in] bytes Number of bytes to write.
+         * @param [in] addr Target address of the structure.
+         * @param [out] out_struct Local copy of the structure.
          *
-         * @retval 0 Writing memory OK.
-         * @retval <0 Writing memory failed.
+         * @retval 0 Reading memory OK.
+         * @retval <0 Reading memory failed.
          */
-        inline int
-        write_byte_array (target_addr_t addr, const uint8_t* array,
-                          std::size_t bytes)
-        {
-          return api_->write_byte_array (addr, array, bytes);
-        }
+        template<typename S>
+          int
+          read_struct (target_addr_t addr, target_struct<S>& out_struct)
+          {
+            out_struct.set_little_endian (is_target_little_endian ());
+            return read_byte_array (addr, out_struct.data (),
+                                    target_struct<S>::size_bytes);
+          }
 
         /**
-         * @brief Write one byte to the target system.
+         * @brief Read multiple memory ranges from the target system.
          *
          * @details
-         * If necessary, the target CPU is halted in order to read memory.
+         * The requests are sorted by address, and ranges separated by
+         * no more than the batch gap are merged, up to
+         * `batch_max_span_bytes`, each merged range being fetched with
+         * a single `read_byte_array()` call and then scattered to
+         * the individual destinations. If a merged read fails (for
+         * example when the gap is not readable), the ranges are read
+         * one by one.
          *
-         * @param [in] addr Target address to write to.
-         * @param [in] value Byte to write.
+         * The array of requests is reordered in place.
+         *
+         * @param [in,out] requests Array of read requests.
+         * @param [in] count Number of requests.
+         *
+         * @retval 0 Reading memory OK.
+         * @retval <0 Reading at least one range failed; the other
+         *  ranges are still read.
+         */
+        int
+        read_batch (read_request_t* requests, std::size_t count)
+        {
+          assert(requests != nullptr || count == 0);
+
+          std::sort (requests, requests + count,
+                     [](const read_request_t& a, const read_request_t& b)
+                       {
+                         return a.addr < b.addr;
+                       });
+
+          int ret = 0;
+          std::size_t i = 0;
+          while (i < count)
+            {
+              // Both ends are kept in 64-bits, to avoid wrap around.
+              uint64_t begin = requests[i].addr;
+              uint64_t end = begin + requests[i].bytes;
+
+              std::size_t j = i + 1;
+              for (; j < count; ++j)
+                {
+                  uint64_t next_begin = requests[j].addr;
+                  uint64_t next_end = next_begin + requests[j].bytes;
+                  if (next_begin > end + batch_gap_bytes_)
+                    {
+                      break;
+                    }
+                  if (next_end < end)
+                    {
+                      next_end = end;
+                    }
+                  if (next_end - begin > batch_max_span_bytes)
+                    {
+                      break;
+                    }
+                  end = next_end;
+                }
+
+              int r;
+              if (j == i + 1)
+                {
+                  r = read_byte_array (requests[i].addr,
+                                       requests[i].out_array,
+                                       requests[i].bytes);
+                }
+              else
+                {
+                  r = read_span_ (requests + i, j - i,
+                                  static_cast<std::size_t> (end - begin));
+                }
+              if (r < 0)
+                {
+                  ret = r;
+                }
+
+              i = j;
+            }
+
+          return ret;
+        }
+
+        /**
+         * @brief Set the largest gap between two ranges merged
+         *  by `read_batch()`.
+         *
+         * @param [in] bytes Number of unused bytes it is cheaper to
+         *  read than to issue a separate transaction.
+         */
+        inline void
+        set_batch_gap (std::size_t bytes)
+        {
+          batch_gap_bytes_ = bytes;
+        }
+
+        /**
+         * @brief Start collecting writes, instead of passing them
+         *  to the server.
+         *
+         * @details
+         * Until `commit_writes()`, all `write_*()` calls only record
+         * the data. On commit, contiguous and overlapping writes are
+         * merged, in the order they were issued, and each resulting
+         * range is written with a single `write_byte_array()` call.
+         * Writes done with `write_byte()`, `write_short()` or
+         * `write_long()` keep their access width: ranges that include
+         * them are not merged, and each is written with the same
+         * server function, in the order issued.
+         *
+         * Reads are not affected and do not see pending writes.
+         */
+        inline void
+        begin_writes (void)
+        {
+          write_combining_ = true;
+        }
+
+        /**
+         * @brief Write the pending data to the target and stop
+         *  collecting writes.
          *
          * @retval 0 Writing memory OK.
-         * @retval <0 Writing memory failed.
+         * @retval <0 Writing at least one range failed; the other
+         *  ranges are still written. Failures of the sized writes
+         *  are not reported by the server.
+         */
+        int
+        commit_writes (void)
+        {
+          if (!write_combining_)
+            {
+              return 0;
+            }
+          write_combining_ = false;
+
+          int ret = flush_writes_ ();
+          writes_buf_.clear ();
+          writes_count_ = 0;
+          return ret;
+        }
+
+        /**
+         * @brief Drop the pending writes, stop collecting writes and
+         *  release the buffer.
+         */
+        void
+        discard_writes (void)
+        {
+          write_combining_ = false;
+          writes_count_ = 0;
+          writes_buf_.release ();
+        }
+
+        inline bool
+        is_write_combining (void) const
+        {
+          return write_combining_;
+        }
+
+        /**
+         * @brief Collect the writes done in a scope, usually an
+         *  `RTOS_Set*` function, and commit them when leaving it.
+         *
+         * @details
+         * Call `commit()` explicitly to get the result; otherwise
+         * the destructor commits and errors are lost.
+         */
+        class write_guard
+        {
+        public:
+
+          write_guard (backend& b) :
+              backend_ (b)
+          {
+            backend_.begin_writes ();
+          }
+
+          write_guard (const write_guard&) = delete;
+          write_guard&
+          operator= (const write_guard&) = delete;
+
+          ~write_guard ()
+          {
+            backend_.commit_writes ();
+          }
+
+          int
+          commit (void)
+          {
+            return backend_.commit_writes ();
+          }
+
+        private:
+
+          backend& backend_;
+        };
+
+        /**
+         * @brief Write memory to the target system.
+         *
+         * @details
+         * If necessary, the target CPU is halted in order to read memory.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] array Pointer to buffer for target memory.
+         * @param [in] bytes Number of bytes to write.
+         *
+         * @retval 0 Writing memory OK, or the write was recorded.
+         * @retval <0 Writing memory failed, or recording the write
+         *  failed for lack of memory.
+         */
+        inline int
+        write_byte_array (target_addr_t addr, const uint8_t* array,
+                          std::size_t bytes)
+        {
+          if (write_combining_)
+            {
+              return queue_write_ (addr, array, bytes);
+            }
+          return server_write_byte_array_ (addr, array, bytes);
+        }
+
+        /**
+         * @brief Write one byte to the target system.
+         *
+         * @details
+         * If necessary, the target CPU is halted in order to read memory.
+         *
+         * The server `write_byte()` does not report errors; use
+         * `write_byte_checked()` to get them. While collecting writes,
+         * the byte is recorded and later written with the same
+         * function; if there is no memory to record it, it is
+         * written immediately.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] value Byte to write.
          */
         inline void
         write_byte (target_addr_t addr, uint8_t value)
         {
-          api_->write_byte (addr, value);
+          if (write_combining_ && queue_write_ (addr, &value, 1, 1) == 0)
+            {
+              return;
+            }
+          server_write_byte_ (addr, value);
         }
 
         /**
-         * @brief Write two bytes to the target system.
+         * @brief Write two bytes to the target system, with a single
+         *  16-bits access.
          *
          * @details
          * If necessary, the target CPU is halted in order to read memory.
          *
+         * The server `write_short()` does not report errors; use
+         * `write_short_checked()` to get them. While collecting writes,
+         * the value is recorded and later written with the same
+         * function, so the access width is kept; if there is no
+         * memory to record it, it is written immediately.
+         *
          * @param [in] addr Target address to write to.
          * @param [in] value Bytes to write.
-         *
-         * @retval 0 Writing memory OK.
-         * @retval <0 Writing memory failed.
          */
         inline void
         write_short (target_addr_t addr, uint16_t value)
         {
-          api_->write_short (addr, value);
+          if (write_combining_)
+            {
+              uint8_t array[2];
+              store_target_ (&array[0], value);
+              if (queue_write_ (addr, &array[0], sizeof(array), 2) == 0)
+                {
+                  return;
+                }
+            }
+          server_write_short_ (addr, value);
         }
 
         /**
-         * @brief Write four bytes to the target system.
+         * @brief Write four bytes to the target system, with a single
+         *  32-bits access.
          *
          * @details
          * If necessary, the target CPU is halted in order to read memory.
          *
+         * The server `write_long()` does not report errors; use
+         * `write_long_checked()` to get them. While collecting writes,
+         * the value is recorded and later written with the same
+         * function, so the access width is kept; if there is no
+         * memory to record it, it is written immediately.
+         *
          * @param [in] addr Target address to write to.
          * @param [in] value Bytes to write.
-         *
-         * @retval 0 Writing memory OK.
-         * @retval <0 Writing memory failed.
          */
         inline void
         write_long (target_addr_t addr, uint32_t value)
         {
-          api_->write_long (addr, value);
+          if (write_combining_)
+            {
+              uint8_t array[4];
+              store_target_ (&array[0], value);
+              if (queue_write_ (addr, &array[0], sizeof(array), 4) == 0)
+                {
+                  return;
+                }
+            }
+          server_write_long_ (addr, value);
+        }
+
+        /**
+         * @brief Write one byte to the target system, reporting errors.
+         *
+         * @details
+         * The byte is written with `write_byte_array()`, since the
+         * server `write_byte()` does not report errors.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] value Byte to write.
+         *
+         * @retval 0 Writing memory OK, or the write was recorded.
+         * @retval <0 Writing memory failed, or recording the write
+         *  failed for lack of memory.
+         */
+        inline int
+        write_byte_checked (target_addr_t addr, uint8_t value)
+        {
+          return write_byte_array (addr, &value, 1);
+        }
+
+        /**
+         * @brief Write two bytes to the target system, reporting errors.
+         *
+         * @details
+         * The value is stored in target byte order and written with
+         * `write_byte_array()`, since the server `write_short()` does
+         * not report errors. The J-Link chooses the access width, so
+         * use `write_short()` for registers that need 16-bits accesses.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] value Bytes to write.
+         *
+         * @retval 0 Writing memory OK, or the write was recorded.
+         * @retval <0 Writing memory failed, or recording the write
+         *  failed for lack of memory.
+         */
+        inline int
+        write_short_checked (target_addr_t addr, uint16_t value)
+        {
+          uint8_t array[2];
+          store_target_ (&array[0], value);
+          return write_byte_array (addr, &array[0], sizeof(array));
+        }
+
+        /**
+         * @brief Write four bytes to the target system, reporting errors.
+         *
+         * @details
+         * The value is stored in target byte order and written with
+         * `write_byte_array()`, since the server `write_long()` does
+         * not report errors. The J-Link chooses the access width, so
+         * use `write_long()` for registers that need 32-bits accesses.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] value Bytes to write.
+         *
+         * @retval 0 Writing memory OK, or the write was recorded.
+         * @retval <0 Writing memory failed, or recording the write
+         *  failed for lack of memory.
+         */
+        inline int
+        write_long_checked (target_addr_t addr, uint32_t value)
+        {
+          uint8_t array[4];
+          store_target_ (&array[0], value);
+          return write_byte_array (addr, &array[0], sizeof(array));
         }
 
         /**
@@ -431,47 +1279,68 @@ namespace segger
          * @retval 0 Writing memory OK.
          * @retval <0 Writing memory failed.
          */
-        void
+        int
         write_long_long (target_addr_t addr, uint64_t value)
         {
           uint8_t array[8];
           if (is_target_little_endian ())
             {
-              array[0] = value & 0xFF;
-              value >>= 8;
-              array[1] = value & 0xFF;
-              value >>= 8;
-              array[2] = value & 0xFF;
-              value >>= 8;
-              array[3] = value & 0xFF;
-              value >>= 8;
-              array[4] = value & 0xFF;
-              value >>= 8;
-              array[5] = value & 0xFF;
-              value >>= 8;
-              array[6] = value & 0xFF;
-              value >>= 8;
-              array[7] = value & 0xFF;
+              little_endian_codec::store (&array[0], value);
             }
           else
             {
-              array[7] = value & 0xFF;
-              value >>= 8;
-              array[6] = value & 0xFF;
-              value >>= 8;
-              array[5] = value & 0xFF;
-              value >>= 8;
-              array[4] = value & 0xFF;
-              value >>= 8;
-              array[3] = value & 0xFF;
-              value >>= 8;
-              array[2] = value & 0xFF;
-              value >>= 8;
-              array[1] = value & 0xFF;
-              value >>= 8;
-              array[0] = value & 0xFF;
+              big_endian_codec::store (&array[0], value);
+            }
+          return write_byte_array (addr, &array[0], 8);
+        }
+
+        /**
+         * @brief Write memory given as a hex string to the target system.
+         *
+         * @details
+         * The hex string is in memory order, as received by
+         * `RTOS_SetThreadRegList()`, and is decoded, then written
+         * with a single `write_byte_array()` call. Nothing is written
+         * if the string is not valid.
+         *
+         * @param [in] addr Target address to write to.
+         * @param [in] hex Pointer to the hex digits.
+         * @param [in] length Number of hex digits.
+         *
+         * @retval 0 Writing memory OK.
+         * @retval <0 Decoding the string (one of `hex_error_*`) or
+         *  writing memory failed.
+         */
+        int
+        write_hex_array (target_addr_t addr, const char* hex,
+                         std::size_t length)
+        {
+          uint8_t buf[tmp_buf_size_bytes];
+
+          std::size_t bytes = length / 2;
+          uint8_t* p = &buf[0];
+          allocator<uint8_t, server_api_t> hex_allocator
+            { api_ };
+          if (bytes > sizeof(buf))
+            {
+              p = hex_allocator.allocate (bytes);
+              if (p == nullptr)
+                {
+                  return -1;
+                }
+            }
+
+          int ret = hex_decode (hex, length, p, bytes);
+          if (ret >= 0)
+            {
+              ret = write_byte_array (addr, p, bytes);
+            }
+
+          if (p != &buf[0])
+            {
+              hex_allocator.deallocate (p, bytes);
             }
-          write_byte_array (addr, &array[0], 8);
+          return ret;
         }
 
         /**
@@ -513,50 +1382,741 @@ namespace segger
         inline uint64_t
         load_long_long (const uint8_t* p)
         {
-          uint64_t val;
           if (is_target_little_endian ())
             {
-              val = p[7];
-              val <<= 8;
-              val = p[6];
-              val <<= 8;
-              val = p[5];
-              val <<= 8;
-              val = p[4];
-              val <<= 8;
-              val = p[3];
-              val <<= 8;
-              val = p[2];
-              val <<= 8;
-              val = p[1];
-              val <<= 8;
-              val |= p[0];
+              return little_endian_codec::load_long_long (p);
             }
           else
             {
-              val = p[0];
-              val <<= 8;
-              val |= p[1];
-              val <<= 8;
-              val |= p[2];
-              val <<= 8;
-              val |= p[3];
-              val <<= 8;
-              val |= p[4];
-              val <<= 8;
-              val |= p[5];
-              val <<= 8;
-              val |= p[6];
-              val <<= 8;
-              val |= p[7];
-            }
-          return val;
+              return big_endian_codec::load_long_long (p);
+            }
+        }
+
+      private:
+
+        enum class channel_t
+        {
+          output, //
+          debug, //
+          warning, //
+          error
+        };
+
+        /**
+         * @brief Format a message and pass it to the server, or to
+         *  the output buffer.
+         *
+         * @details
+         * Short messages are formatted on the stack; longer ones are
+         * formatted again in a heap block, so they are not truncated.
+         */
+        int
+        vemit_ (channel_t channel, const char* fmt, std::va_list args)
+        {
+          char buf[tmp_buf_size_bytes];
+
+          std::va_list args_copy;
+          va_copy(args_copy, args);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+          int ret = vsnprintf (buf, sizeof(buf), fmt, args);
+          if (ret < 0)
+            {
+              va_end(args_copy);
+              return ret;
+            }
+
+          char* msg = &buf[0];
+          std::size_t msg_bytes = static_cast<std::size_t> (ret) + 1;
+          allocator<char, server_api_t> msg_allocator
+            { api_ };
+          if (msg_bytes > sizeof(buf))
+            {
+              char* p = msg_allocator.allocate (msg_bytes);
+              if (p != nullptr)
+                {
+                  vsnprintf (p, msg_bytes, fmt, args_copy);
+                  msg = p;
+                }
+            }
+#pragma GCC diagnostic pop
+          va_end(args_copy);
+
+          emit_ (channel, msg);
+
+          if (msg != &buf[0])
+            {
+              msg_allocator.deallocate (msg, msg_bytes);
+            }
+          return ret;
+        }
+
+        void
+        emit_ (channel_t channel, const char* msg)
+        {
+          if (log_threshold_bytes_ == 0 || channel == channel_t::warning
+              || channel == channel_t::error)
+            {
+              flush_output ();
+              emit_direct_ (channel, msg);
+              return;
+            }
+
+          if (channel != log_channel_)
+            {
+              flush_output ();
+              log_channel_ = channel;
+            }
+
+          std::size_t msg_size_bytes = std::strlen (msg);
+          // Room for a line terminator and the final '\0'.
+          if (log_buf_.reserve (log_buf_.size () + msg_size_bytes + 2) < 0)
+            {
+              flush_output ();
+              emit_direct_ (channel, msg);
+              return;
+            }
+
+          log_buf_.append (msg, msg_size_bytes);
+          if (msg_size_bytes == 0 || msg[msg_size_bytes - 1] != '\n')
+            {
+              log_buf_.push_back ('\n');
+            }
+
+          if (log_buf_.size () >= log_threshold_bytes_)
+            {
+              flush_output ();
+            }
+        }
+
+        void
+        emit_direct_ (channel_t channel, const char* msg)
+        {
+          auto stamp = instrumentation_.begin ();
+          server_function f = server_function::output;
+
+          // Never pass the message as format, it may contain `%`.
+          switch (channel)
+            {
+            case channel_t::output:
+              api_->output ("%s", msg);
+              break;
+            case channel_t::debug:
+              api_->output_debug ("%s", msg);
+              f = server_function::output_debug;
+              break;
+            case channel_t::warning:
+              api_->output_warning ("%s", msg);
+              f = server_function::output_warning;
+              break;
+            case channel_t::error:
+              api_->output_error ("%s", msg);
+              f = server_function::output_error;
+              break;
+            }
+
+          instrumentation_.end (f, std::strlen (msg), stamp);
+        }
+
+        inline int
+        server_read_byte_array_ (target_addr_t addr, uint8_t* out_array,
+                                 std::size_t bytes)
+        {
+          auto stamp = instrumentation_.begin ();
+          int ret = api_->read_byte_array (addr, out_array, bytes);
+          instrumentation_.end (server_function::read_byte_array, bytes,
+                                stamp);
+          return ret;
+        }
+
+        inline int
+        server_write_byte_array_ (target_addr_t addr, const uint8_t* array,
+                                  std::size_t bytes)
+        {
+          discard_cached_ (addr, bytes);
+          auto stamp = instrumentation_.begin ();
+          int ret = api_->write_byte_array (addr, array, bytes);
+          instrumentation_.end (server_function::write_byte_array, bytes,
+                                stamp);
+          return ret;
+        }
+
+        inline void
+        server_write_byte_ (target_addr_t addr, uint8_t value)
+        {
+          discard_cached_ (addr, 1);
+          auto stamp = instrumentation_.begin ();
+          api_->write_byte (addr, value);
+          instrumentation_.end (server_function::write_byte, 1, stamp);
+        }
+
+        inline void
+        server_write_short_ (target_addr_t addr, uint16_t value)
+        {
+          discard_cached_ (addr, 2);
+          auto stamp = instrumentation_.begin ();
+          api_->write_short (addr, value);
+          instrumentation_.end (server_function::write_short, 2, stamp);
+        }
+
+        inline void
+        server_write_long_ (target_addr_t addr, uint32_t value)
+        {
+          discard_cached_ (addr, 4);
+          auto stamp = instrumentation_.begin ();
+          api_->write_long (addr, value);
+          instrumentation_.end (server_function::write_long, 4, stamp);
+        }
+
+        template<typename V>
+          inline void
+          store_target_ (uint8_t* p, V value)
+          {
+            if (target_little_endian_)
+              {
+                little_endian_codec::store (p, value);
+              }
+            else
+              {
+                big_endian_codec::store (p, value);
+              }
+          }
+
+        /**
+         * @brief Ask the server how it loads target bytes; without
+         *  a `load_long()`, assume little endian.
+         */
+        static bool
+        probe_little_endian_ (const server_api_t* api)
+        {
+          if (api == nullptr || api->load_long == nullptr)
+            {
+              return true;
+            }
+          const uint8_t bytes[4] =
+            { 0x01, 0x02, 0x03, 0x04 };
+          return api->load_long (&bytes[0]) != 0x01020304;
+        }
+
+        /**
+         * @brief Header of a pending write in the writes buffer,
+         *  followed by the data, padded to the header alignment.
+         */
+        struct write_record_t
+        {
+          target_addr_t addr;
+          uint32_t bytes;
+          // Access width of `write_byte/short/long()`, 0 for arrays.
+          uint32_t width;
+        };
+
+        struct write_ref_t
+        {
+          uint64_t addr;
+          uint64_t end;
+          const uint8_t* data;
+          std::size_t seq;
+          uint32_t width;
+        };
+
+        inline static std::size_t
+        write_record_size_ (std::size_t bytes)
+        {
+          constexpr std::size_t a = alignof(write_record_t);
+          return sizeof(write_record_t) + ((bytes + a - 1) & ~(a - 1));
+        }
+
+        /**
+         * @brief Append a write to the writes buffer.
+         */
+        int
+        queue_write_ (target_addr_t addr, const void* array,
+                      std::size_t bytes, uint32_t width = 0)
+        {
+          if (bytes == 0)
+            {
+              return 0;
+            }
+          if (bytes > UINT32_MAX)
+            {
+              return -1;
+            }
+
+          uint8_t* p = writes_buf_.extend (write_record_size_ (bytes));
+          if (p == nullptr)
+            {
+              return -1;
+            }
+
+          write_record_t r;
+          r.addr = addr;
+          r.bytes = static_cast<uint32_t> (bytes);
+          r.width = width;
+          std::memcpy (p, &r, sizeof(r));
+          std::memcpy (p + sizeof(r), array, bytes);
+
+          ++writes_count_;
+          return 0;
+        }
+
+        /**
+         * @brief Merge the pending writes into ranges and write them.
+         *
+         * @details
+         * The writes are sorted by address and grouped while they
+         * touch or overlap; inside a group they are applied in the
+         * original order, so later writes win. Groups with writes of
+         * a given access width are not merged; their writes are
+         * passed one by one, in the original order. If there is no
+         * memory for sorting, all writes are passed one by one, as
+         * issued.
+         */
+        int
+        flush_writes_ (void)
+        {
+          if (writes_count_ == 0)
+            {
+              return 0;
+            }
+
+          allocator<write_ref_t, server_api_t> refs_allocator
+            { api_ };
+          write_ref_t* refs = refs_allocator.allocate (writes_count_);
+
+          int ret = 0;
+          std::size_t n = 0;
+          for (std::size_t offset = 0; offset < writes_buf_.size (); ++n)
+            {
+              write_record_t r;
+              std::memcpy (&r, writes_buf_.data () + offset, sizeof(r));
+              const uint8_t* data = writes_buf_.data () + offset + sizeof(r);
+              offset += write_record_size_ (r.bytes);
+
+              if (refs == nullptr)
+                {
+                  int w = write_piece_ (r.addr, data, r.bytes, r.width);
+                  if (w < 0)
+                    {
+                      ret = w;
+                    }
+                  continue;
+                }
+              refs[n].addr = r.addr;
+              refs[n].end = uint64_t (r.addr) + r.bytes;
+              refs[n].data = data;
+              refs[n].seq = n;
+              refs[n].width = r.width;
+            }
+
+          if (refs == nullptr)
+            {
+              return ret;
+            }
+
+          std::sort (refs, refs + n, [](const write_ref_t& a,
+              const write_ref_t& b)
+            {
+              return a.addr < b.addr || (a.addr == b.addr && a.seq < b.seq);
+            });
+
+          std::size_t i = 0;
+          while (i < n)
+            {
+              uint64_t begin = refs[i].addr;
+              uint64_t end = refs[i].end;
+              std::size_t j = i + 1;
+              while (j < n && refs[j].addr <= end)
+                {
+                  end = std::max (end, refs[j].end);
+                  ++j;
+                }
+
+              int w = write_range_ (refs + i, j - i, begin,
+                                    static_cast<std::size_t> (end - begin));
+              if (w < 0)
+                {
+                  ret = w;
+                }
+              i = j;
+            }
+
+          refs_allocator.deallocate (refs, writes_count_);
+          return ret;
+        }
+
+        /**
+         * @brief Write one merged range, assembled on the stack or,
+         *  if larger, in a heap block.
+         */
+        int
+        write_range_ (write_ref_t* refs, std::size_t count, uint64_t begin,
+                      std::size_t bytes)
+        {
+          if (count == 1)
+            {
+              return write_piece_ (static_cast<target_addr_t> (begin),
+                                   refs[0].data, bytes, refs[0].width);
+            }
+
+          // Apply the pieces in the original order.
+          std::sort (refs, refs + count, [](const write_ref_t& a,
+              const write_ref_t& b)
+            {
+              return a.seq < b.seq;
+            });
+
+          bool sized = false;
+          for (std::size_t k = 0; k < count; ++k)
+            {
+              sized = sized || (refs[k].width != 0);
+            }
+
+          uint8_t buf[tmp_buf_size_bytes];
+          uint8_t* p = &buf[0];
+          allocator<uint8_t, server_api_t> range_allocator
+            { api_ };
+          if (!sized && bytes > sizeof(buf))
+            {
+              p = range_allocator.allocate (bytes);
+            }
+
+          int ret = 0;
+          if (sized || p == nullptr)
+            {
+              // Keep the access widths, or no memory for the range;
+              // write the pieces one by one.
+              for (std::size_t k = 0; k < count; ++k)
+                {
+                  int w = write_piece_ (
+                      static_cast<target_addr_t> (refs[k].addr), refs[k].data,
+                      static_cast<std::size_t> (refs[k].end - refs[k].addr),
+                      refs[k].width);
+                  if (w < 0)
+                    {
+                      ret = w;
+                    }
+                }
+              return ret;
+            }
+
+          for (std::size_t k = 0; k < count; ++k)
+            {
+              std::memcpy (
+                  p + (refs[k].addr - begin), refs[k].data,
+                  static_cast<std::size_t> (refs[k].end - refs[k].addr));
+            }
+
+          ret = server_write_byte_array_ (static_cast<target_addr_t> (begin),
+                                          p, bytes);
+
+          if (p != &buf[0])
+            {
+              range_allocator.deallocate (p, bytes);
+            }
+          return ret;
+        }
+
+        /**
+         * @brief Write one recorded piece, with its access width.
+         *
+         * @details
+         * The sized server functions do not report errors.
+         */
+        int
+        write_piece_ (target_addr_t addr, const uint8_t* data,
+                      std::size_t bytes, uint32_t width)
+        {
+          switch (width)
+            {
+            case 1:
+              server_write_byte_ (addr, data[0]);
+              return 0;
+            case 2:
+              server_write_short_ (
+                  addr,
+                  target_little_endian_ ?
+                      little_endian_codec::load_short (data) :
+                      big_endian_codec::load_short (data));
+              return 0;
+            case 4:
+              server_write_long_ (
+                  addr,
+                  target_little_endian_ ?
+                      little_endian_codec::load_long (data) :
+                      big_endian_codec::load_long (data));
+              return 0;
+            default:
+              return server_write_byte_array_ (addr, data, bytes);
+            }
+        }
+
+        struct symbol_slot_t
+        {
+          uint32_t hash;
+          // Index in the symbols table plus 1; 0 for empty slots.
+          uint32_t index;
+        };
+
+        /**
+         * @brief Count the symbols, up to the terminating entry.
+         */
+        std::size_t
+        symbols_count_ (void) const
+        {
+          std::size_t count = 0;
+          for (const symbols_t* p = symbols_; p->name; ++p)
+            {
+              ++count;
+            }
+          return count;
+        }
+
+        /**
+         * @brief Create the open addressing symbols index, at
+         *  the first lookup.
+         *
+         * @retval true The index was created.
+         * @retval false Allocating the index failed.
+         */
+        bool
+        build_symbols_index_ (void)
+        {
+          std::size_t symbols_count = symbols_count_ ();
+
+          // Keep the load factor below 1/2.
+          std::size_t count = 4;
+          while (count < 2 * symbols_count)
+            {
+              count <<= 1;
+            }
+
+          allocator<symbol_slot_t, server_api_t> slots_allocator
+            { api_ };
+          symbol_slot_t* slots = slots_allocator.allocate (count);
+          if (slots == nullptr)
+            {
+              return false;
+            }
+
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              slots[i].hash = 0;
+              slots[i].index = 0;
+            }
+
+          const std::size_t mask = count - 1;
+          for (std::size_t k = 0; k < symbols_count; ++k)
+            {
+              const uint32_t hash = symbol_hash (symbols_[k].name);
+              std::size_t i = hash & mask;
+              while (slots[i].index != 0)
+                {
+                  i = (i + 1) & mask;
+                }
+              slots[i].hash = hash;
+              slots[i].index = static_cast<uint32_t> (k + 1);
+            }
+
+          symbol_slots_ = slots;
+          symbol_slots_count_ = count;
+          return true;
+        }
+
+        /**
+         * @brief Read a group of sorted requests with a single
+         *  transaction.
+         */
+        int
+        read_span_ (read_request_t* requests, std::size_t count,
+                    std::size_t span_bytes)
+        {
+          uint8_t buf[batch_max_span_bytes];
+          assert(span_bytes <= sizeof(buf));
+
+          const target_addr_t begin = requests[0].addr;
+          if (read_byte_array (begin, &buf[0], span_bytes) >= 0)
+            {
+              for (std::size_t k = 0; k < count; ++k)
+                {
+                  std::memcpy (requests[k].out_array,
+                               &buf[requests[k].addr - begin],
+                               requests[k].bytes);
+                }
+              return 0;
+            }
+
+          int ret = 0;
+          for (std::size_t k = 0; k < count; ++k)
+            {
+              int r = read_byte_array (requests[k].addr,
+                                       requests[k].out_array,
+                                       requests[k].bytes);
+              if (r < 0)
+                {
+                  ret = r;
+                }
+            }
+          return ret;
+        }
+
+        struct cache_tag_t
+        {
+          target_addr_t addr;
+          // Valid only when equal to the current cache generation.
+          uint32_t generation;
+        };
+
+        /**
+         * @brief Serve a read from the cache, filling lines on miss.
+         */
+        int
+        cached_read_ (target_addr_t addr, uint8_t* out_array,
+                      std::size_t bytes)
+        {
+          // Ranges past the end of the address space are not split
+          // in lines, which would wrap to address 0.
+          if (bytes > cache_line_size_bytes_
+              || uint64_t (addr) + bytes > uint64_t (UINT32_MAX) + 1)
+            {
+              ++cache_stats_.bypasses;
+              return server_read_byte_array_ (addr, out_array, bytes);
+            }
+
+          const target_addr_t mask =
+              static_cast<target_addr_t> (cache_line_size_bytes_ - 1);
+
+          std::size_t done = 0;
+          while (done < bytes)
+            {
+              target_addr_t a = static_cast<target_addr_t> (addr + done);
+              target_addr_t line_addr = a & ~mask;
+              std::size_t offset = a - line_addr;
+              std::size_t chunk = cache_line_size_bytes_ - offset;
+              if (chunk > bytes - done)
+                {
+                  chunk = bytes - done;
+                }
+
+              const uint8_t* line = cache_line_ (line_addr);
+              if (line == nullptr)
+                {
+                  // The full line may not be readable, although
+                  // the requested range is.
+                  ++cache_stats_.fill_errors;
+                  return server_read_byte_array_ (addr, out_array, bytes);
+                }
+
+              std::memcpy (out_array + done, line + offset, chunk);
+              done += chunk;
+            }
+
+          return 0;
+        }
+
+        const uint8_t*
+        cache_line_ (target_addr_t line_addr)
+        {
+          std::size_t index = (line_addr / cache_line_size_bytes_)
+              & (cache_lines_ - 1);
+          cache_tag_t& tag = cache_tags_[index];
+          uint8_t* data = cache_data_ + index * cache_line_size_bytes_;
+
+          if (tag.generation == cache_generation_ && tag.addr == line_addr)
+            {
+              ++cache_stats_.hits;
+              return data;
+            }
+
+          ++cache_stats_.misses;
+          if (server_read_byte_array_ (line_addr, data,
+                                       cache_line_size_bytes_) < 0)
+            {
+              tag.generation = 0;
+              return nullptr;
+            }
+
+          tag.addr = line_addr;
+          tag.generation = cache_generation_;
+          return data;
+        }
+
+        /**
+         * @brief Drop the cache lines overlapping a written range.
+         */
+        void
+        discard_cached_ (target_addr_t addr, std::size_t bytes)
+        {
+          if (cache_lines_ == 0 || bytes == 0)
+            {
+              return;
+            }
+
+          if (bytes / cache_line_size_bytes_ >= cache_lines_)
+            {
+              invalidate_cache ();
+              return;
+            }
+
+          const target_addr_t mask =
+              static_cast<target_addr_t> (cache_line_size_bytes_ - 1);
+          target_addr_t line_addr = addr & ~mask;
+          // Stop at the end of the address space, without wrapping.
+          uint64_t end = uint64_t (addr) + bytes - 1;
+          if (end > UINT32_MAX)
+            {
+              end = UINT32_MAX;
+            }
+          target_addr_t last = static_cast<target_addr_t> (end) & ~mask;
+          for (;;)
+            {
+              std::size_t index = (line_addr / cache_line_size_bytes_)
+                  & (cache_lines_ - 1);
+              if (cache_tags_[index].addr == line_addr)
+                {
+                  cache_tags_[index].generation = 0;
+                }
+              if (line_addr == last)
+                {
+                  break;
+                }
+              line_addr += static_cast<target_addr_t> (cache_line_size_bytes_);
+            }
         }
 
       private:
 
         const server_api_t* api_;
         const symbols_t* symbols_;
+
+        // Read cache; disabled when there are no lines.
+        uint8_t* cache_data_;
+        cache_tag_t* cache_tags_;
+        std::size_t cache_line_size_bytes_;
+        std::size_t cache_lines_;
+        uint32_t cache_generation_;
+        cache_stats_t cache_stats_;
+
+        std::size_t batch_gap_bytes_;
+
+        // Pending writes, as records followed by their data.
+        pod_buffer<uint8_t, server_api_t> writes_buf_;
+        std::size_t writes_count_;
+        bool write_combining_;
+        bool target_little_endian_;
+
+        // Symbols index, created at the first lookup.
+        symbol_slot_t* symbol_slots_;
+        std::size_t symbol_slots_count_;
+
+        // Output buffer; buffering is disabled when the threshold is 0.
+        pod_buffer<char, server_api_t> log_buf_;
+        std::size_t log_threshold_bytes_;
+        channel_t log_channel_;
+
+        log_level log_level_;
+
+        instrumentation_t instrumentation_;
       };
 
 #pragma GCC diagnostic pop
@@ -568,3 +2128,5 @@ namespace segger
 } /* namespace segger */
 
 #endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_BACKEND_H_ */
@@ -0,0 +1,657 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_CORE_DUMP_H_
+#define SEGGER_JLINK_SDK_DRTM_CORE_DUMP_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-adapter.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <vector>
+
+#if defined(_WIN32)
+// Keep `min()`/`max()` macros and the rarely used APIs out of the
+// plug-in sources that include this header.
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A GDB server API implementation that serves target
+     * memory from post-mortem dumps, mapped in memory.
+     *
+     * @details
+     * Dumps are either raw images of memory regions, each with its
+     * base address, or ELF core files, whose `PT_LOAD` segments give
+     * the regions. The files are mapped copy-on-write, so they are
+     * not loaded in the heap, reads are plain copies from the
+     * mapping, and writes, for example when a plug-in changes
+     * registers, stay private to the process. On POSIX systems,
+     * files that cannot be mapped, like pipes, are read in the
+     * heap; on Windows only regular files are supported.
+     *
+     * The same `backend` based plug-in code can then inspect the
+     * threads of a crashed device offline:
+     *
+     * @code{.cpp}
+     * segger::drtm::core_dump_target target;
+     * target.map_elf ("crash.core");
+     * backend_t backend { target.api (), symbols };
+     * @endcode
+     */
+    class core_dump_target : public server_adapter<core_dump_target>
+    {
+    public:
+
+      using target_addr_t = rtos_plugin_target_addr_t;
+
+    public:
+
+      core_dump_target (bool little_endian = true) :
+          little_endian_ (little_endian)
+      {
+        ;
+      }
+
+      // The rule of five.
+      core_dump_target (const core_dump_target&) = delete;
+      core_dump_target (core_dump_target&&) = delete;
+      core_dump_target&
+      operator= (const core_dump_target&) = delete;
+      core_dump_target&
+      operator= (core_dump_target&&) = delete;
+
+      ~core_dump_target ()
+      {
+        for (mapping_t& m : mappings_)
+          {
+            unmap_ (m);
+          }
+      }
+
+    public:
+
+      /**
+       * @brief Map a raw memory image.
+       *
+       * @param [in] base Target address of the first byte.
+       * @param [in] path Path of the image file.
+       *
+       * @retval 0 The file was mapped.
+       * @retval <0 The file could not be mapped.
+       */
+      int
+      map_raw (target_addr_t base, const char* path)
+      {
+        mapping_t m;
+        if (map_ (path, m) < 0)
+          {
+            return -1;
+          }
+        mappings_.push_back (m);
+
+        if (m.size_bytes != 0)
+          {
+            add_region (base, m.data, m.size_bytes);
+          }
+        return 0;
+      }
+
+      /**
+       * @brief Map an ELF core file, 32 or 64-bits, and add its
+       *  loadable segments as regions.
+       *
+       * @details
+       * The target byte order is taken from the ELF header.
+       * Segments, or parts of them, not stored in the file and
+       * segments above 4 GB are ignored.
+       *
+       * @retval 0 The file was mapped.
+       * @retval <0 The file could not be mapped or is not a valid
+       *  ELF file.
+       */
+      int
+      map_elf (const char* path)
+      {
+        mapping_t m;
+        if (map_ (path, m) < 0)
+          {
+            return -1;
+          }
+
+        // Check the whole header before keeping the mapping and
+        // changing the byte order.
+        const uint8_t* p = m.data;
+        if (m.size_bytes < 52 || std::memcmp (p, "\177ELF", 4) != 0
+            || (p[4] != 1 && p[4] != 2) || (p[5] != 1 && p[5] != 2))
+          {
+            unmap_ (m);
+            return -1;
+          }
+
+        bool is_64 = (p[4] == 2);
+        bool little_endian = (p[5] == 1);
+
+        uint64_t phoff;
+        uint16_t phentsize;
+        uint16_t phnum;
+        if (is_64)
+          {
+            if (m.size_bytes < 64)
+              {
+                unmap_ (m);
+                return -1;
+              }
+            phoff = elf_load_<uint64_t> (p + 32, little_endian);
+            phentsize = elf_load_<uint16_t> (p + 54, little_endian);
+            phnum = elf_load_<uint16_t> (p + 56, little_endian);
+          }
+        else
+          {
+            phoff = elf_load_<uint32_t> (p + 28, little_endian);
+            phentsize = elf_load_<uint16_t> (p + 42, little_endian);
+            phnum = elf_load_<uint16_t> (p + 44, little_endian);
+          }
+
+        if (phentsize < (is_64 ? 56 : 32) || phoff > m.size_bytes
+            || uint64_t (phnum) * phentsize > m.size_bytes - phoff)
+          {
+            unmap_ (m);
+            return -1;
+          }
+
+        mappings_.push_back (m);
+        little_endian_ = little_endian;
+
+        constexpr uint32_t pt_load = 1;
+        for (uint16_t i = 0; i < phnum; ++i)
+          {
+            const uint8_t* ph = p + phoff + uint64_t (i) * phentsize;
+
+            uint64_t offset;
+            uint64_t vaddr;
+            uint64_t filesz;
+            if (elf_load_<uint32_t> (ph, little_endian) != pt_load)
+              {
+                continue;
+              }
+            if (is_64)
+              {
+                offset = elf_load_<uint64_t> (ph + 8, little_endian);
+                vaddr = elf_load_<uint64_t> (ph + 16, little_endian);
+                filesz = elf_load_<uint64_t> (ph + 32, little_endian);
+              }
+            else
+              {
+                offset = elf_load_<uint32_t> (ph + 4, little_endian);
+                vaddr = elf_load_<uint32_t> (ph + 8, little_endian);
+                filesz = elf_load_<uint32_t> (ph + 16, little_endian);
+              }
+
+            if (filesz == 0 || offset > m.size_bytes
+                || filesz > m.size_bytes - offset || vaddr > 0xFFFFFFFFu
+                || filesz - 1 > 0xFFFFFFFFu - vaddr)
+              {
+                continue;
+              }
+
+            add_region (static_cast<target_addr_t> (vaddr), m.data + offset,
+                        static_cast<std::size_t> (filesz));
+          }
+        return 0;
+      }
+
+      /**
+       * @brief Add a region backed by memory owned by the caller.
+       */
+      void
+      add_region (target_addr_t base, uint8_t* data, std::size_t size_bytes)
+      {
+        region_t r
+          { base, data, size_bytes };
+        auto it = std::upper_bound (regions_.begin (), regions_.end (), r,
+                                    [](const region_t& a, const region_t& b)
+                                      {
+                                        return a.base < b.base;
+                                      });
+        regions_.insert (it, r);
+      }
+
+      /**
+       * @brief Get a pointer to the mapped memory, for direct
+       *  inspection, without copies.
+       *
+       * @return Pointer to the bytes, or NULL if the range is not
+       *  inside a region.
+       */
+      inline const uint8_t*
+      peek (target_addr_t addr, std::size_t bytes)
+      {
+        return find_ (addr, bytes);
+      }
+
+      inline std::size_t
+      regions (void) const
+      {
+        return regions_.size ();
+      }
+
+      inline bool
+      is_little_endian (void) const
+      {
+        return little_endian_;
+      }
+
+    public:
+
+      // Server API.
+
+      int
+      read_byte_array (target_addr_t addr, uint8_t* out_array,
+                       std::size_t bytes)
+      {
+        const uint8_t* p = find_ (addr, bytes);
+        if (p != nullptr)
+          {
+            std::memcpy (out_array, p, bytes);
+            return 0;
+          }
+        return for_each_piece_ (addr, bytes,
+                                [out_array](uint8_t* q, std::size_t done,
+                                            std::size_t n)
+                                  {
+                                    std::memcpy (out_array + done, q, n);
+                                  });
+      }
+
+      int
+      write_byte_array (target_addr_t addr, const uint8_t* array,
+                        std::size_t bytes)
+      {
+        uint8_t* p = find_ (addr, bytes);
+        if (p != nullptr)
+          {
+            std::memcpy (p, array, bytes);
+            return 0;
+          }
+        return for_each_piece_ (addr, bytes,
+                                [array](uint8_t* q, std::size_t done,
+                                        std::size_t n)
+                                  {
+                                    std::memcpy (q, array + done, n);
+                                  });
+      }
+
+    private:
+
+      struct region_t
+      {
+        target_addr_t base;
+        uint8_t* data;
+        std::size_t size_bytes;
+      };
+
+      struct mapping_t
+      {
+        uint8_t* data;
+        std::size_t size_bytes;
+        // Heap copy, when the file cannot be mapped.
+        bool is_heap;
+#if defined(_WIN32)
+        HANDLE file;
+        HANDLE map;
+#endif
+      };
+
+      template<typename V>
+        static V
+        elf_load_ (const uint8_t* p, bool little_endian)
+        {
+          if (little_endian)
+            {
+              return little_endian_codec::load<V> (p);
+            }
+          return big_endian_codec::load<V> (p);
+        }
+
+      /**
+       * @brief Binary search of the region containing the range.
+       */
+      uint8_t*
+      find_ (target_addr_t addr, std::size_t bytes)
+      {
+        auto it = std::upper_bound (regions_.begin (), regions_.end (), addr,
+                                    [](target_addr_t a, const region_t& r)
+                                      {
+                                        return a < r.base;
+                                      });
+        if (it == regions_.begin ())
+          {
+            return nullptr;
+          }
+        --it;
+        std::size_t offset = addr - it->base;
+        if (offset > it->size_bytes || bytes > it->size_bytes - offset)
+          {
+            return nullptr;
+          }
+        return it->data + offset;
+      }
+
+      /**
+       * @brief Binary search of the region containing the byte.
+       */
+      region_t*
+      region_at_ (uint64_t addr)
+      {
+        auto it = std::upper_bound (regions_.begin (), regions_.end (), addr,
+                                    [](uint64_t a, const region_t& r)
+                                      {
+                                        return a < r.base;
+                                      });
+        if (it == regions_.begin ())
+          {
+            return nullptr;
+          }
+        --it;
+        if (addr - it->base >= it->size_bytes)
+          {
+            return nullptr;
+          }
+        return &*it;
+      }
+
+      /**
+       * @brief Split a range spanning adjacent regions, like
+       *  consecutive `PT_LOAD` segments, and call `f (p, done, n)`
+       *  for each piece, in address order.
+       *
+       * @retval 0 All pieces were passed to `f`.
+       * @retval <0 Some bytes are outside the regions; nothing was
+       *  passed to `f`.
+       */
+      template<typename F>
+        int
+        for_each_piece_ (target_addr_t addr, std::size_t bytes, F f)
+        {
+          // Check that the whole range is present before copying.
+          for (int pass = 0; pass < 2; ++pass)
+            {
+              std::size_t done = 0;
+              while (done < bytes)
+                {
+                  uint64_t a = uint64_t (addr) + done;
+                  region_t* r = region_at_ (a);
+                  if (r == nullptr)
+                    {
+                      return -1;
+                    }
+                  std::size_t offset = static_cast<std::size_t> (a - r->base);
+                  std::size_t n = r->size_bytes - offset;
+                  if (n > bytes - done)
+                    {
+                      n = bytes - done;
+                    }
+                  if (pass != 0)
+                    {
+                      f (r->data + offset, done, n);
+                    }
+                  done += n;
+                }
+            }
+          return 0;
+        }
+
+      static int
+      map_ (const char* path, mapping_t& m)
+      {
+        m.data = nullptr;
+        m.size_bytes = 0;
+        m.is_heap = false;
+
+#if defined(_WIN32)
+        m.file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m.file == INVALID_HANDLE_VALUE)
+          {
+            return -1;
+          }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx (m.file, &size))
+          {
+            CloseHandle (m.file);
+            return -1;
+          }
+        m.size_bytes = static_cast<std::size_t> (size.QuadPart);
+        m.map = nullptr;
+        if (m.size_bytes == 0)
+          {
+            return 0;
+          }
+        m.map = CreateFileMappingA (m.file, nullptr, PAGE_WRITECOPY, 0, 0,
+                                    nullptr);
+        if (m.map == nullptr)
+          {
+            CloseHandle (m.file);
+            return -1;
+          }
+        m.data = static_cast<uint8_t*> (MapViewOfFile (m.map, FILE_MAP_COPY, 0,
+                                                       0, 0));
+        if (m.data == nullptr)
+          {
+            CloseHandle (m.map);
+            CloseHandle (m.file);
+            return -1;
+          }
+        return 0;
+#else
+        int fd = open (path, O_RDONLY);
+        if (fd < 0)
+          {
+            return -1;
+          }
+        struct stat st;
+        if (fstat (fd, &st) < 0)
+          {
+            close (fd);
+            return -1;
+          }
+        if (!S_ISREG (st.st_mode))
+          {
+            // Pipes and devices have no size; read them in the heap.
+            int ret = read_stream_ (fd, m);
+            close (fd);
+            return ret;
+          }
+        m.size_bytes = static_cast<std::size_t> (st.st_size);
+        if (m.size_bytes == 0)
+          {
+            close (fd);
+            return 0;
+          }
+
+        void* p = mmap (nullptr, m.size_bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+          {
+            close (fd);
+            m.data = static_cast<uint8_t*> (p);
+            return 0;
+          }
+
+        // The file system does not support mapping; read the
+        // file in the heap.
+        m.data = new (std::nothrow) uint8_t[m.size_bytes];
+        m.is_heap = true;
+        std::size_t done = 0;
+        while (m.data != nullptr && done < m.size_bytes)
+          {
+            ssize_t n = read (fd, m.data + done, m.size_bytes - done);
+            if (n <= 0)
+              {
+                break;
+              }
+            done += static_cast<std::size_t> (n);
+          }
+        close (fd);
+        if (m.data == nullptr || done != m.size_bytes)
+          {
+            delete[] m.data;
+            return -1;
+          }
+        return 0;
+#endif
+      }
+
+#if !defined(_WIN32)
+      /**
+       * @brief Read a file of unknown size until its end, in a
+       *  heap block grown by doubling.
+       */
+      static int
+      read_stream_ (int fd, mapping_t& m)
+      {
+        m.is_heap = true;
+        std::size_t capacity = 0;
+        for (;;)
+          {
+            if (m.size_bytes == capacity)
+              {
+                capacity = (capacity != 0) ? 2 * capacity : 64 * 1024;
+                uint8_t* data = new (std::nothrow) uint8_t[capacity];
+                if (data == nullptr)
+                  {
+                    unmap_ (m);
+                    return -1;
+                  }
+                if (m.size_bytes != 0)
+                  {
+                    std::memcpy (data, m.data, m.size_bytes);
+                  }
+                delete[] m.data;
+                m.data = data;
+              }
+            ssize_t n = read (fd, m.data + m.size_bytes,
+                              capacity - m.size_bytes);
+            if (n < 0)
+              {
+                unmap_ (m);
+                return -1;
+              }
+            if (n == 0)
+              {
+                return 0;
+              }
+            m.size_bytes += static_cast<std::size_t> (n);
+          }
+      }
+#endif
+
+      static void
+      unmap_ (mapping_t& m)
+      {
+#if defined(_WIN32)
+        if (m.data != nullptr)
+          {
+            UnmapViewOfFile (m.data);
+          }
+        if (m.map != nullptr)
+          {
+            CloseHandle (m.map);
+          }
+        CloseHandle (m.file);
+#else
+        if (m.is_heap)
+          {
+            delete[] m.data;
+          }
+        else if (m.data != nullptr)
+          {
+            munmap (m.data, m.size_bytes);
+          }
+#endif
+        m.data = nullptr;
+      }
+
+    private:
+
+      // Sorted by base address.
+      std::vector<region_t> regions_;
+      std::vector<mapping_t> mappings_;
+
+      bool little_endian_;
+    };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_CORE_DUMP_H_ */
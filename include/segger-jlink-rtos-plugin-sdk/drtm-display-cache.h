@@ -0,0 +1,355 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_DISPLAY_CACHE_H_
+#define SEGGER_JLINK_SDK_DRTM_DISPLAY_CACHE_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-thread-map.h>
+
+#include <cstring>
+#include <cstdarg>
+#include <cassert>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Cache of the thread display strings, rendered once
+     * per update.
+     *
+     * @details
+     * GDB calls `RTOS_GetThreadDisplay()` for every thread after
+     * each stop, often several times. The plug-in renders all
+     * strings during `RTOS_UpdateThreads()`, which reads the
+     * target anyway, and serves the later calls with a bounded
+     * copy:
+     *
+     * @code{.cpp}
+     * // RTOS_UpdateThreads()
+     * display.invalidate ();
+     * display.format (id, "%s [%s, prio %u]", name, state, prio);
+     *
+     * // RTOS_GetThreadDisplay()
+     * return display.get (id, out_description);
+     * @endcode
+     *
+     * The strings are stored in an arena, reset by `invalidate()`,
+     * and found via a `thread_map`, cleared in O(1).
+     */
+    template<typename S>
+      class display_cache
+      {
+      public:
+
+        using server_api_t = S;
+        using thread_id_t = rtos_plugin_thread_id_t;
+
+        // Size of the `RTOS_GetThreadDisplay()` output buffer.
+        constexpr static std::size_t display_size_bytes = 256;
+
+        struct stats_t
+        {
+          std::size_t hits;
+          std::size_t misses;
+        };
+
+      public:
+
+        display_cache (const server_api_t* api) :
+            api_ (api), //
+            arena_ (api), //
+            map_ (allocator<thread_map_slot, server_api_t>
+              { api }), //
+            entries_ (nullptr), //
+            entries_count_ (0), //
+            used_ (0), //
+            stats_
+              { }
+        {
+#if defined(DEBUG)
+          printf ("%s(%p) @%p\n", __func__, api, this);
+#endif /* defined(DEBUG) */
+          ;
+        }
+
+        // The rule of five.
+        display_cache (const display_cache&) = delete;
+        display_cache (display_cache&&) = delete;
+        display_cache&
+        operator= (const display_cache&) = delete;
+        display_cache&
+        operator= (display_cache&&) = delete;
+
+        ~display_cache ()
+        {
+          if (entries_ != nullptr)
+            {
+              allocator<entry_t, server_api_t> entries_allocator
+                { api_ };
+              entries_allocator.deallocate (entries_, entries_count_);
+            }
+        }
+
+      public:
+
+        /**
+         * @brief Drop all strings, at the beginning of an update.
+         *
+         * @details
+         * The arena and the table memory are kept for the next update.
+         */
+        void
+        invalidate (void)
+        {
+          arena_.reset ();
+          map_.clear ();
+          used_ = 0;
+        }
+
+        /**
+         * @brief Store the display string of a thread.
+         *
+         * @details
+         * Strings longer than the `RTOS_GetThreadDisplay()` buffer
+         * are truncated.
+         *
+         * @retval 0 The string was stored.
+         * @retval <0 Allocating memory failed.
+         */
+        int
+        set (thread_id_t id, const char* str)
+        {
+          // `strnlen()` is POSIX, not standard C++; `memchr()` stops
+          // at the first match, so it does not read past the string.
+          const void* end = std::memchr (str, '\0', display_size_bytes - 1);
+          std::size_t length =
+              (end != nullptr) ?
+                  static_cast<std::size_t> (static_cast<const char*> (end)
+                      - str) :
+                  display_size_bytes - 1;
+          return store_ (id, str, length);
+        }
+
+        /**
+         * @brief Format and store the display string of a thread.
+         */
+        __attribute__((format(printf, 3, 4))) int
+        format (thread_id_t id, const char* fmt, ...)
+        {
+          std::va_list args;
+          va_start(args, fmt);
+
+          char buf[display_size_bytes];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+          int n = vsnprintf (buf, sizeof(buf), fmt, args);
+#pragma GCC diagnostic pop
+          va_end(args);
+
+          if (n < 0)
+            {
+              return n;
+            }
+          std::size_t length = static_cast<std::size_t> (n);
+          if (length > sizeof(buf) - 1)
+            {
+              length = sizeof(buf) - 1;
+            }
+          return store_ (id, buf, length);
+        }
+
+        /**
+         * @brief Copy the display string of a thread.
+         *
+         * @param [in] id Thread ID.
+         * @param [out] out Output buffer, usually the one passed to
+         *  `RTOS_GetThreadDisplay()`.
+         * @param [in] out_size Size of the output buffer.
+         *
+         * @return The length of the string, or <0 if there is
+         *  no string for this thread in the current update.
+         */
+        int
+        get (thread_id_t id, char* out,
+             std::size_t out_size = display_size_bytes)
+        {
+          assert(out_size != 0);
+
+          std::size_t index = map_.find (id);
+          if (index == map_t::npos)
+            {
+              ++stats_.misses;
+              return -1;
+            }
+          ++stats_.hits;
+
+          const entry_t& entry = entries_[index];
+          std::size_t length = entry.length;
+          if (length > out_size - 1)
+            {
+              length = out_size - 1;
+            }
+          std::memcpy (out, entry.str, length);
+          out[length] = '\0';
+          return static_cast<int> (length);
+        }
+
+        inline bool
+        contains (thread_id_t id) const
+        {
+          return map_.contains (id);
+        }
+
+        /**
+         * @brief Get the number of strings in the current update.
+         */
+        inline std::size_t
+        size (void) const
+        {
+          return used_;
+        }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+      private:
+
+        using map_t = thread_map<allocator<thread_map_slot, server_api_t>>;
+
+        struct entry_t
+        {
+          const char* str;
+          std::size_t length;
+        };
+
+        int
+        store_ (thread_id_t id, const char* str, std::size_t length)
+        {
+          char* p = static_cast<char*> (arena_.allocate (length + 1, 1));
+          if (p == nullptr)
+            {
+              return -1;
+            }
+          std::memcpy (p, str, length);
+          p[length] = '\0';
+
+          std::size_t index = map_.find (id);
+          if (index == map_t::npos)
+            {
+              if (used_ == entries_count_ && grow_ () < 0)
+                {
+                  return -1;
+                }
+              if (map_.insert (id, used_) < 0)
+                {
+                  return -1;
+                }
+              index = used_++;
+            }
+
+          entries_[index].str = p;
+          entries_[index].length = length;
+          return 0;
+        }
+
+        /**
+         * @brief Double the entries array.
+         */
+        int
+        grow_ (void)
+        {
+          std::size_t count = (entries_count_ != 0) ? 2 * entries_count_ : 32;
+
+          allocator<entry_t, server_api_t> entries_allocator
+            { api_ };
+          entry_t* entries = entries_allocator.allocate (count);
+          if (entries == nullptr)
+            {
+              return -1;
+            }
+
+          if (entries_ != nullptr)
+            {
+              std::memcpy (entries, entries_, used_ * sizeof(entry_t));
+              entries_allocator.deallocate (entries_, entries_count_);
+            }
+          entries_ = entries;
+          entries_count_ = count;
+          return 0;
+        }
+
+      private:
+
+        const server_api_t* api_;
+        arena<server_api_t> arena_;
+        map_t map_;
+
+        // Dense array of strings, indexed via the map.
+        entry_t* entries_;
+        std::size_t entries_count_;
+        std::size_t used_;
+
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_DISPLAY_CACHE_H_ */
@@ -0,0 +1,307 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_ENDIAN_H_
+#define SEGGER_JLINK_SDK_DRTM_ENDIAN_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    enum class endianness
+    {
+      little, //
+      big
+    };
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    constexpr endianness host_endianness = endianness::big;
+#else
+    constexpr endianness host_endianness = endianness::little;
+#endif
+
+    constexpr uint8_t
+    byte_swap (uint8_t v)
+    {
+      return v;
+    }
+
+    constexpr uint16_t
+    byte_swap (uint16_t v)
+    {
+      return __builtin_bswap16 (v);
+    }
+
+    constexpr uint32_t
+    byte_swap (uint32_t v)
+    {
+      return __builtin_bswap32 (v);
+    }
+
+    constexpr uint64_t
+    byte_swap (uint64_t v)
+    {
+      return __builtin_bswap64 (v);
+    }
+
+    /**
+     * @brief Reverse the bytes of each `W` bytes element, copying
+     * `count` elements from `src` to `dst`.
+     *
+     * @details
+     * With AVX2 or SSSE3, 32 or 16 bytes are shuffled at once.
+     * With only SSE2, as in the default x86-64 builds, 16 bytes are
+     * processed at once, by swapping the 16-bits words of each
+     * element, then the bytes of each word with shifts.
+     */
+    template<std::size_t W>
+      inline void
+      byte_swap_copy (const uint8_t* src, uint8_t* dst, std::size_t count)
+      {
+        static_assert(W == 2 || W == 4 || W == 8, "unsupported width");
+
+        std::size_t i = 0;
+        const std::size_t bytes = count * W;
+
+#if defined(__SSSE3__)
+        // Index of the source byte for each destination byte.
+        __m128i mask;
+        if (W == 2)
+          {
+            mask = _mm_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12,
+                                  15, 14);
+          }
+        else if (W == 4)
+          {
+            mask = _mm_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                                  13, 12);
+          }
+        else
+          {
+            mask = _mm_setr_epi8 (7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11,
+                                  10, 9, 8);
+          }
+
+#if defined(__AVX2__)
+        const __m256i mask32 = _mm256_broadcastsi128_si256 (mask);
+        for (; i + 32 <= bytes; i += 32)
+          {
+            __m256i v = _mm256_loadu_si256 (
+                reinterpret_cast<const __m256i*> (src + i));
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + i),
+                                 _mm256_shuffle_epi8 (v, mask32));
+          }
+#endif /* defined(__AVX2__) */
+
+        for (; i + 16 <= bytes; i += 16)
+          {
+            __m128i v = _mm_loadu_si128 (
+                reinterpret_cast<const __m128i*> (src + i));
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + i),
+                              _mm_shuffle_epi8 (v, mask));
+          }
+#elif defined(__SSE2__)
+        for (; i + 16 <= bytes; i += 16)
+          {
+            __m128i v = _mm_loadu_si128 (
+                reinterpret_cast<const __m128i*> (src + i));
+            if (W == 4)
+              {
+                v = _mm_shufflehi_epi16 (
+                    _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1)),
+                    _MM_SHUFFLE (2, 3, 0, 1));
+              }
+            else if (W == 8)
+              {
+                v = _mm_shufflehi_epi16 (
+                    _mm_shufflelo_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3)),
+                    _MM_SHUFFLE (0, 1, 2, 3));
+              }
+            v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + i), v);
+          }
+#endif /* defined(__SSSE3__) */
+
+        // Whole elements, so the compiler emits a `bswap` for each.
+        using value_t = typename std::conditional<W == 2, uint16_t,
+        typename std::conditional<W == 4, uint32_t, uint64_t>::type>::type;
+        for (; i < bytes; i += W)
+          {
+            value_t v;
+            std::memcpy (&v, src + i, W);
+            v = byte_swap (v);
+            std::memcpy (dst + i, &v, W);
+          }
+      }
+
+    /**
+     * @brief Conversions between values and target memory bytes,
+     * for a target byte order known at compile time.
+     *
+     * @details
+     * Scalar accesses use `memcpy()`, which compilers turn into
+     * plain loads and stores, followed by a byte swap only when
+     * the target and the host byte orders differ.
+     */
+    template<endianness E>
+      class endian_codec
+      {
+      public:
+
+        constexpr static endianness target_endianness = E;
+        constexpr static bool swaps = (E != host_endianness);
+
+      public:
+
+        template<typename V>
+          static inline V
+          load (const uint8_t* p)
+          {
+            V v;
+            std::memcpy (&v, p, sizeof(v));
+            return swaps ? byte_swap (v) : v;
+          }
+
+        template<typename V>
+          static inline void
+          store (uint8_t* p, V v)
+          {
+            if (swaps)
+              {
+                v = byte_swap (v);
+              }
+            std::memcpy (p, &v, sizeof(v));
+          }
+
+        static inline uint16_t
+        load_short (const uint8_t* p)
+        {
+          return load<uint16_t> (p);
+        }
+
+        static inline uint32_t
+        load_long (const uint8_t* p)
+        {
+          return load<uint32_t> (p);
+        }
+
+        static inline uint64_t
+        load_long_long (const uint8_t* p)
+        {
+          return load<uint64_t> (p);
+        }
+
+        /**
+         * @brief Convert an array of values from target memory bytes.
+         */
+        template<typename V>
+          static inline void
+          load_array (const uint8_t* src, V* dst, std::size_t count)
+          {
+            copy_array_<sizeof(V)> (src, reinterpret_cast<uint8_t*> (dst),
+                                    count, swaps_t<V> ());
+          }
+
+        /**
+         * @brief Convert an array of values to target memory bytes.
+         */
+        template<typename V>
+          static inline void
+          store_array (const V* src, uint8_t* dst, std::size_t count)
+          {
+            copy_array_<sizeof(V)> (reinterpret_cast<const uint8_t*> (src),
+                                    dst, count, swaps_t<V> ());
+          }
+
+      private:
+
+        // Selected at compile time, so `byte_swap_copy()` is not
+        // instantiated for single bytes or when nothing is swapped.
+        template<typename V>
+          using swaps_t = std::integral_constant<bool,
+          swaps && (sizeof(V) > 1)>;
+
+        template<std::size_t W>
+          static inline void
+          copy_array_ (const uint8_t* src, uint8_t* dst, std::size_t count,
+                       std::true_type)
+          {
+            byte_swap_copy<W> (src, dst, count);
+          }
+
+        template<std::size_t W>
+          static inline void
+          copy_array_ (const uint8_t* src, uint8_t* dst, std::size_t count,
+                       std::false_type)
+          {
+            std::memcpy (dst, src, count * W);
+          }
+      };
+
+    using little_endian_codec = endian_codec<endianness::little>;
+    using big_endian_codec = endian_codec<endianness::big>;
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_ENDIAN_H_ */
@@ -0,0 +1,616 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_HEX_H_
+#define SEGGER_JLINK_SDK_DRTM_HEX_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    constexpr char hex_digits[] = "0123456789abcdef";
+
+#if defined(__SSE2__)
+
+    /**
+     * @brief Convert 16 nibbles (0-15) to lower case hex digits.
+     */
+    inline __m128i
+    hex_nibbles_to_ascii (__m128i n)
+    {
+      const __m128i nine = _mm_set1_epi8 (9);
+      const __m128i zero = _mm_set1_epi8 ('0');
+      // Distance from '9'+1 to 'a'.
+      const __m128i gap = _mm_set1_epi8 ('a' - '0' - 10);
+
+      __m128i letters = _mm_and_si128 (_mm_cmpgt_epi8 (n, nine), gap);
+      return _mm_add_epi8 (_mm_add_epi8 (n, zero), letters);
+    }
+
+#endif /* defined(__SSE2__) */
+
+#if defined(__AVX2__)
+
+    inline __m256i
+    hex_nibbles_to_ascii (__m256i n)
+    {
+      const __m256i nine = _mm256_set1_epi8 (9);
+      const __m256i zero = _mm256_set1_epi8 ('0');
+      const __m256i gap = _mm256_set1_epi8 ('a' - '0' - 10);
+
+      __m256i letters = _mm256_and_si256 (_mm256_cmpgt_epi8 (n, nine), gap);
+      return _mm256_add_epi8 (_mm256_add_epi8 (n, zero), letters);
+    }
+
+#endif /* defined(__AVX2__) */
+
+#if defined(__AVX2__)
+
+    /**
+     * @brief Encode the whole 32 bytes blocks with AVX2 instructions.
+     *
+     * @details
+     * No terminating zero is written.
+     *
+     * @return The number of bytes encoded.
+     */
+    inline std::size_t
+    hex_encode_avx2 (const uint8_t* bytes, std::size_t count, char* out)
+    {
+      const __m256i mask32 = _mm256_set1_epi8 (0x0F);
+      std::size_t i = 0;
+      for (; i + 32 <= count; i += 32)
+        {
+          __m256i v = _mm256_loadu_si256 (
+              reinterpret_cast<const __m256i*> (bytes + i));
+          __m256i hi = hex_nibbles_to_ascii (
+              _mm256_and_si256 (_mm256_srli_epi16(v, 4), mask32));
+          __m256i lo = hex_nibbles_to_ascii (_mm256_and_si256 (v, mask32));
+
+          // Unpacking works within 128-bits lanes; reorder them.
+          __m256i a = _mm256_unpacklo_epi8 (hi, lo);
+          __m256i b = _mm256_unpackhi_epi8 (hi, lo);
+          _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out + 2 * i),
+                               _mm256_permute2x128_si256(a, b, 0x20));
+          _mm256_storeu_si256 (
+              reinterpret_cast<__m256i*> (out + 2 * i + 32),
+              _mm256_permute2x128_si256(a, b, 0x31));
+        }
+      return i;
+    }
+
+#endif /* defined(__AVX2__) */
+
+#if defined(__SSE2__)
+
+    /**
+     * @brief Encode the whole 16 bytes blocks with SSE2 instructions.
+     *
+     * @details
+     * No terminating zero is written.
+     *
+     * @return The number of bytes encoded.
+     */
+    inline std::size_t
+    hex_encode_sse2 (const uint8_t* bytes, std::size_t count, char* out)
+    {
+      const __m128i mask16 = _mm_set1_epi8 (0x0F);
+      std::size_t i = 0;
+      for (; i + 16 <= count; i += 16)
+        {
+          __m128i v = _mm_loadu_si128 (
+              reinterpret_cast<const __m128i*> (bytes + i));
+          __m128i hi = hex_nibbles_to_ascii (
+              _mm_and_si128 (_mm_srli_epi16 (v, 4), mask16));
+          __m128i lo = hex_nibbles_to_ascii (_mm_and_si128 (v, mask16));
+
+          _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + 2 * i),
+                            _mm_unpacklo_epi8 (hi, lo));
+          _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + 2 * i + 16),
+                            _mm_unpackhi_epi8 (hi, lo));
+        }
+      return i;
+    }
+
+#endif /* defined(__SSE2__) */
+
+    /**
+     * @brief Encode bytes with a table lookup.
+     *
+     * @details
+     * No terminating zero is written.
+     */
+    inline void
+    hex_encode_scalar (const uint8_t* bytes, std::size_t count, char* out)
+    {
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          out[2 * i] = hex_digits[bytes[i] >> 4];
+          out[2 * i + 1] = hex_digits[bytes[i] & 0x0F];
+        }
+    }
+
+    /**
+     * @brief Encode bytes as lower case hex digits, two per byte,
+     * in memory order.
+     *
+     * @details
+     * Blocks of 32 or 16 bytes are converted with AVX2 or SSE2
+     * instructions, when the compiler targets them; the rest
+     * with a table lookup.
+     *
+     * @param [in] bytes Pointer to the bytes to encode.
+     * @param [in] count Number of bytes.
+     * @param [out] out Pointer to the output string.
+     * @param [in] out_size Size of the output buffer, including
+     *  the terminating zero.
+     *
+     * @return The length of the string, or <0 if the output buffer
+     *  is too small, in which case nothing is written.
+     */
+    inline int
+    hex_encode (const uint8_t* bytes, std::size_t count, char* out,
+                std::size_t out_size)
+    {
+      if (out_size == 0 || count > (out_size - 1) / 2)
+        {
+          return -1;
+        }
+
+      std::size_t i = 0;
+
+#if defined(__AVX2__)
+      i += hex_encode_avx2 (bytes, count, out);
+#endif /* defined(__AVX2__) */
+
+#if defined(__SSE2__)
+      i += hex_encode_sse2 (bytes + i, count - i, out + 2 * i);
+#endif /* defined(__SSE2__) */
+
+      hex_encode_scalar (bytes + i, count - i, out + 2 * i);
+
+      out[2 * count] = '\0';
+      return static_cast<int> (2 * count);
+    }
+
+    /**
+     * @brief Encode 32-bits register values as hex, each in
+     * target byte order, as expected by `RTOS_GetThreadRegList()`
+     * and `RTOS_GetThreadReg()`.
+     *
+     * @param [in] values Pointer to the register values.
+     * @param [in] count Number of registers.
+     * @param [in] little_endian True if the target is little endian.
+     * @param [out] out Pointer to the output string.
+     * @param [in] out_size Size of the output buffer, including
+     *  the terminating zero.
+     *
+     * @return The length of the string (8 digits per register),
+     *  or <0 if the output buffer is too small.
+     */
+    inline int
+    hex_encode_registers (const uint32_t* values, std::size_t count,
+                          bool little_endian, char* out,
+                          std::size_t out_size)
+    {
+      if (out_size == 0 || count > (out_size - 1) / 8)
+        {
+          return -1;
+        }
+
+      // Convert to target order in blocks, then encode the bytes.
+      constexpr std::size_t block_registers = 16;
+      uint8_t buf[4 * block_registers];
+
+      std::size_t done = 0;
+      while (done < count)
+        {
+          std::size_t n = count - done;
+          if (n > block_registers)
+            {
+              n = block_registers;
+            }
+
+          if (little_endian)
+            {
+              little_endian_codec::store_array (values + done, &buf[0], n);
+            }
+          else
+            {
+              big_endian_codec::store_array (values + done, &buf[0], n);
+            }
+
+          hex_encode (&buf[0], 4 * n, out + 8 * done, out_size - 8 * done);
+          done += n;
+        }
+
+      out[8 * count] = '\0';
+      return static_cast<int> (8 * count);
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Errors returned by `hex_decode()`.
+     */
+    constexpr int hex_error_invalid_digit = -1;
+    constexpr int hex_error_odd_length = -2;
+    constexpr int hex_error_no_space = -3;
+    // Even, but not a whole number of registers.
+    constexpr int hex_error_register_length = -4;
+
+    /**
+     * @brief Convert one hex digit, in either case.
+     *
+     * @return The value (0-15), or <0 if not a hex digit.
+     */
+    inline int
+    hex_digit_value (char c)
+    {
+      if (c >= '0' && c <= '9')
+        {
+          return c - '0';
+        }
+      if (c >= 'a' && c <= 'f')
+        {
+          return c - 'a' + 10;
+        }
+      if (c >= 'A' && c <= 'F')
+        {
+          return c - 'A' + 10;
+        }
+      return -1;
+    }
+
+#if defined(__SSE2__)
+
+    /**
+     * @brief Convert 16 hex digits to their values.
+     *
+     * @param [out] valid Mask with one bit per valid digit.
+     */
+    inline __m128i
+    hex_ascii_to_nibbles (__m128i c, int* valid)
+    {
+      const __m128i minus_one = _mm_set1_epi8 (-1);
+
+      __m128i d = _mm_sub_epi8 (c, _mm_set1_epi8 ('0'));
+      __m128i is_digit = _mm_and_si128 (_mm_cmpgt_epi8 (d, minus_one),
+                                        _mm_cmplt_epi8 (d, _mm_set1_epi8 (10)));
+
+      // Folding to lower case keeps non letters out of range.
+      __m128i l = _mm_sub_epi8 (_mm_or_si128 (c, _mm_set1_epi8 (0x20)),
+                                _mm_set1_epi8 ('a'));
+      __m128i is_letter = _mm_and_si128 (_mm_cmpgt_epi8 (l, minus_one),
+                                         _mm_cmplt_epi8 (l, _mm_set1_epi8 (6)));
+
+      *valid = _mm_movemask_epi8 (_mm_or_si128 (is_digit, is_letter));
+
+      return _mm_or_si128 (
+          _mm_and_si128 (is_digit, d),
+          _mm_and_si128 (is_letter, _mm_add_epi8 (l, _mm_set1_epi8 (10))));
+    }
+
+#endif /* defined(__SSE2__) */
+
+#if defined(__AVX2__)
+
+    inline __m256i
+    hex_ascii_to_nibbles (__m256i c, int* valid)
+    {
+      const __m256i minus_one = _mm256_set1_epi8 (-1);
+
+      __m256i d = _mm256_sub_epi8 (c, _mm256_set1_epi8 ('0'));
+      __m256i is_digit = _mm256_and_si256 (
+          _mm256_cmpgt_epi8 (d, minus_one),
+          _mm256_cmpgt_epi8 (_mm256_set1_epi8 (10), d));
+
+      __m256i l = _mm256_sub_epi8 (
+          _mm256_or_si256 (c, _mm256_set1_epi8 (0x20)),
+          _mm256_set1_epi8 ('a'));
+      __m256i is_letter = _mm256_and_si256 (
+          _mm256_cmpgt_epi8 (l, minus_one),
+          _mm256_cmpgt_epi8 (_mm256_set1_epi8 (6), l));
+
+      *valid = _mm256_movemask_epi8 (_mm256_or_si256 (is_digit, is_letter));
+
+      return _mm256_or_si256 (
+          _mm256_and_si256 (is_digit, d),
+          _mm256_and_si256 (is_letter,
+                            _mm256_add_epi8 (l, _mm256_set1_epi8 (10))));
+    }
+
+#endif /* defined(__AVX2__) */
+
+    /**
+     * @brief Decode a hex string to bytes, in memory order.
+     *
+     * @details
+     * Blocks of 32 or 16 digits are validated and converted with
+     * AVX2 or SSE2 instructions, when the compiler targets them;
+     * blocks with invalid digits and the tail are processed one
+     * digit at a time. Both upper and lower case digits are accepted.
+     *
+     * If a digit is invalid, the bytes before it may have already
+     * been written to `out`.
+     *
+     * @param [in] hex Pointer to the hex digits.
+     * @param [in] length Number of digits; must be even.
+     * @param [out] out Pointer to the output buffer.
+     * @param [in] out_size Size of the output buffer.
+     * @param [out] error_offset If not NULL, receives the offset of
+     *  the first invalid digit.
+     *
+     * @return The number of bytes decoded, or one of the
+     *  `hex_error_*` codes.
+     */
+    inline int
+    hex_decode (const char* hex, std::size_t length, uint8_t* out,
+                std::size_t out_size, std::size_t* error_offset = nullptr)
+    {
+      if ((length & 1) != 0)
+        {
+          return hex_error_odd_length;
+        }
+      if (length / 2 > out_size)
+        {
+          return hex_error_no_space;
+        }
+
+      std::size_t i = 0;
+
+#if defined(__AVX2__)
+      const __m256i low_byte32 = _mm256_set1_epi16 (0x00FF);
+      for (; i + 32 <= length; i += 32)
+        {
+          int valid;
+          __m256i n = hex_ascii_to_nibbles (
+              _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (hex + i)),
+              &valid);
+          if (valid != -1)
+            {
+              break;
+            }
+
+          __m256i hi = _mm256_slli_epi16 (_mm256_and_si256 (n, low_byte32),
+                                          4);
+          __m256i lo = _mm256_srli_epi16 (n, 8);
+          __m256i bytes = _mm256_or_si256 (hi, lo);
+
+          // Packing works within 128-bits lanes; gather the low halves.
+          __m256i packed = _mm256_permute4x64_epi64 (
+              _mm256_packus_epi16 (bytes, bytes), 0x08);
+          _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + i / 2),
+                            _mm256_castsi256_si128 (packed));
+        }
+#endif /* defined(__AVX2__) */
+
+#if defined(__SSE2__)
+      const __m128i low_byte = _mm_set1_epi16 (0x00FF);
+      for (; i + 16 <= length; i += 16)
+        {
+          int valid;
+          __m128i n = hex_ascii_to_nibbles (
+              _mm_loadu_si128 (reinterpret_cast<const __m128i*> (hex + i)),
+              &valid);
+          if (valid != 0xFFFF)
+            {
+              break;
+            }
+
+          // In each 16-bits lane the first digit is the low byte.
+          __m128i hi = _mm_slli_epi16 (_mm_and_si128 (n, low_byte), 4);
+          __m128i lo = _mm_srli_epi16 (n, 8);
+          __m128i bytes = _mm_or_si128 (hi, lo);
+          _mm_storel_epi64 (reinterpret_cast<__m128i*> (out + i / 2),
+                            _mm_packus_epi16 (bytes, bytes));
+        }
+#endif /* defined(__SSE2__) */
+
+      for (; i < length; i += 2)
+        {
+          int hi = hex_digit_value (hex[i]);
+          int lo = hex_digit_value (hex[i + 1]);
+          if (hi < 0 || lo < 0)
+            {
+              if (error_offset != nullptr)
+                {
+                  *error_offset = (hi < 0) ? i : i + 1;
+                }
+              return hex_error_invalid_digit;
+            }
+          out[i / 2] = static_cast<uint8_t> ((hi << 4) | lo);
+        }
+
+      return static_cast<int> (length / 2);
+    }
+
+    /**
+     * @brief Check that all characters of a string are hex digits.
+     *
+     * @param [in] hex Pointer to the characters.
+     * @param [in] length Number of characters.
+     *
+     * @return The offset of the first invalid digit, or `length`
+     *  if all are valid.
+     */
+    inline std::size_t
+    hex_validate (const char* hex, std::size_t length)
+    {
+      std::size_t i = 0;
+
+#if defined(__AVX2__)
+      for (; i + 32 <= length; i += 32)
+        {
+          int valid;
+          hex_ascii_to_nibbles (
+              _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (hex + i)),
+              &valid);
+          if (valid != -1)
+            {
+              break;
+            }
+        }
+#endif /* defined(__AVX2__) */
+
+#if defined(__SSE2__)
+      for (; i + 16 <= length; i += 16)
+        {
+          int valid;
+          hex_ascii_to_nibbles (
+              _mm_loadu_si128 (reinterpret_cast<const __m128i*> (hex + i)),
+              &valid);
+          if (valid != 0xFFFF)
+            {
+              break;
+            }
+        }
+#endif /* defined(__SSE2__) */
+
+      for (; i < length; ++i)
+        {
+          if (hex_digit_value (hex[i]) < 0)
+            {
+              break;
+            }
+        }
+      return i;
+    }
+
+    /**
+     * @brief Decode a hex string with 32-bits register values, each
+     * in target byte order, as received by `RTOS_SetThreadRegList()`
+     * and `RTOS_SetThreadReg()`.
+     *
+     * @param [in] hex Pointer to the hex digits.
+     * @param [in] length Number of digits; must be a multiple of 8.
+     * @param [in] little_endian True if the target is little endian.
+     * @param [out] values Pointer to the register values.
+     * @param [in] count Number of registers that fit in `values`.
+     * @param [out] error_offset If not NULL, receives the offset of
+     *  the first invalid digit.
+     *
+     * @return The number of registers decoded, or one of the
+     *  `hex_error_*` codes, in which case nothing is written.
+     */
+    inline int
+    hex_decode_registers (const char* hex, std::size_t length,
+                          bool little_endian, uint32_t* values,
+                          std::size_t count,
+                          std::size_t* error_offset = nullptr)
+    {
+      if ((length & 1) != 0)
+        {
+          return hex_error_odd_length;
+        }
+      if ((length % 8) != 0)
+        {
+          return hex_error_register_length;
+        }
+      if (length / 8 > count)
+        {
+          return hex_error_no_space;
+        }
+
+      // Validate all digits first, to leave the registers unchanged.
+      std::size_t invalid = hex_validate (hex, length);
+      if (invalid < length)
+        {
+          if (error_offset != nullptr)
+            {
+              *error_offset = invalid;
+            }
+          return hex_error_invalid_digit;
+        }
+
+      constexpr std::size_t block_registers = 16;
+      uint8_t buf[4 * block_registers];
+
+      std::size_t done = 0;
+      std::size_t registers = length / 8;
+      while (done < registers)
+        {
+          std::size_t n = registers - done;
+          if (n > block_registers)
+            {
+              n = block_registers;
+            }
+
+          hex_decode (hex + 8 * done, 8 * n, &buf[0], sizeof(buf));
+
+          if (little_endian)
+            {
+              little_endian_codec::load_array (&buf[0], values + done, n);
+            }
+          else
+            {
+              big_endian_codec::load_array (&buf[0], values + done, n);
+            }
+          done += n;
+        }
+
+      return static_cast<int> (registers);
+    }
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_HEX_H_ */
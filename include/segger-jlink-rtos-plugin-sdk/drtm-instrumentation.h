@@ -0,0 +1,263 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_INSTRUMENTATION_H_
+#define SEGGER_JLINK_SDK_DRTM_INSTRUMENTATION_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-function.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief The default backend instrumentation policy,
+     * which records nothing.
+     *
+     * @details
+     * All functions are empty and inline, so the backend code
+     * is the same as without instrumentation.
+     */
+    class null_instrumentation
+    {
+    public:
+
+      struct stamp_t
+      {
+      };
+
+      constexpr static bool enabled = false;
+
+    public:
+
+      inline stamp_t
+      begin (void) const
+      {
+        return stamp_t
+          { };
+      }
+
+      inline void
+      end (server_function f __attribute__((unused)),
+           std::size_t bytes __attribute__((unused)),
+           stamp_t stamp __attribute__((unused)))
+      {
+        ;
+      }
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A backend instrumentation policy that records, for
+     * each server API function, the number of calls, the bytes
+     * transferred and a histogram of the call durations.
+     *
+     * @details
+     * Histogram bucket `k` counts the calls that took less than
+     * 2^k nanoseconds (and at least 2^(k-1)), so it covers from
+     * 1 ns to about 4 s.
+     *
+     * Select it with the last backend template parameter, and get
+     * it back via `backend::instrumentation()`.
+     */
+    class call_instrumentation
+    {
+    public:
+
+      using stamp_t = std::chrono::steady_clock::time_point;
+
+      constexpr static bool enabled = true;
+      constexpr static std::size_t histogram_buckets = 33;
+
+      /**
+       * @brief Counters of a server API function.
+       */
+      struct counters_t
+      {
+        uint64_t calls;
+        uint64_t bytes;
+        uint64_t total_ns;
+        uint64_t histogram[histogram_buckets];
+      };
+
+    public:
+
+      inline stamp_t
+      begin (void) const
+      {
+        return std::chrono::steady_clock::now ();
+      }
+
+      void
+      end (server_function f, std::size_t bytes, stamp_t stamp)
+      {
+        uint64_t ns = static_cast<uint64_t> (std::chrono::duration_cast<
+            std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now () - stamp).count ());
+
+        counters_t& c = counters_[static_cast<std::size_t> (f)];
+        ++c.calls;
+        c.bytes += bytes;
+        c.total_ns += ns;
+
+        std::size_t k = 0;
+        while (ns != 0 && k < histogram_buckets - 1)
+          {
+            ns >>= 1;
+            ++k;
+          }
+        ++c.histogram[k];
+      }
+
+      inline const counters_t&
+      counters (server_function f) const
+      {
+        return counters_[static_cast<std::size_t> (f)];
+      }
+
+      void
+      clear (void)
+      {
+        for (counters_t& c : counters_)
+          {
+            c = counters_t
+              { };
+          }
+      }
+
+      /**
+       * @brief Print the counters to a file, one line per function.
+       */
+      void
+      dump (FILE* f) const
+      {
+        char buf[512];
+        for (std::size_t i = 0;
+            i < static_cast<std::size_t> (server_function::count); ++i)
+          {
+            if (format_ (buf, sizeof(buf), static_cast<server_function> (i),
+                         counters_[i]))
+              {
+                fprintf (f, "%s\n", buf);
+              }
+          }
+      }
+
+      /**
+       * @brief Print the counters via `backend::output()`.
+       */
+      template<typename B>
+        void
+        dump (B& backend) const
+        {
+          // Outputs are also counted, so take a snapshot first.
+          counters_t snapshot[static_cast<std::size_t> (server_function::count)];
+          std::memcpy (&snapshot[0], &counters_[0], sizeof(snapshot));
+
+          char buf[512];
+          for (std::size_t i = 0;
+              i < static_cast<std::size_t> (server_function::count); ++i)
+            {
+              if (format_ (buf, sizeof(buf), static_cast<server_function> (i),
+                           snapshot[i]))
+                {
+                  backend.output ("%s", buf);
+                }
+            }
+        }
+
+    private:
+
+      static bool
+      format_ (char* buf, std::size_t size, server_function f,
+               const counters_t& c)
+      {
+        if (c.calls == 0)
+          {
+            return false;
+          }
+
+        int n = snprintf (
+            buf, size, "%-16s %8llu calls %10llu bytes %8llu ns avg",
+            server_function_name (f), static_cast<unsigned long long> (c.calls),
+            static_cast<unsigned long long> (c.bytes),
+            static_cast<unsigned long long> (c.total_ns / c.calls));
+        for (std::size_t k = 0; k < histogram_buckets; ++k)
+          {
+            if (c.histogram[k] != 0 && n > 0
+                && static_cast<std::size_t> (n) < size)
+              {
+                n += snprintf (buf + n, size - static_cast<std::size_t> (n),
+                               " <2^%zu:%llu", k,
+                               static_cast<unsigned long long> (c.histogram[k]));
+              }
+          }
+        return true;
+      }
+
+    private:
+
+      counters_t counters_[static_cast<std::size_t> (server_function::count)] =
+        { };
+    };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_INSTRUMENTATION_H_ */
@@ -0,0 +1,405 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_LIST_H_
+#define SEGGER_JLINK_SDK_DRTM_LIST_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-struct.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    enum class list_status : int
+    {
+      ok, //
+      end, // NULL or sentinel reached
+      cycle, // a node was reached twice
+      bad_pointer, // misaligned or outside the valid range
+      read_error, // the node could not be read
+      limit // too many nodes
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Iterator over an intrusive linked list in target memory.
+     *
+     * @details
+     * Each node is read whole, with a single transaction, as a
+     * `target_struct<L>`; the address of the next node is the
+     * field `F`. The walk stops at NULL or at the sentinel (the
+     * address of the list head for circular lists), and reports
+     * cycles (with Brent's algorithm, in constant space) and
+     * pointers that are misaligned or outside the valid range.
+     *
+     * When read-ahead is enabled, each read fetches `W` bytes
+     * starting with the node; if the following nodes were allocated
+     * contiguously, as from a pool, they are then taken from this
+     * window, without new transactions. If the larger read fails,
+     * for example at the end of a memory region, only the node
+     * is read.
+     *
+     * @code{.cpp}
+     * list_walker<backend_t, tcb, tcb::next> w{ backend, first };
+     * while (w.next ())
+     *   {
+     *     uint32_t sp = w.node ().get<tcb::sp> ();
+     *   }
+     * if (w.status () != list_status::end) ...
+     * @endcode
+     *
+     * @tparam B Backend type.
+     * @tparam L Node layout, derived from `struct_layout`.
+     * @tparam F Field of the node pointing to the next node.
+     * @tparam W Size in bytes of the read-ahead window.
+     */
+    template<typename B, typename L, typename F, std::size_t W = 512>
+      class list_walker
+      {
+      public:
+
+        using backend_t = B;
+        using target_addr_t = typename B::target_addr_t;
+        using node_t = target_struct<L>;
+
+        constexpr static std::size_t node_size_bytes = L::size_bytes;
+        constexpr static std::size_t window_size_bytes = W;
+
+        static_assert(W >= L::size_bytes, "window smaller than a node");
+
+        struct stats_t
+        {
+          std::size_t nodes;
+          std::size_t reads;
+          std::size_t read_ahead_hits;
+          std::size_t bytes_read;
+        };
+
+      public:
+
+        list_walker (B& backend, target_addr_t first) :
+            backend_ (backend), //
+            first_ (first), //
+            next_ (first), //
+            address_ (0), //
+            sentinel_ (0), //
+            range_begin_ (0), //
+            range_end_ (0), //
+            alignment_ (4), //
+            max_nodes_ (0), //
+            read_ahead_ (false), //
+            status_ (list_status::ok), //
+            window_base_ (0), //
+            window_bytes_ (0), //
+            tortoise_ (0), //
+            power_ (1), //
+            lambda_ (0), //
+            stats_
+              { }
+        {
+          node_.set_little_endian (backend_.is_target_little_endian ());
+        }
+
+        // The rule of five.
+        list_walker (const list_walker&) = delete;
+        list_walker (list_walker&&) = delete;
+        list_walker&
+        operator= (const list_walker&) = delete;
+        list_walker&
+        operator= (list_walker&&) = delete;
+
+        ~list_walker () = default;
+
+      public:
+
+        /**
+         * @brief Set the address that ends the list, in addition
+         * to NULL.
+         */
+        inline void
+        set_sentinel (target_addr_t addr)
+        {
+          sentinel_ = addr;
+        }
+
+        /**
+         * @brief Set the range of valid node addresses; nodes must
+         * be entirely inside [begin, end). By default any address
+         * is accepted.
+         */
+        inline void
+        set_range (target_addr_t begin, target_addr_t end)
+        {
+          range_begin_ = begin;
+          range_end_ = end;
+        }
+
+        /**
+         * @brief Set the required node alignment, a power of 2.
+         */
+        inline void
+        set_alignment (std::size_t alignment)
+        {
+          assert((alignment & (alignment - 1)) == 0);
+          alignment_ = alignment == 0 ? 1 : alignment;
+        }
+
+        /**
+         * @brief Set the maximum number of nodes; 0 means no limit.
+         */
+        inline void
+        set_max_nodes (std::size_t count)
+        {
+          max_nodes_ = count;
+        }
+
+        inline void
+        set_read_ahead (bool enable)
+        {
+          read_ahead_ = enable;
+          window_bytes_ = 0;
+        }
+
+        /**
+         * @brief Advance to the next node.
+         *
+         * @par Returns
+         *  True if a node is available; false at the end of the
+         *  list or on error, with the reason given by `status()`.
+         */
+        bool
+        next (void)
+        {
+          if (status_ != list_status::ok)
+            {
+              return false;
+            }
+
+          target_addr_t addr = next_;
+          if (addr == 0 || (addr == sentinel_ && sentinel_ != 0))
+            {
+              status_ = list_status::end;
+              return false;
+            }
+          if (max_nodes_ != 0 && stats_.nodes >= max_nodes_)
+            {
+              status_ = list_status::limit;
+              return false;
+            }
+          if (!is_valid_ (addr))
+            {
+              status_ = list_status::bad_pointer;
+              return false;
+            }
+
+          // Brent: compare with the node saved at the last power of 2.
+          if (stats_.nodes != 0 && addr == tortoise_)
+            {
+              status_ = list_status::cycle;
+              return false;
+            }
+          if (++lambda_ == power_)
+            {
+              tortoise_ = addr;
+              power_ *= 2;
+              lambda_ = 0;
+            }
+
+          if (fetch_ (addr) < 0)
+            {
+              status_ = list_status::read_error;
+              return false;
+            }
+
+          address_ = addr;
+          next_ = static_cast<target_addr_t> (node_.template get<F> ());
+          ++stats_.nodes;
+          return true;
+        }
+
+        /**
+         * @brief Restart the walk from the first node.
+         */
+        void
+        rewind (void)
+        {
+          next_ = first_;
+          address_ = 0;
+          status_ = list_status::ok;
+          tortoise_ = 0;
+          power_ = 1;
+          lambda_ = 0;
+          window_bytes_ = 0;
+          stats_.nodes = 0;
+        }
+
+        inline const node_t&
+        node (void) const
+        {
+          return node_;
+        }
+
+        /**
+         * @brief Get the target address of the current node.
+         */
+        inline target_addr_t
+        address (void) const
+        {
+          return address_;
+        }
+
+        inline list_status
+        status (void) const
+        {
+          return status_;
+        }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+      private:
+
+        bool
+        is_valid_ (target_addr_t addr) const
+        {
+          if ((addr & (alignment_ - 1)) != 0)
+            {
+              return false;
+            }
+          if (range_end_ != 0
+              && (addr < range_begin_ || addr > range_end_
+                  || range_end_ - addr < node_size_bytes))
+            {
+              return false;
+            }
+          return true;
+        }
+
+        int
+        fetch_ (target_addr_t addr)
+        {
+          if (window_bytes_ != 0 && addr >= window_base_
+              && addr - window_base_ <= window_bytes_ - node_size_bytes)
+            {
+              std::memcpy (node_.data (), &window_[addr - window_base_],
+                           node_size_bytes);
+              ++stats_.read_ahead_hits;
+              return 0;
+            }
+
+          if (read_ahead_)
+            {
+              std::size_t bytes = W;
+              if (range_end_ != 0 && range_end_ - addr < bytes)
+                {
+                  bytes = range_end_ - addr;
+                }
+
+              ++stats_.reads;
+              stats_.bytes_read += bytes;
+              if (backend_.read_byte_array (addr, &window_[0], bytes) >= 0)
+                {
+                  window_base_ = addr;
+                  window_bytes_ = bytes;
+                  std::memcpy (node_.data (), &window_[0], node_size_bytes);
+                  return 0;
+                }
+              window_bytes_ = 0;
+            }
+
+          ++stats_.reads;
+          stats_.bytes_read += node_size_bytes;
+          return backend_.read_struct (addr, node_);
+        }
+
+      private:
+
+        B& backend_;
+        node_t node_;
+
+        target_addr_t first_;
+        target_addr_t next_;
+        target_addr_t address_;
+        target_addr_t sentinel_;
+        target_addr_t range_begin_;
+        target_addr_t range_end_;
+        std::size_t alignment_;
+        std::size_t max_nodes_;
+        bool read_ahead_;
+        list_status status_;
+
+        target_addr_t window_base_;
+        std::size_t window_bytes_;
+
+        target_addr_t tortoise_;
+        std::size_t power_;
+        std::size_t lambda_;
+
+        stats_t stats_;
+
+        uint8_t window_[W];
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_LIST_H_ */
@@ -37,6 +37,9 @@
  * Internet: www.segger.com        Support:  support@segger.com
  */
 
+#ifndef SEGGER_JLINK_SDK_DRTM_MEMORY_H_
+#define SEGGER_JLINK_SDK_DRTM_MEMORY_H_
+
 #include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
 #include <stdio.h>
 
@@ -44,6 +47,12 @@
 
 #include <drtm/memory.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
 namespace segger
 {
   namespace drtm
@@ -130,12 +139,978 @@ namespace segger
           return allocator (api_);
         }
 
+        const server_api_t*
+        get_api (void) const noexcept
+        {
+          return api_;
+        }
+
+      private:
+
+      private:
+        const server_api_t* api_;
+      };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A monotonic memory arena, with chunks allocated via
+     * the server `malloc()` function.
+     *
+     * @details
+     * Allocations are served by incrementing a pointer in the current
+     * chunk; individual blocks are never freed. `reset()` makes all
+     * memory available again in O(1), keeping the chunks for reuse,
+     * so that, in steady state, rebuilding the plug-in data on each
+     * `RTOS_UpdateThreads()` does not call the server at all.
+     */
+    template<typename S>
+      class arena
+      {
+      public:
+
+        using server_api_t = S;
+
+        constexpr static std::size_t default_chunk_size_bytes = 4096;
+
+      public:
+
+        arena (const server_api_t* api, std::size_t chunk_size_bytes =
+                   default_chunk_size_bytes) noexcept :
+            api_ (api), //
+            chunk_size_bytes_ (chunk_size_bytes), //
+            head_ (nullptr), //
+            current_ (nullptr), //
+            offset_ (0)
+        {
+#if defined(DEBUG)
+          printf ("%s(%p, %zu) @%p\n", __func__, api, chunk_size_bytes, this);
+#endif /* defined(DEBUG) */
+          ;
+        }
+
+        // The rule of five.
+        arena (const arena&) = delete;
+        arena (arena&&) = delete;
+        arena&
+        operator= (const arena&) = delete;
+        arena&
+        operator= (arena&&) = delete;
+
+        ~arena ()
+        {
+          release ();
+        }
+
+      public:
+
+        /**
+         * @brief Allocate a block from the arena.
+         *
+         * @param [in] bytes Size of the block.
+         * @param [in] alignment Block alignment; must be a power of 2.
+         *
+         * @return Pointer to the block. NULL, if the memory could not
+         *  be allocated, or if the chunk size would overflow `size_t`.
+         */
+        void*
+        allocate (std::size_t bytes, std::size_t alignment =
+                      alignof(std::max_align_t))
+        {
+          assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+          if (bytes > std::numeric_limits<std::size_t>::max () - alignment
+                  - sizeof(chunk_t))
+            {
+              return nullptr;
+            }
+
+          // Restored if no chunk can be allocated, so the space left
+          // in the chunks already used may serve smaller blocks.
+          chunk_t* start = current_;
+          std::size_t start_offset = offset_;
+
+          chunk_t* last = nullptr;
+          while (current_ != nullptr)
+            {
+              void* p = take_ (bytes, alignment);
+              if (p != nullptr)
+                {
+                  return p;
+                }
+              // Continue with the next chunk, if any was kept by reset().
+              last = current_;
+              current_ = current_->next;
+              offset_ = 0;
+            }
+
+          std::size_t size_bytes = bytes + alignment;
+          if (size_bytes < chunk_size_bytes_)
+            {
+              size_bytes = chunk_size_bytes_;
+            }
+
+          chunk_t* chunk = static_cast<chunk_t*> (api_->malloc (
+              sizeof(chunk_t) + size_bytes));
+
+#if defined(DEBUG)
+          printf ("%s(%zu)=%p %p\n", __func__, size_bytes, chunk, this);
+#endif /* defined(DEBUG) */
+
+          if (chunk == nullptr)
+            {
+              current_ = start;
+              offset_ = start_offset;
+              return nullptr;
+            }
+
+          chunk->next = nullptr;
+          chunk->size_bytes = size_bytes;
+          if (last != nullptr)
+            {
+              last->next = chunk;
+            }
+          else
+            {
+              head_ = chunk;
+            }
+
+          current_ = chunk;
+          offset_ = 0;
+          return take_ (bytes, alignment);
+        }
+
+        /**
+         * @brief Make all arena memory available again.
+         *
+         * @details
+         * All blocks previously allocated become invalid; the chunks
+         * are kept and reused by the next allocations.
+         */
+        void
+        reset (void) noexcept
+        {
+          current_ = head_;
+          offset_ = 0;
+        }
+
+        /**
+         * @brief Return all chunks to the server.
+         */
+        void
+        release (void) noexcept
+        {
+          chunk_t* chunk = head_;
+          while (chunk != nullptr)
+            {
+              chunk_t* next = chunk->next;
+              api_->free (chunk);
+              chunk = next;
+            }
+
+          head_ = nullptr;
+          current_ = nullptr;
+          offset_ = 0;
+        }
+
+        /**
+         * @brief Get the total size of the chunks owned by the arena.
+         */
+        std::size_t
+        capacity_bytes (void) const noexcept
+        {
+          std::size_t bytes = 0;
+          for (chunk_t* chunk = head_; chunk != nullptr; chunk = chunk->next)
+            {
+              bytes += chunk->size_bytes;
+            }
+          return bytes;
+        }
+
+      private:
+
+        struct chunk_t
+        {
+          chunk_t* next;
+          std::size_t size_bytes;
+          // Followed by the payload, aligned to max_align_t.
+          alignas(std::max_align_t) uint8_t payload[1];
+        };
+
+        void*
+        take_ (std::size_t bytes, std::size_t alignment) noexcept
+        {
+          uintptr_t base = reinterpret_cast<uintptr_t> (&current_->payload[0]);
+          uintptr_t p = (base + offset_ + alignment - 1)
+              & ~static_cast<uintptr_t> (alignment - 1);
+          std::size_t start = static_cast<std::size_t> (p - base);
+          if (start > current_->size_bytes
+              || bytes > current_->size_bytes - start)
+            {
+              return nullptr;
+            }
+
+          offset_ = start + bytes;
+          return reinterpret_cast<void*> (p);
+        }
+
+      private:
+
+        const server_api_t* api_;
+        std::size_t chunk_size_bytes_;
+
+        chunk_t* head_;
+        chunk_t* current_;
+        std::size_t offset_;
+      };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief A standard allocator that allocates memory from
+     * an arena.
+     *
+     * @details
+     * `deallocate()` does nothing; memory is reclaimed only
+     * by `arena::reset()`, which must not be called while
+     * containers using this allocator still hold elements.
+     */
+    template<typename T, typename S>
+      class arena_allocator
+      {
+      public:
+
+        // Standard types.
+        using value_type = T;
+        using server_api_t = S;
+        using arena_t = arena<S>;
+
+      public:
+
+        arena_allocator (arena_t* arena) noexcept
+        {
+          arena_ = arena;
+        }
+
+        arena_allocator (arena_allocator const & a) = default;
+
+        template<typename U>
+          arena_allocator (arena_allocator<U, S> const & other) noexcept
+          {
+            arena_ = other.get_arena ();
+          }
+
+        arena_allocator&
+        operator= (arena_allocator const & a) = default;
+
+        value_type*
+        allocate (std::size_t objects)
+        {
+          if (objects > max_size ())
+            {
+              throw std::system_error (
+                  std::error_code (EINVAL, std::system_category ()));
+            }
+
+          return static_cast<value_type*> (arena_->allocate (
+              objects * sizeof(value_type), alignof(value_type)));
+        }
+
+        void
+        deallocate (value_type* p __attribute__((unused)),
+                    std::size_t objects __attribute__((unused))) noexcept
+        {
+          assert(objects <= max_size ());
+        }
+
+        std::size_t
+        max_size (void) const noexcept
+        {
+          return std::numeric_limits<std::size_t>::max () / sizeof(value_type);
+        }
+
+        arena_t*
+        get_arena (void) const noexcept
+        {
+          return arena_;
+        }
+
+      private:
+        arena_t* arena_;
+      };
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator== (arena_allocator<T, S> const & a,
+                  arena_allocator<U, S> const & b) noexcept
+      {
+        return a.get_arena () == b.get_arena ();
+      }
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator!= (arena_allocator<T, S> const & a,
+                  arena_allocator<U, S> const & b) noexcept
+      {
+        return a.get_arena () != b.get_arena ();
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A pool of fixed size slots, with slabs allocated via
+     * the server `malloc()` function.
+     *
+     * @details
+     * Free slots are kept in a singly linked list; slabs are
+     * returned to the server only by `release()` or by the
+     * destructor, so once the pool reached the high-water mark,
+     * creating and destroying objects in bulk on each update
+     * does not call the server at all.
+     */
+    template<typename S>
+      class pool
+      {
+      public:
+
+        using server_api_t = S;
+
+        constexpr static std::size_t default_slab_slots = 32;
+
+        /**
+         * @brief Pool statistics.
+         */
+        struct stats_t
+        {
+          // Slabs allocated from the server.
+          std::size_t slabs;
+          // Slots currently in use.
+          std::size_t live_objects;
+          // Largest number of slots simultaneously in use.
+          std::size_t high_water_mark;
+        };
+
+      public:
+
+        pool (const server_api_t* api, std::size_t slot_size_bytes,
+              std::size_t slab_slots = default_slab_slots) noexcept :
+            api_ (api), //
+            slot_size_bytes_ (round_slot_size_ (slot_size_bytes)), //
+            slab_slots_ (slab_slots), //
+            slabs_ (nullptr), //
+            free_ (nullptr), //
+            stats_
+              { }
+        {
+#if defined(DEBUG)
+          printf ("%s(%p, %zu, %zu) @%p\n", __func__, api, slot_size_bytes,
+                  slab_slots, this);
+#endif /* defined(DEBUG) */
+
+          assert(slab_slots != 0);
+        }
+
+        // The rule of five.
+        pool (const pool&) = delete;
+        pool (pool&&) = delete;
+        pool&
+        operator= (const pool&) = delete;
+        pool&
+        operator= (pool&&) = delete;
+
+        ~pool ()
+        {
+          release ();
+        }
+
+      public:
+
+        /**
+         * @brief Allocate one slot.
+         *
+         * @return Pointer to the slot. NULL, if the memory could not
+         *  be allocated.
+         */
+        void*
+        allocate (void)
+        {
+          if (free_ == nullptr && !add_slab_ ())
+            {
+              return nullptr;
+            }
+
+          free_slot_t* slot = free_;
+          free_ = slot->next;
+
+          if (++stats_.live_objects > stats_.high_water_mark)
+            {
+              stats_.high_water_mark = stats_.live_objects;
+            }
+          return slot;
+        }
+
+        /**
+         * @brief Return one slot to the pool.
+         */
+        void
+        deallocate (void* p) noexcept
+        {
+          if (p == nullptr)
+            {
+              return;
+            }
+
+          assert(stats_.live_objects > 0);
+          --stats_.live_objects;
+
+          free_slot_t* slot = static_cast<free_slot_t*> (p);
+          slot->next = free_;
+          free_ = slot;
+        }
+
+        /**
+         * @brief Return all slabs to the server.
+         *
+         * @details
+         * All slots must have been deallocated.
+         */
+        void
+        release (void) noexcept
+        {
+          assert(stats_.live_objects == 0);
+
+          slab_t* slab = slabs_;
+          while (slab != nullptr)
+            {
+              slab_t* next = slab->next;
+              api_->free (slab);
+              slab = next;
+            }
+
+          slabs_ = nullptr;
+          free_ = nullptr;
+          stats_.slabs = 0;
+        }
+
+        inline std::size_t
+        slot_size_bytes (void) const noexcept
+        {
+          return slot_size_bytes_;
+        }
+
+        inline const stats_t&
+        stats (void) const noexcept
+        {
+          return stats_;
+        }
+
+      private:
+
+        struct free_slot_t
+        {
+          free_slot_t* next;
+        };
+
+        struct slab_t
+        {
+          slab_t* next;
+          // Followed by the slots, aligned to max_align_t.
+          alignas(std::max_align_t) uint8_t slots[1];
+        };
+
+        static constexpr std::size_t
+        round_slot_size_ (std::size_t bytes) noexcept
+        {
+          return (bytes < sizeof(free_slot_t)) ?
+              round_slot_size_ (sizeof(free_slot_t)) :
+              (bytes + alignof(std::max_align_t) - 1)
+                  & ~(alignof(std::max_align_t) - 1);
+        }
+
+        bool
+        add_slab_ (void)
+        {
+          slab_t* slab = static_cast<slab_t*> (api_->malloc (
+              offsetof(slab_t, slots) + slot_size_bytes_ * slab_slots_));
+
+#if defined(DEBUG)
+          printf ("%s()=%p %p\n", __func__, slab, this);
+#endif /* defined(DEBUG) */
+
+          if (slab == nullptr)
+            {
+              return false;
+            }
+
+          slab->next = slabs_;
+          slabs_ = slab;
+          ++stats_.slabs;
+
+          // Link the new slots in address order.
+          for (std::size_t i = slab_slots_; i > 0; --i)
+            {
+              free_slot_t* slot = reinterpret_cast<free_slot_t*> (&slab->slots[(i
+                  - 1) * slot_size_bytes_]);
+              slot->next = free_;
+              free_ = slot;
+            }
+          return true;
+        }
+
+      private:
+
+        const server_api_t* api_;
+        std::size_t slot_size_bytes_;
+        std::size_t slab_slots_;
+
+        slab_t* slabs_;
+        free_slot_t* free_;
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief A standard allocator that allocates single objects
+     * from a pool.
+     *
+     * @details
+     * Requests for single objects that fit in a pool slot (like
+     * thread descriptors or list nodes) are served by the pool;
+     * other requests are forwarded to the server `malloc()`.
+     */
+    template<typename T, typename S>
+      class pool_allocator
+      {
+      public:
+
+        // Standard types.
+        using value_type = T;
+        using server_api_t = S;
+        using pool_t = pool<S>;
+
+      public:
+
+        pool_allocator (pool_t* pool, const server_api_t* api) noexcept
+        {
+          pool_ = pool;
+          api_ = api;
+        }
+
+        pool_allocator (pool_allocator const & a) = default;
+
+        template<typename U>
+          pool_allocator (pool_allocator<U, S> const & other) noexcept
+          {
+            pool_ = other.get_pool ();
+            api_ = other.get_api ();
+          }
+
+        pool_allocator&
+        operator= (pool_allocator const & a) = default;
+
+        value_type*
+        allocate (std::size_t objects)
+        {
+          if (objects > max_size ())
+            {
+              throw std::system_error (
+                  std::error_code (EINVAL, std::system_category ()));
+            }
+
+          if (is_pooled_ (objects))
+            {
+              return static_cast<value_type*> (pool_->allocate ());
+            }
+
+          return static_cast<value_type*> (api_->malloc (
+              objects * sizeof(value_type)));
+        }
+
+        void
+        deallocate (value_type* p, std::size_t objects) noexcept
+        {
+          assert(objects <= max_size ());
+
+          if (is_pooled_ (objects))
+            {
+              pool_->deallocate (p);
+            }
+          else
+            {
+              api_->free (p);
+            }
+        }
+
+        std::size_t
+        max_size (void) const noexcept
+        {
+          return std::numeric_limits<std::size_t>::max () / sizeof(value_type);
+        }
+
+        pool_t*
+        get_pool (void) const noexcept
+        {
+          return pool_;
+        }
+
+        const server_api_t*
+        get_api (void) const noexcept
+        {
+          return api_;
+        }
+
+      private:
+
+        inline bool
+        is_pooled_ (std::size_t objects) const noexcept
+        {
+          return objects == 1 && sizeof(value_type) <= pool_->slot_size_bytes ()
+              && alignof(value_type) <= alignof(std::max_align_t);
+        }
+
+      private:
+        pool_t* pool_;
+        const server_api_t* api_;
+      };
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator== (pool_allocator<T, S> const & a,
+                  pool_allocator<U, S> const & b) noexcept
+      {
+        return a.get_pool () == b.get_pool ();
+      }
+
+    template<typename T, typename U, typename S>
+      inline bool
+      operator!= (pool_allocator<T, S> const & a,
+                  pool_allocator<U, S> const & b) noexcept
+      {
+        return a.get_pool () != b.get_pool ();
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A growable array of trivially copyable objects, with
+     * storage resized via the server `realloc()` function.
+     *
+     * @details
+     * Since the objects can be moved with `memcpy()`, the storage
+     * is grown with `realloc()`, which can often extend the block
+     * in place, instead of allocating a new block and copying the
+     * content, as containers using `allocator` do.
+     *
+     * The server `realloc()` takes the size as `unsigned`; larger
+     * blocks, and blocks the server fails to `realloc()`, are
+     * allocated with `malloc()` and the content is copied.
+     *
+     * Errors are reported by return values; on failure the content
+     * is preserved.
+     */
+    template<typename T, typename S>
+      class pod_buffer
+      {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "T must be trivially copyable");
+
+      public:
+
+        using value_type = T;
+        using server_api_t = S;
+
+        constexpr static std::size_t default_initial_capacity = 64;
+
+        /**
+         * @brief Growth statistics.
+         */
+        struct stats_t
+        {
+          // Times the storage was grown.
+          std::size_t grows;
+          // Grows that returned a different block.
+          std::size_t moves;
+          // Bytes copied by the buffer itself, when `realloc()`
+          // could not be used.
+          std::size_t copied_bytes;
+        };
+
+      public:
+
+        pod_buffer (const server_api_t* api, std::size_t initial_capacity =
+                        default_initial_capacity) noexcept :
+            api_ (api), //
+            data_ (nullptr), //
+            size_ (0), //
+            capacity_ (0), //
+            initial_capacity_ (
+                initial_capacity != 0 ? initial_capacity : 1), //
+            stats_
+              { }
+        {
+#if defined(DEBUG)
+          printf ("%s(%p, %zu) @%p\n", __func__, api, initial_capacity, this);
+#endif /* defined(DEBUG) */
+          ;
+        }
+
+        // The rule of five.
+        pod_buffer (const pod_buffer&) = delete;
+        pod_buffer (pod_buffer&&) = delete;
+        pod_buffer&
+        operator= (const pod_buffer&) = delete;
+        pod_buffer&
+        operator= (pod_buffer&&) = delete;
+
+        ~pod_buffer ()
+        {
+          release ();
+        }
+
+      public:
+
+        /**
+         * @brief Make room for at least `objects` objects.
+         *
+         * @retval 0 The storage is large enough.
+         * @retval -1 The memory could not be allocated.
+         */
+        inline int
+        reserve (std::size_t objects)
+        {
+          return (objects <= capacity_) ? 0 : grow_ (objects);
+        }
+
+        /**
+         * @brief Change the number of objects; new objects are
+         *  not initialised.
+         */
+        int
+        resize (std::size_t objects)
+        {
+          if (reserve (objects) < 0)
+            {
+              return -1;
+            }
+          size_ = objects;
+          return 0;
+        }
+
+        /**
+         * @brief Add `objects` uninitialised objects at the end.
+         *
+         * @return Pointer to the first added object. NULL, if the
+         *  memory could not be allocated.
+         */
+        value_type*
+        extend (std::size_t objects)
+        {
+          if (objects > max_size () - size_ || reserve (size_ + objects) < 0)
+            {
+              return nullptr;
+            }
+
+          value_type* p = data_ + size_;
+          size_ += objects;
+          return p;
+        }
+
+        /**
+         * @brief Copy `objects` objects at the end.
+         */
+        int
+        append (const value_type* array, std::size_t objects)
+        {
+          if (objects == 0)
+            {
+              return 0;
+            }
+
+          value_type* p = extend (objects);
+          if (p == nullptr)
+            {
+              return -1;
+            }
+          std::memcpy (p, array, objects * sizeof(value_type));
+          return 0;
+        }
+
+        inline int
+        push_back (const value_type& value)
+        {
+          return append (&value, 1);
+        }
+
+        /**
+         * @brief Remove all objects, keeping the storage.
+         */
+        inline void
+        clear (void) noexcept
+        {
+          size_ = 0;
+        }
+
+        /**
+         * @brief Return the storage to the server.
+         */
+        void
+        release (void) noexcept
+        {
+          if (data_ != nullptr)
+            {
+              api_->free (data_);
+            }
+
+          data_ = nullptr;
+          size_ = 0;
+          capacity_ = 0;
+        }
+
+        inline value_type*
+        data (void) noexcept
+        {
+          return data_;
+        }
+
+        inline const value_type*
+        data (void) const noexcept
+        {
+          return data_;
+        }
+
+        inline value_type&
+        operator[] (std::size_t i) noexcept
+        {
+          assert(i < size_);
+          return data_[i];
+        }
+
+        inline const value_type&
+        operator[] (std::size_t i) const noexcept
+        {
+          assert(i < size_);
+          return data_[i];
+        }
+
+        inline std::size_t
+        size (void) const noexcept
+        {
+          return size_;
+        }
+
+        inline std::size_t
+        size_bytes (void) const noexcept
+        {
+          return size_ * sizeof(value_type);
+        }
+
+        inline std::size_t
+        capacity (void) const noexcept
+        {
+          return capacity_;
+        }
+
+        inline bool
+        empty (void) const noexcept
+        {
+          return size_ == 0;
+        }
+
+        std::size_t
+        max_size (void) const noexcept
+        {
+          return std::numeric_limits<std::size_t>::max () / sizeof(value_type);
+        }
+
+        inline const stats_t&
+        stats (void) const noexcept
+        {
+          return stats_;
+        }
+
       private:
 
+        /**
+         * @brief Grow the storage by doubling its size.
+         */
+        int
+        grow_ (std::size_t objects)
+        {
+          if (objects > max_size ())
+            {
+              return -1;
+            }
+
+          std::size_t new_capacity =
+              (capacity_ != 0) ? capacity_ : initial_capacity_;
+          while (new_capacity < objects)
+            {
+              new_capacity =
+                  (new_capacity <= max_size () / 2) ?
+                      2 * new_capacity : objects;
+            }
+
+          std::size_t bytes = new_capacity * sizeof(value_type);
+          uintptr_t old = reinterpret_cast<uintptr_t> (data_);
+          void* p = nullptr;
+          if (data_ != nullptr
+              && bytes <= std::numeric_limits<unsigned>::max ())
+            {
+              // On failure the old block is left untouched.
+              p = api_->realloc (data_, static_cast<unsigned> (bytes));
+            }
+          if (p == nullptr)
+            {
+              // The first block, a size the server `realloc()`
+              // cannot express, or a failed `realloc()`.
+              p = api_->malloc (bytes);
+              if (p != nullptr && data_ != nullptr)
+                {
+                  std::memcpy (p, data_, size_bytes ());
+                  stats_.copied_bytes += size_bytes ();
+                  api_->free (data_);
+                }
+            }
+
+#if defined(DEBUG)
+          printf ("%s(%zu)=%p %p\n", __func__, bytes, p, this);
+#endif /* defined(DEBUG) */
+
+          if (p == nullptr)
+            {
+              return -1;
+            }
+
+          if (data_ != nullptr)
+            {
+              ++stats_.grows;
+              if (reinterpret_cast<uintptr_t> (p) != old)
+                {
+                  ++stats_.moves;
+                }
+            }
+
+          data_ = static_cast<value_type*> (p);
+          capacity_ = new_capacity;
+          return 0;
+        }
+
       private:
+
         const server_api_t* api_;
+        value_type* data_;
+        std::size_t size_;
+        std::size_t capacity_;
+        std::size_t initial_capacity_;
+        stats_t stats_;
       };
 
+#pragma GCC diagnostic pop
+
     ;
   // Avoid formatter bug
   // ==========================================================================
@@ -143,3 +1118,5 @@ namespace segger
 } /* namespace segger */
 
 #endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_MEMORY_H_ */
@@ -0,0 +1,367 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_REGISTER_CACHE_H_
+#define SEGGER_JLINK_SDK_DRTM_REGISTER_CACHE_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-hex.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-thread-map.h>
+
+#include <cstring>
+#include <cassert>
+#include <type_traits>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Register list of the Cortex-M cores, R0-R12, SP, LR,
+     *  PC and xPSR, with their GDB register numbers.
+     *
+     * @details
+     * GDB numbers the Cortex-M registers as the ARM ones, so
+     * xPSR, after the legacy FPA registers, is 25, not 16.
+     */
+    struct cortex_m_registers
+    {
+      constexpr static std::size_t count = 17;
+      constexpr static std::size_t npos = static_cast<std::size_t> (-1);
+
+      /**
+       * @brief Get the position in the list of a GDB register.
+       *
+       * @return The position, or `npos` for registers not saved
+       *  in the thread context.
+       */
+      static constexpr std::size_t
+      slot (std::size_t gdb_number)
+      {
+        return (gdb_number < 16) ? gdb_number :
+               (gdb_number == 25) ? 16 : npos;
+      }
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Cache of the saved register contexts of the threads,
+     * filled lazily, once per update.
+     *
+     * @details
+     * GDB asks for `RTOS_GetThreadRegList()` and then often for
+     * `RTOS_GetThreadReg()` for individual registers. The first
+     * request for a thread in an update calls the plug-in function
+     * that reads the saved context (usually the exception frame
+     * on the thread stack); the values and their hex encoding,
+     * in target byte order, are kept, so all later requests are
+     * served without target accesses:
+     *
+     * @code{.cpp}
+     * auto fill = [&](thread_id_t id, uint32_t* values)
+     *   {
+     *     return read_saved_context (id, values);
+     *   };
+     *
+     * // RTOS_GetThreadRegList()
+     * return registers.get_reg_list (id, out_hex_values, fill);
+     * @endcode
+     *
+     * The contexts are stored in a dense array allocated with
+     * `allocator` and found via a `thread_map` keyed by thread ID;
+     * `invalidate()` clears them in O(1) at the beginning of each
+     * update.
+     *
+     * The hex encoding uses the byte order of the backend, the
+     * same used to read the saved values from the target.
+     *
+     * @tparam S Server API type.
+     * @tparam R Register list, with the number of registers and
+     *  the mapping of the GDB register numbers to the positions
+     *  in the list; see `cortex_m_registers`.
+     */
+    template<typename S, typename R = cortex_m_registers>
+      class register_cache
+      {
+      public:
+
+        using server_api_t = S;
+        using registers_t = R;
+        using thread_id_t = rtos_plugin_thread_id_t;
+
+        constexpr static std::size_t registers = R::count;
+
+        /**
+         * @brief The register values and their hex encoding.
+         */
+        struct context_t
+        {
+          uint32_t values[registers];
+          char hex[8 * registers + 1];
+        };
+
+        struct stats_t
+        {
+          std::size_t hits;
+          std::size_t fills;
+          std::size_t fill_errors;
+        };
+
+      public:
+
+        template<typename B>
+          register_cache (B& backend) :
+              api_ (backend.get_api ()), //
+              little_endian_ (backend.is_target_little_endian ()), //
+              map_ (allocator<thread_map_slot, server_api_t>
+                { api_ }), //
+              contexts_ (nullptr), //
+              contexts_count_ (0), //
+              used_ (0), //
+              stats_
+                { }
+          {
+            static_assert(std::is_same<typename B::server_api_t, S>::value,
+                "the backend must use the same server API");
+#if defined(DEBUG)
+            printf ("%s(%p) @%p\n", __func__, api_, this);
+#endif /* defined(DEBUG) */
+            ;
+          }
+
+        // The rule of five.
+        register_cache (const register_cache&) = delete;
+        register_cache (register_cache&&) = delete;
+        register_cache&
+        operator= (const register_cache&) = delete;
+        register_cache&
+        operator= (register_cache&&) = delete;
+
+        ~register_cache ()
+        {
+          if (contexts_ != nullptr)
+            {
+              allocator<context_t, server_api_t> contexts_allocator
+                { api_ };
+              contexts_allocator.deallocate (contexts_, contexts_count_);
+            }
+        }
+
+      public:
+
+        /**
+         * @brief Drop all contexts, at the beginning of an update.
+         */
+        void
+        invalidate (void)
+        {
+          map_.clear ();
+          used_ = 0;
+        }
+
+        /**
+         * @brief Get the context of a thread, filling it if needed.
+         *
+         * @param [in] id Thread ID.
+         * @param [in] fill Callable `int (thread_id_t, uint32_t*)`
+         *  storing the `registers` values; <0 on failure.
+         *
+         * @return Pointer to the context, valid until the next
+         *  `invalidate()` or fill, or NULL if the fill failed or
+         *  there was no memory.
+         */
+        template<typename F>
+          const context_t*
+          get (thread_id_t id, F fill)
+          {
+            std::size_t index = map_.find (id);
+            if (index != map_t::npos)
+              {
+                ++stats_.hits;
+                return &contexts_[index];
+              }
+
+            if (used_ == contexts_count_ && grow_ () < 0)
+              {
+                return nullptr;
+              }
+
+            // Fill the next free context; it is added to the map
+            // only if successful, so failed fills are retried.
+            context_t& context = contexts_[used_];
+            ++stats_.fills;
+            if (fill (id, &context.values[0]) < 0)
+              {
+                ++stats_.fill_errors;
+                return nullptr;
+              }
+            if (map_.insert (id, used_) < 0)
+              {
+                return nullptr;
+              }
+            ++used_;
+
+            hex_encode_registers (&context.values[0], registers,
+                                  little_endian_, &context.hex[0],
+                                  sizeof(context.hex));
+            return &context;
+          }
+
+        /**
+         * @brief Copy the hex encoded register list of a thread,
+         *  as expected by `RTOS_GetThreadRegList()`.
+         *
+         * @retval 0 OK.
+         * @retval <0 The context could not be read.
+         */
+        template<typename F>
+          int
+          get_reg_list (thread_id_t id, char* out_hex_values, F fill)
+          {
+            const context_t* context = get (id, fill);
+            if (context == nullptr)
+              {
+                return -1;
+              }
+            std::memcpy (out_hex_values, &context->hex[0],
+                         sizeof(context->hex));
+            return 0;
+          }
+
+        /**
+         * @brief Copy the hex encoded value of a register,
+         *  as expected by `RTOS_GetThreadReg()`.
+         *
+         * @param [in] gdb_number GDB register number, mapped to
+         *  the position in the list by `R::slot()`.
+         *
+         * @retval 0 OK.
+         * @retval <0 Register not in the list, or the context could
+         *  not be read.
+         */
+        template<typename F>
+          int
+          get_reg (thread_id_t id, std::size_t gdb_number,
+                   char* out_hex_value, F fill)
+          {
+            std::size_t index = R::slot (gdb_number);
+            if (index >= registers)
+              {
+                return -1;
+              }
+            const context_t* context = get (id, fill);
+            if (context == nullptr)
+              {
+                return -1;
+              }
+            std::memcpy (out_hex_value, &context->hex[8 * index], 8);
+            out_hex_value[8] = '\0';
+            return 0;
+          }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+      private:
+
+        using map_t = thread_map<allocator<thread_map_slot, server_api_t>>;
+
+        /**
+         * @brief Double the contexts array.
+         */
+        int
+        grow_ (void)
+        {
+          std::size_t count =
+              (contexts_count_ != 0) ? 2 * contexts_count_ : 16;
+
+          allocator<context_t, server_api_t> contexts_allocator
+            { api_ };
+          context_t* contexts = contexts_allocator.allocate (count);
+          if (contexts == nullptr)
+            {
+              return -1;
+            }
+
+          if (contexts_ != nullptr)
+            {
+              std::memcpy (contexts, contexts_, used_ * sizeof(context_t));
+              contexts_allocator.deallocate (contexts_, contexts_count_);
+            }
+          contexts_ = contexts;
+          contexts_count_ = count;
+          return 0;
+        }
+
+      private:
+
+        const server_api_t* api_;
+        bool little_endian_;
+        map_t map_;
+
+        // Dense array of contexts, indexed via the map.
+        context_t* contexts_;
+        std::size_t contexts_count_;
+        std::size_t used_;
+
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_REGISTER_CACHE_H_ */
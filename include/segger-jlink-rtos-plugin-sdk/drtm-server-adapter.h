@@ -0,0 +1,561 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_SERVER_ADAPTER_H_
+#define SEGGER_JLINK_SDK_DRTM_SERVER_ADAPTER_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-function.h>
+
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <cstdarg>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Base class for host side implementations of the
+     * GDB server API.
+     *
+     * @details
+     * The C API table has no context pointer, so the functions of
+     * the table returned by `api()` forward to the active instance
+     * of the derived class `D` (the last one constructed, or the
+     * one passed to `activate()`). The live instances are kept in
+     * a list, in construction order, so they can be destroyed in
+     * any order; when the active instance is destroyed, the one
+     * constructed before it, or else the last one, is activated.
+     *
+     * `D` must implement `read_byte_array()` and `write_byte_array()`;
+     * all other functions have defaults that `D` can hide: the
+     * memory functions use the C library, the output functions
+     * print to `stdout`, the scalar accesses use the array functions
+     * and the `load_*()` functions use `D::is_little_endian()`.
+     *
+     * Each call through the table is counted.
+     */
+    template<typename D>
+      class server_adapter
+      {
+      public:
+
+        using target_addr_t = rtos_plugin_target_addr_t;
+
+        /**
+         * @brief Counters of the calls through the C API table.
+         */
+        struct stats_t
+        {
+          std::size_t calls[static_cast<std::size_t> (server_function::count)];
+          std::size_t bytes_read;
+          std::size_t bytes_written;
+        };
+
+      public:
+
+        server_adapter () :
+            previous_ (last_ ()), //
+            next_ (nullptr), //
+            stats_
+              { }
+        {
+          if (previous_ != nullptr)
+            {
+              previous_->next_ = this;
+            }
+          last_ () = this;
+          activate ();
+        }
+
+        // The rule of five.
+        server_adapter (const server_adapter&) = delete;
+        server_adapter (server_adapter&&) = delete;
+        server_adapter&
+        operator= (const server_adapter&) = delete;
+        server_adapter&
+        operator= (server_adapter&&) = delete;
+
+        ~server_adapter ()
+        {
+          if (previous_ != nullptr)
+            {
+              previous_->next_ = next_;
+            }
+          if (next_ != nullptr)
+            {
+              next_->previous_ = previous_;
+            }
+          else
+            {
+              last_ () = previous_;
+            }
+
+          // With nested lifetimes, the enclosing instance is restored.
+          if (instance_ () == static_cast<D*> (this))
+            {
+              server_adapter* a =
+                  (previous_ != nullptr) ? previous_ : last_ ();
+              instance_ () = static_cast<D*> (a);
+            }
+        }
+
+      public:
+
+        /**
+         * @brief Get the C API table, to be passed to `RTOS_Init()`
+         * or to a backend.
+         */
+        static const rtos_plugin_server_api_t*
+        api (void)
+        {
+          static const rtos_plugin_server_api_t table =
+            { free_, malloc_, realloc_, output_, output_debug_,
+                output_warning_, output_error_, read_byte_array_, read_byte_,
+                read_short_, read_long_, write_byte_array_, write_byte_,
+                write_short_, write_long_, load_short_, load_3bytes_,
+                load_long_ };
+
+          return &table;
+        }
+
+        /**
+         * @brief Make this instance the target of the C API table.
+         */
+        void
+        activate (void)
+        {
+          instance_ () = static_cast<D*> (this);
+        }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+        inline std::size_t
+        calls (server_function f) const
+        {
+          return stats_.calls[static_cast<std::size_t> (f)];
+        }
+
+        /**
+         * @brief Get the number of target memory accesses.
+         */
+        std::size_t
+        transactions (void) const
+        {
+          std::size_t count = 0;
+          for (int f = static_cast<int> (server_function::read_byte_array);
+              f <= static_cast<int> (server_function::write_long); ++f)
+            {
+              count += stats_.calls[f];
+            }
+          return count;
+        }
+
+        void
+        clear_stats (void)
+        {
+          stats_ = stats_t
+            { };
+        }
+
+      public:
+
+        // Defaults, possibly hidden by the derived class.
+
+        void*
+        malloc (std::size_t bytes)
+        {
+          return std::malloc (bytes);
+        }
+
+        void
+        free (void* p)
+        {
+          std::free (p);
+        }
+
+        void*
+        realloc (void* p, unsigned bytes)
+        {
+          return std::realloc (p, bytes);
+        }
+
+        void
+        voutput (server_function channel, const char* fmt, std::va_list args)
+        {
+          if (channel == server_function::output_warning)
+            {
+              printf ("WARNING: ");
+            }
+          else if (channel == server_function::output_error)
+            {
+              printf ("ERROR: ");
+            }
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+          vprintf (fmt, args);
+#pragma GCC diagnostic pop
+          printf ("\n");
+        }
+
+        int
+        read_byte (target_addr_t addr, uint8_t* out_value)
+        {
+          return derived_ ().read_byte_array (addr, out_value, 1);
+        }
+
+        int
+        read_short (target_addr_t addr, uint16_t* out_value)
+        {
+          uint8_t buf[2];
+          int ret = derived_ ().read_byte_array (addr, &buf[0], sizeof(buf));
+          if (ret >= 0)
+            {
+              *out_value = static_cast<uint16_t> (derived_ ().load_short (
+                  &buf[0]));
+            }
+          return ret;
+        }
+
+        int
+        read_long (target_addr_t addr, uint32_t* out_value)
+        {
+          uint8_t buf[4];
+          int ret = derived_ ().read_byte_array (addr, &buf[0], sizeof(buf));
+          if (ret >= 0)
+            {
+              *out_value = derived_ ().load_long (&buf[0]);
+            }
+          return ret;
+        }
+
+        void
+        write_byte (target_addr_t addr, uint8_t value)
+        {
+          derived_ ().write_byte_array (addr, &value, 1);
+        }
+
+        void
+        write_short (target_addr_t addr, uint16_t value)
+        {
+          uint8_t buf[2];
+          store_ (&buf[0], value, sizeof(buf));
+          derived_ ().write_byte_array (addr, &buf[0], sizeof(buf));
+        }
+
+        void
+        write_long (target_addr_t addr, uint32_t value)
+        {
+          uint8_t buf[4];
+          store_ (&buf[0], value, sizeof(buf));
+          derived_ ().write_byte_array (addr, &buf[0], sizeof(buf));
+        }
+
+        bool
+        is_little_endian (void) const
+        {
+          return true;
+        }
+
+        uint32_t
+        load_short (const uint8_t* p)
+        {
+          return load_ (p, 2);
+        }
+
+        uint32_t
+        load_3bytes (const uint8_t* p)
+        {
+          return load_ (p, 3);
+        }
+
+        uint32_t
+        load_long (const uint8_t* p)
+        {
+          return load_ (p, 4);
+        }
+
+      protected:
+
+        inline D&
+        derived_ (void)
+        {
+          return *static_cast<D*> (this);
+        }
+
+        uint32_t
+        load_ (const uint8_t* p, std::size_t bytes)
+        {
+          uint32_t value = 0;
+          if (derived_ ().is_little_endian ())
+            {
+              for (std::size_t i = bytes; i > 0; --i)
+                {
+                  value = (value << 8) | p[i - 1];
+                }
+            }
+          else
+            {
+              for (std::size_t i = 0; i < bytes; ++i)
+                {
+                  value = (value << 8) | p[i];
+                }
+            }
+          return value;
+        }
+
+        void
+        store_ (uint8_t* p, uint32_t value, std::size_t bytes)
+        {
+          for (std::size_t i = 0; i < bytes; ++i)
+            {
+              std::size_t k =
+                  derived_ ().is_little_endian () ? i : bytes - 1 - i;
+              p[k] = static_cast<uint8_t> (value);
+              value >>= 8;
+            }
+        }
+
+      private:
+
+        static D*&
+        instance_ (void)
+        {
+          static D* instance = nullptr;
+          return instance;
+        }
+
+        /**
+         * @brief The last constructed live instance, the tail of
+         *  the list.
+         */
+        static server_adapter*&
+        last_ (void)
+        {
+          static server_adapter* last = nullptr;
+          return last;
+        }
+
+        static D&
+        counted_ (server_function f)
+        {
+          D* d = instance_ ();
+          assert(d != nullptr);
+          ++d->stats_.calls[static_cast<std::size_t> (f)];
+          return *d;
+        }
+
+        // Trampolines, stored in the C API table.
+
+        static void
+        free_ (void* p)
+        {
+          counted_ (server_function::free).free (p);
+        }
+
+        static void*
+        malloc_ (size_t bytes)
+        {
+          return counted_ (server_function::malloc).malloc (bytes);
+        }
+
+        static void*
+        realloc_ (void* p, unsigned bytes)
+        {
+          return counted_ (server_function::realloc).realloc (p, bytes);
+        }
+
+        static void
+        output_ (const char* fmt, ...)
+        {
+          std::va_list args;
+          va_start(args, fmt);
+          counted_ (server_function::output).voutput (server_function::output,
+                                                      fmt, args);
+          va_end(args);
+        }
+
+        static void
+        output_debug_ (const char* fmt, ...)
+        {
+          std::va_list args;
+          va_start(args, fmt);
+          counted_ (server_function::output_debug).voutput (
+              server_function::output_debug, fmt, args);
+          va_end(args);
+        }
+
+        static void
+        output_warning_ (const char* fmt, ...)
+        {
+          std::va_list args;
+          va_start(args, fmt);
+          counted_ (server_function::output_warning).voutput (
+              server_function::output_warning, fmt, args);
+          va_end(args);
+        }
+
+        static void
+        output_error_ (const char* fmt, ...)
+        {
+          std::va_list args;
+          va_start(args, fmt);
+          counted_ (server_function::output_error).voutput (
+              server_function::output_error, fmt, args);
+          va_end(args);
+        }
+
+        static int
+        read_byte_array_ (target_addr_t addr, uint8_t* out_array,
+                          size_t bytes)
+        {
+          D& d = counted_ (server_function::read_byte_array);
+          d.stats_.bytes_read += bytes;
+          return d.read_byte_array (addr, out_array, bytes);
+        }
+
+        static int
+        read_byte_ (target_addr_t addr, uint8_t* out_value)
+        {
+          D& d = counted_ (server_function::read_byte);
+          d.stats_.bytes_read += 1;
+          return d.read_byte (addr, out_value);
+        }
+
+        static int
+        read_short_ (target_addr_t addr, uint16_t* out_value)
+        {
+          D& d = counted_ (server_function::read_short);
+          d.stats_.bytes_read += 2;
+          return d.read_short (addr, out_value);
+        }
+
+        static int
+        read_long_ (target_addr_t addr, uint32_t* out_value)
+        {
+          D& d = counted_ (server_function::read_long);
+          d.stats_.bytes_read += 4;
+          return d.read_long (addr, out_value);
+        }
+
+        static int
+        write_byte_array_ (target_addr_t addr, const uint8_t* array,
+                           size_t bytes)
+        {
+          D& d = counted_ (server_function::write_byte_array);
+          d.stats_.bytes_written += bytes;
+          return d.write_byte_array (addr, array, bytes);
+        }
+
+        static void
+        write_byte_ (target_addr_t addr, uint8_t value)
+        {
+          D& d = counted_ (server_function::write_byte);
+          d.stats_.bytes_written += 1;
+          d.write_byte (addr, value);
+        }
+
+        static void
+        write_short_ (target_addr_t addr, uint16_t value)
+        {
+          D& d = counted_ (server_function::write_short);
+          d.stats_.bytes_written += 2;
+          d.write_short (addr, value);
+        }
+
+        static void
+        write_long_ (target_addr_t addr, uint32_t value)
+        {
+          D& d = counted_ (server_function::write_long);
+          d.stats_.bytes_written += 4;
+          d.write_long (addr, value);
+        }
+
+        static uint32_t
+        load_short_ (const uint8_t* p)
+        {
+          return counted_ (server_function::load_short).load_short (p);
+        }
+
+        static uint32_t
+        load_3bytes_ (const uint8_t* p)
+        {
+          return counted_ (server_function::load_3bytes).load_3bytes (p);
+        }
+
+        static uint32_t
+        load_long_ (const uint8_t* p)
+        {
+          return counted_ (server_function::load_long).load_long (p);
+        }
+
+      private:
+
+        // Live instances, in construction order.
+        server_adapter* previous_;
+        server_adapter* next_;
+
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_SERVER_ADAPTER_H_ */
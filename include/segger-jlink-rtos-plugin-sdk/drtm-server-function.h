@@ -0,0 +1,112 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+#ifndef SEGGER_JLINK_SDK_DRTM_SERVER_FUNCTION_H_
+#define SEGGER_JLINK_SDK_DRTM_SERVER_FUNCTION_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <cstddef>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief The functions of the GDB server API, in table order.
+     */
+    enum class server_function
+      : int
+        {
+          free = 0, //
+          malloc, //
+          realloc, //
+          output, //
+          output_debug, //
+          output_warning, //
+          output_error, //
+          read_byte_array, //
+          read_byte, //
+          read_short, //
+          read_long, //
+          write_byte_array, //
+          write_byte, //
+          write_short, //
+          write_long, //
+          load_short, //
+          load_3bytes, //
+          load_long, //
+
+          count
+      };
+
+    /**
+     * @brief Get the name of a server API function.
+     */
+    inline const char*
+    server_function_name (server_function f)
+    {
+      static const char* const names[] =
+        { "free", "malloc", "realloc", "output", "output_debug",
+            "output_warning", "output_error", "read_byte_array", "read_byte",
+            "read_short", "read_long", "write_byte_array", "write_byte",
+            "write_short", "write_long", "load_short", "load_3bytes",
+            "load_long" };
+
+      static_assert(sizeof(names) / sizeof(names[0])
+          == static_cast<std::size_t>(server_function::count),
+          "names do not match server_function");
+
+      return names[static_cast<int> (f)];
+    }
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_SERVER_FUNCTION_H_ */
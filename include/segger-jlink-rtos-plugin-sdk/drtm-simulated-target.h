@@ -0,0 +1,348 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_SIMULATED_TARGET_H_
+#define SEGGER_JLINK_SDK_DRTM_SIMULATED_TARGET_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-adapter.h>
+
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A GDB server API implementation that serves target
+     * memory accesses from an in-process memory image.
+     *
+     * @details
+     * The image is a set of regions, filled programmatically or
+     * loaded from raw binary files. Each access is charged a fixed
+     * cost per transaction plus a cost per byte, to model the
+     * SWD/JTAG speed; the accumulated time is available via
+     * `simulated_ns()` and, in real time mode, is also spent
+     * busy waiting, so wall clock measurements include it.
+     *
+     * Together with the counters of `server_adapter`, this allows
+     * to benchmark `backend` based code on a host without a probe:
+     *
+     * @code{.cpp}
+     * segger::drtm::simulated_target target;
+     * target.add_region (0x20000000, 0x10000);
+     * backend_t backend { target.api (), symbols };
+     * @endcode
+     */
+    class simulated_target : public server_adapter<simulated_target>
+    {
+    public:
+
+      using target_addr_t = rtos_plugin_target_addr_t;
+
+    public:
+
+      simulated_target (bool little_endian = true) :
+          little_endian_ (little_endian), //
+          transaction_ns_ (0), //
+          byte_ns_ (0), //
+          realtime_ (false), //
+          simulated_ns_ (0)
+      {
+        ;
+      }
+
+      // The rule of five.
+      simulated_target (const simulated_target&) = delete;
+      simulated_target (simulated_target&&) = delete;
+      simulated_target&
+      operator= (const simulated_target&) = delete;
+      simulated_target&
+      operator= (simulated_target&&) = delete;
+
+      ~simulated_target () = default;
+
+    public:
+
+      /**
+       * @brief Add a zero filled memory region.
+       *
+       * @param [in] base Target address of the first byte.
+       * @param [in] size_bytes Region size.
+       *
+       * @return Pointer to the region content, valid until the next
+       *  region is added.
+       */
+      uint8_t*
+      add_region (target_addr_t base, std::size_t size_bytes)
+      {
+        regions_.push_back (region_t
+          { base, std::vector<uint8_t> (size_bytes) });
+        return regions_.back ().data.data ();
+      }
+
+      /**
+       * @brief Add a region with the content of a raw binary file.
+       *
+       * @retval 0 The file was loaded.
+       * @retval <0 The file could not be read.
+       */
+      int
+      load_file (target_addr_t base, const char* path)
+      {
+        FILE* f = fopen (path, "rb");
+        if (f == nullptr)
+          {
+            return -1;
+          }
+
+        std::vector<uint8_t> data;
+        uint8_t buf[4096];
+        std::size_t n;
+        while ((n = fread (buf, 1, sizeof(buf), f)) > 0)
+          {
+            data.insert (data.end (), buf, buf + n);
+          }
+        bool failed = ferror (f) != 0;
+        fclose (f);
+        if (failed)
+          {
+            return -1;
+          }
+
+        regions_.push_back (region_t
+          { base, std::move (data) });
+        return 0;
+      }
+
+      /**
+       * @brief Store bytes in the image, without charging any cost.
+       *
+       * @retval 0 Writing memory OK.
+       * @retval <0 The range is not inside a region.
+       */
+      int
+      poke (target_addr_t addr, const void* data, std::size_t bytes)
+      {
+        uint8_t* p = find_ (addr, bytes);
+        if (p == nullptr)
+          {
+            return -1;
+          }
+        std::memcpy (p, data, bytes);
+        return 0;
+      }
+
+      /**
+       * @brief Store a value in the image, with the target endianness.
+       */
+      int
+      poke_long (target_addr_t addr, uint32_t value)
+      {
+        uint8_t buf[4];
+        store_ (&buf[0], value, sizeof(buf));
+        return poke (addr, &buf[0], sizeof(buf));
+      }
+
+      int
+      poke_short (target_addr_t addr, uint16_t value)
+      {
+        uint8_t buf[2];
+        store_ (&buf[0], value, sizeof(buf));
+        return poke (addr, &buf[0], sizeof(buf));
+      }
+
+      /**
+       * @brief Get a pointer to the image, for direct inspection.
+       *
+       * @return Pointer to the bytes, or NULL if the range is not
+       *  inside a region.
+       */
+      uint8_t*
+      peek (target_addr_t addr, std::size_t bytes)
+      {
+        return find_ (addr, bytes);
+      }
+
+      /**
+       * @brief Set the cost of the target accesses.
+       *
+       * @param [in] transaction_ns Fixed cost of each access.
+       * @param [in] byte_ns Additional cost of each byte transferred.
+       */
+      void
+      set_latency (uint32_t transaction_ns, uint32_t byte_ns)
+      {
+        transaction_ns_ = transaction_ns;
+        byte_ns_ = byte_ns;
+      }
+
+      /**
+       * @brief Also spend the access costs in busy waits.
+       */
+      void
+      set_realtime (bool realtime)
+      {
+        realtime_ = realtime;
+      }
+
+      inline uint64_t
+      simulated_ns (void) const
+      {
+        return simulated_ns_;
+      }
+
+      void
+      clear_stats (void)
+      {
+        server_adapter<simulated_target>::clear_stats ();
+        simulated_ns_ = 0;
+      }
+
+      inline bool
+      is_little_endian (void) const
+      {
+        return little_endian_;
+      }
+
+    public:
+
+      // Server API.
+
+      int
+      read_byte_array (target_addr_t addr, uint8_t* out_array,
+                       std::size_t bytes)
+      {
+        charge_ (bytes);
+
+        const uint8_t* p = find_ (addr, bytes);
+        if (p == nullptr)
+          {
+            return -1;
+          }
+        std::memcpy (out_array, p, bytes);
+        return 0;
+      }
+
+      int
+      write_byte_array (target_addr_t addr, const uint8_t* array,
+                        std::size_t bytes)
+      {
+        charge_ (bytes);
+
+        uint8_t* p = find_ (addr, bytes);
+        if (p == nullptr)
+          {
+            return -1;
+          }
+        std::memcpy (p, array, bytes);
+        return 0;
+      }
+
+    private:
+
+      struct region_t
+      {
+        target_addr_t base;
+        std::vector<uint8_t> data;
+      };
+
+      uint8_t*
+      find_ (target_addr_t addr, std::size_t bytes)
+      {
+        for (region_t& r : regions_)
+          {
+            if (addr >= r.base && addr - r.base <= r.data.size ()
+                && bytes <= r.data.size () - (addr - r.base))
+              {
+                return r.data.data () + (addr - r.base);
+              }
+          }
+        return nullptr;
+      }
+
+      void
+      charge_ (std::size_t bytes)
+      {
+        uint64_t ns = transaction_ns_ + bytes * uint64_t (byte_ns_);
+        simulated_ns_ += ns;
+
+        if (realtime_ && ns != 0)
+          {
+            auto end = std::chrono::steady_clock::now ()
+                + std::chrono::nanoseconds (ns);
+            while (std::chrono::steady_clock::now () < end)
+              {
+                ;
+              }
+          }
+      }
+
+    private:
+
+      std::vector<region_t> regions_;
+
+      bool little_endian_;
+      uint32_t transaction_ns_;
+      uint32_t byte_ns_;
+      bool realtime_;
+      uint64_t simulated_ns_;
+    };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_SIMULATED_TARGET_H_ */
@@ -0,0 +1,495 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_SNAPSHOT_H_
+#define SEGGER_JLINK_SDK_DRTM_SNAPSHOT_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-struct.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Copy of a set of target objects, refreshed incrementally.
+     *
+     * @details
+     * Each update first reads, with one `read_batch()`, only the
+     * fingerprint of every object already known: a small region
+     * that changes whenever the object does, like the state, the
+     * stack pointer or a generation counter. Only objects that are
+     * new or whose fingerprint changed are then read whole, with
+     * a second `read_batch()`.
+     *
+     * Objects are identified by their target address, so the
+     * set may change between updates; the list of addresses
+     * usually comes from a walk of the RTOS thread list, or is
+     * reused while a list level change counter is unchanged.
+     *
+     * @tparam B Backend type.
+     * @tparam L Object layout, derived from `struct_layout`.
+     * @tparam K Fingerprint, a `byte_field` inside the object.
+     */
+    template<typename B, typename L, typename K>
+      class snapshot
+      {
+      public:
+
+        using backend_t = B;
+        using target_addr_t = typename B::target_addr_t;
+        using server_api_t = typename B::server_api_t;
+        using read_request_t = typename B::read_request_t;
+        using object_t = target_struct<L>;
+
+        static_assert(K::offset + K::width <= L::size_bytes,
+                      "fingerprint outside the object");
+
+        struct stats_t
+        {
+          std::size_t updates;
+          // Objects seen, over all updates.
+          std::size_t objects;
+          // Objects read whole, because new or changed.
+          std::size_t refetched;
+          std::size_t fingerprint_bytes;
+          std::size_t object_bytes;
+          // Bytes a full refresh would have read in addition.
+          std::size_t avoided_bytes;
+        };
+
+      public:
+
+        snapshot (B& backend) :
+            backend_ (backend), //
+            entries_
+              { nullptr, nullptr }, //
+            current_ (0), //
+            count_ (0), //
+            capacity_ (0), //
+            order_ (nullptr), //
+            requests_ (nullptr), //
+            stats_
+              { }
+        {
+          ;
+        }
+
+        // The rule of five.
+        snapshot (const snapshot&) = delete;
+        snapshot (snapshot&&) = delete;
+        snapshot&
+        operator= (const snapshot&) = delete;
+        snapshot&
+        operator= (snapshot&&) = delete;
+
+        ~snapshot ()
+        {
+          release_ ();
+        }
+
+      public:
+
+        /**
+         * @brief Refresh the snapshot for a new set of objects.
+         *
+         * @param [in] addrs Target addresses of the objects.
+         * @param [in] count Number of objects.
+         *
+         * @retval 0 Reading memory OK.
+         * @retval <0 Reading memory or allocating the arrays failed.
+         *  Objects that could not be read are marked not valid and
+         *  are read whole by the next update; the others are kept.
+         *  If the arrays could not be allocated, all objects are
+         *  forgotten.
+         */
+        int
+        update (const target_addr_t* addrs, std::size_t count)
+        {
+          if (count > capacity_ && grow_ (count) < 0)
+            {
+              invalidate ();
+              return -1;
+            }
+
+          entry_t* prev = entries_[current_];
+          entry_t* cur = entries_[1 - current_];
+          bool little_endian = backend_.is_target_little_endian ();
+
+          // Match the objects with the previous update and read
+          // the fingerprints of the known ones.
+          std::size_t n = 0;
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              entry_t& e = cur[i];
+              e.addr = addrs[i];
+              e.changed = true;
+              e.valid = true;
+
+              // Objects not read by the previous update are new.
+              std::size_t j = find_ (prev, addrs[i]);
+              if (j != count_ && prev[j].valid)
+                {
+                  e.object = prev[j].object;
+                  e.changed = false;
+                  requests_[n].addr = static_cast<target_addr_t> (addrs[i]
+                      + K::offset);
+                  requests_[n].bytes = K::width;
+                  requests_[n].out_array = &e.fingerprint[0];
+                  ++n;
+                }
+            }
+
+          int ret = backend_.read_batch (requests_, n);
+          stats_.fingerprint_bytes += n * K::width;
+
+          // Read whole the new and the changed objects.
+          std::size_t m = 0;
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              entry_t& e = cur[i];
+              if (!e.changed && ret >= 0
+                  && std::memcmp (&e.fingerprint[0],
+                                  e.object.data () + K::offset, K::width)
+                      == 0)
+                {
+                  continue;
+                }
+
+              e.changed = true;
+              e.object.set_little_endian (little_endian);
+              requests_[m].addr = e.addr;
+              requests_[m].bytes = L::size_bytes;
+              requests_[m].out_array = e.object.data ();
+              ++m;
+            }
+
+          ret = backend_.read_batch (requests_, m);
+          if (ret < 0)
+            {
+              // The batch does not tell which ranges failed; read
+              // the objects again, one by one, to keep the good ones.
+              for (std::size_t i = 0; i < count; ++i)
+                {
+                  entry_t& e = cur[i];
+                  if (e.changed
+                      && backend_.read_byte_array (e.addr, e.object.data (),
+                                                   L::size_bytes) < 0)
+                    {
+                      e.valid = false;
+                    }
+                }
+            }
+
+          ++stats_.updates;
+          stats_.objects += count;
+          stats_.refetched += m;
+          stats_.object_bytes += m * L::size_bytes;
+          std::size_t full_bytes = count * L::size_bytes;
+          std::size_t read_bytes = n * K::width + m * L::size_bytes;
+          if (full_bytes > read_bytes)
+            {
+              stats_.avoided_bytes += full_bytes - read_bytes;
+            }
+
+          current_ = 1 - current_;
+          count_ = count;
+          sort_order_ ();
+
+          return ret;
+        }
+
+        /**
+         * @brief Forget all objects, for example after the target
+         *  memory was written, so the next update reads them whole.
+         */
+        inline void
+        invalidate (void)
+        {
+          count_ = 0;
+        }
+
+        /**
+         * @brief Get the number of objects in the last update.
+         */
+        inline std::size_t
+        size (void) const
+        {
+          return count_;
+        }
+
+        inline const object_t&
+        object (std::size_t index) const
+        {
+          assert(index < count_);
+          return entries_[current_][index].object;
+        }
+
+        inline target_addr_t
+        address (std::size_t index) const
+        {
+          assert(index < count_);
+          return entries_[current_][index].addr;
+        }
+
+        /**
+         * @brief Check if the object was read successfully; if not,
+         *  its content is not defined.
+         */
+        inline bool
+        is_valid (std::size_t index) const
+        {
+          assert(index < count_);
+          return entries_[current_][index].valid;
+        }
+
+        /**
+         * @brief Check if the object was read whole in the last update,
+         *  so any data derived from it must be refreshed too.
+         */
+        inline bool
+        is_changed (std::size_t index) const
+        {
+          assert(index < count_);
+          return entries_[current_][index].changed;
+        }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+        inline void
+        clear_stats (void)
+        {
+          stats_ = stats_t
+            { };
+        }
+
+      private:
+
+        struct entry_t
+        {
+          object_t object;
+          target_addr_t addr;
+          bool changed;
+          bool valid;
+          uint8_t fingerprint[K::width];
+        };
+
+        /**
+         * @brief Binary search in the previous objects, sorted
+         *  by address.
+         *
+         * @return The index, or `count_` if not found.
+         */
+        std::size_t
+        find_ (const entry_t* prev, target_addr_t addr) const
+        {
+          std::size_t lo = 0;
+          std::size_t hi = count_;
+          while (lo < hi)
+            {
+              std::size_t mid = lo + (hi - lo) / 2;
+              if (prev[order_[mid]].addr < addr)
+                {
+                  lo = mid + 1;
+                }
+              else
+                {
+                  hi = mid;
+                }
+            }
+          if (lo < count_ && prev[order_[lo]].addr == addr)
+            {
+              return order_[lo];
+            }
+          return count_;
+        }
+
+        void
+        sort_order_ (void)
+        {
+          const entry_t* cur = entries_[current_];
+          for (std::size_t i = 0; i < count_; ++i)
+            {
+              order_[i] = i;
+            }
+          std::sort (order_, order_ + count_, [cur](std::size_t a,
+              std::size_t b)
+            {
+              return cur[a].addr < cur[b].addr;
+            });
+        }
+
+        /**
+         * @brief Reallocate the arrays, keeping the current objects.
+         */
+        int
+        grow_ (std::size_t count)
+        {
+          std::size_t capacity = (capacity_ != 0) ? capacity_ : 16;
+          while (capacity < count)
+            {
+              capacity *= 2;
+            }
+
+          const server_api_t* api = backend_.get_api ();
+          allocator<entry_t, server_api_t> entries_allocator
+            { api };
+          allocator<std::size_t, server_api_t> order_allocator
+            { api };
+          allocator<read_request_t, server_api_t> requests_allocator
+            { api };
+
+          entry_t* e0 = entries_allocator.allocate (capacity);
+          entry_t* e1 = entries_allocator.allocate (capacity);
+          std::size_t* order = order_allocator.allocate (capacity);
+          read_request_t* requests = requests_allocator.allocate (capacity);
+          if (e0 == nullptr || e1 == nullptr || order == nullptr
+              || requests == nullptr)
+            {
+              if (e0 != nullptr)
+                {
+                  entries_allocator.deallocate (e0, capacity);
+                }
+              if (e1 != nullptr)
+                {
+                  entries_allocator.deallocate (e1, capacity);
+                }
+              if (order != nullptr)
+                {
+                  order_allocator.deallocate (order, capacity);
+                }
+              if (requests != nullptr)
+                {
+                  requests_allocator.deallocate (requests, capacity);
+                }
+              return -1;
+            }
+
+          if (count_ != 0)
+            {
+              std::memcpy (e0, entries_[current_], count_ * sizeof(entry_t));
+              std::memcpy (order, order_, count_ * sizeof(std::size_t));
+            }
+
+          release_ ();
+
+          entries_[0] = e0;
+          entries_[1] = e1;
+          current_ = 0;
+          order_ = order;
+          requests_ = requests;
+          capacity_ = capacity;
+          return 0;
+        }
+
+        void
+        release_ (void)
+        {
+          if (capacity_ == 0)
+            {
+              return;
+            }
+
+          const server_api_t* api = backend_.get_api ();
+          allocator<entry_t, server_api_t> entries_allocator
+            { api };
+          allocator<std::size_t, server_api_t> order_allocator
+            { api };
+          allocator<read_request_t, server_api_t> requests_allocator
+            { api };
+
+          entries_allocator.deallocate (entries_[0], capacity_);
+          entries_allocator.deallocate (entries_[1], capacity_);
+          order_allocator.deallocate (order_, capacity_);
+          requests_allocator.deallocate (requests_, capacity_);
+
+          entries_[0] = nullptr;
+          entries_[1] = nullptr;
+          order_ = nullptr;
+          requests_ = nullptr;
+          capacity_ = 0;
+        }
+
+      private:
+
+        B& backend_;
+
+        // The current and the previous objects, swapped at each update.
+        entry_t* entries_[2];
+        std::size_t current_;
+        std::size_t count_;
+        std::size_t capacity_;
+
+        // Indices of the current objects, sorted by address.
+        std::size_t* order_;
+        read_request_t* requests_;
+
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_SNAPSHOT_H_ */
@@ -0,0 +1,584 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+#ifndef SEGGER_JLINK_SDK_DRTM_STACK_SCANNER_H_
+#define SEGGER_JLINK_SDK_DRTM_STACK_SCANNER_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-thread-map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Find the first 32-bits word that differs from `fill`.
+     *
+     * @details
+     * With AVX2 or SSE2, 32 or 16 bytes are compared at once.
+     *
+     * @param [in] p Bytes to scan.
+     * @param [in] bytes Number of bytes; a multiple of 4.
+     * @param [in] fill The fill word, as stored in memory.
+     *
+     * @return The offset of the first different word, or `bytes`
+     *  if all words are equal to `fill`.
+     */
+    inline std::size_t
+    find_not_fill (const uint8_t* p, std::size_t bytes, uint32_t fill)
+    {
+      std::size_t i = 0;
+
+#if defined(__AVX2__)
+      const __m256i fill32 = _mm256_set1_epi32 (static_cast<int> (fill));
+      for (; i + 32 <= bytes; i += 32)
+        {
+          __m256i v = _mm256_loadu_si256 (
+              reinterpret_cast<const __m256i*> (p + i));
+          uint32_t mask = static_cast<uint32_t> (_mm256_movemask_epi8 (
+              _mm256_cmpeq_epi32 (v, fill32)));
+          if (mask != 0xFFFFFFFFu)
+            {
+              return i + (static_cast<unsigned> (__builtin_ctz (~mask)) & ~3u);
+            }
+        }
+#endif /* defined(__AVX2__) */
+
+#if defined(__SSE2__)
+      const __m128i fill16 = _mm_set1_epi32 (static_cast<int> (fill));
+      for (; i + 16 <= bytes; i += 16)
+        {
+          __m128i v = _mm_loadu_si128 (
+              reinterpret_cast<const __m128i*> (p + i));
+          uint32_t mask = static_cast<uint32_t> (_mm_movemask_epi8 (
+              _mm_cmpeq_epi32 (v, fill16)));
+          if (mask != 0xFFFFu)
+            {
+              return i + (static_cast<unsigned> (__builtin_ctz (~mask)) & ~3u);
+            }
+        }
+#endif /* defined(__SSE2__) */
+
+      for (; i + 4 <= bytes; i += 4)
+        {
+          uint32_t w;
+          std::memcpy (&w, p + i, sizeof(w));
+          if (w != fill)
+            {
+              return i;
+            }
+        }
+      return bytes;
+    }
+
+    /**
+     * @brief How `stack_scanner` searches the fill boundary.
+     */
+    enum class stack_scan_mode
+    {
+      // Read the stack in chunks, from the bottom up.
+      linear, //
+      // Sample small windows by binary search, then scan the
+      // last interval linearly.
+      bisect
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Find the stack high-water mark of the threads, from
+     * the fill pattern the RTOS writes in the stacks.
+     *
+     * @details
+     * Stacks are assumed to grow down, so the used part is above
+     * the first word, from the bottom, that differs from the fill
+     * word. Instead of one `read_long()` per word, the stack is read
+     * in large chunks with `read_byte_array()` and the chunks are
+     * scanned with SIMD compares.
+     *
+     * In `stack_scan_mode::bisect` mode, small windows are sampled
+     * by binary search until the interval holding the boundary is
+     * at most one chunk, which is then scanned. This assumes the
+     * words below the boundary were never written, which usually
+     * holds, but a large local array not fully written may make
+     * the result too small.
+     *
+     * In `stack_scan_mode::linear` mode the results are exact and
+     * are not cached: a scan from the bottom up stops at the mark,
+     * so it reads nothing above it, and checking a cached mark
+     * exactly would read the same words again.
+     *
+     * In `stack_scan_mode::bisect` mode the results are cached per
+     * thread across halts. With the same assumption as above, a
+     * thread whose stack did not reach below the previous mark is
+     * confirmed by reading one window just below the mark;
+     * otherwise the stack is scanned down from the previous mark,
+     * until a chunk of fill is found:
+     *
+     * @code{.cpp}
+     * // RTOS_GetThreadDisplay()
+     * std::size_t used_bytes;
+     * if (scanner.high_water_mark (id, stack_base, stack_size, sp,
+     *                              &used_bytes) == 0)
+     *   { ... }
+     * @endcode
+     *
+     * @tparam B Backend type.
+     */
+    template<typename B>
+      class stack_scanner
+      {
+      public:
+
+        using backend_t = B;
+        using server_api_t = typename B::server_api_t;
+        using target_addr_t = rtos_plugin_target_addr_t;
+        using thread_id_t = rtos_plugin_thread_id_t;
+
+        constexpr static std::size_t default_chunk_size_bytes = 1024;
+        // Bytes read at each binary search step and to confirm
+        // a cached mark.
+        constexpr static std::size_t window_size_bytes = 32;
+
+        struct stats_t
+        {
+          // Scans of whole stacks.
+          std::size_t scans;
+          // Cached marks confirmed by reading one window.
+          std::size_t cache_hits;
+          // Scans of the part below a cached mark.
+          std::size_t partial_scans;
+          std::size_t reads;
+          std::size_t bytes_read;
+        };
+
+      public:
+
+        /**
+         * @param [in] backend The backend used to read the stacks.
+         * @param [in] fill The fill word, as a target value.
+         * @param [in] little_endian Target byte order.
+         * @param [in] chunk_size_bytes Size of the reads.
+         */
+        stack_scanner (backend_t& backend, uint32_t fill,
+                       bool little_endian = true,
+                       std::size_t chunk_size_bytes =
+                           default_chunk_size_bytes) :
+            backend_ (backend), //
+            chunk_size_bytes_ (
+                (chunk_size_bytes > window_size_bytes) ?
+                    (chunk_size_bytes & ~std::size_t (3)) :
+                    window_size_bytes), //
+            mode_ (stack_scan_mode::linear), //
+            fill_ (0), //
+            map_ (allocator<thread_map_slot, server_api_t>
+              { backend.get_api () }), //
+            entries_ (backend.get_api (), 16), //
+            chunk_ (backend.get_api (), chunk_size_bytes_), //
+            stats_
+              { }
+        {
+#if defined(DEBUG)
+          printf ("%s(%p, 0x%08X) @%p\n", __func__, &backend, fill, this);
+#endif /* defined(DEBUG) */
+
+          // Keep the fill word as stored in target memory, to compare
+          // it with the raw bytes.
+          uint8_t bytes[4];
+          for (std::size_t i = 0; i < 4; ++i)
+            {
+              bytes[little_endian ? i : 3 - i] =
+                  static_cast<uint8_t> (fill >> (8 * i));
+            }
+          std::memcpy (&fill_, &bytes[0], sizeof(fill_));
+        }
+
+        // The rule of five.
+        stack_scanner (const stack_scanner&) = delete;
+        stack_scanner (stack_scanner&&) = delete;
+        stack_scanner&
+        operator= (const stack_scanner&) = delete;
+        stack_scanner&
+        operator= (stack_scanner&&) = delete;
+
+        ~stack_scanner () = default;
+
+      public:
+
+        /**
+         * @brief Set the search mode; changing it drops the
+         *  cached marks.
+         */
+        inline void
+        set_mode (stack_scan_mode mode)
+        {
+          if (mode != mode_)
+            {
+              invalidate ();
+            }
+          mode_ = mode;
+        }
+
+        inline stack_scan_mode
+        mode (void) const
+        {
+          return mode_;
+        }
+
+        /**
+         * @brief Drop all cached marks, for example when the
+         *  target was reset.
+         */
+        void
+        invalidate (void)
+        {
+          map_.clear ();
+          entries_.clear ();
+        }
+
+        /**
+         * @brief Get the maximum stack usage of a thread; in
+         *  `stack_scan_mode::bisect` mode, reusing the previous
+         *  result if the stack did not grow.
+         *
+         * @param [in] id Thread ID.
+         * @param [in] base Lowest address of the stack.
+         * @param [in] size_bytes Stack size.
+         * @param [in] sp Current stack pointer, or 0 if not known.
+         * @param [out] out_used_bytes Bytes above the fill.
+         *
+         * @retval 0 OK.
+         * @retval <0 Reading the stack failed.
+         */
+        int
+        high_water_mark (thread_id_t id, target_addr_t base,
+                         std::size_t size_bytes, target_addr_t sp,
+                         std::size_t* out_used_bytes)
+        {
+          if (mode_ == stack_scan_mode::linear)
+            {
+              return scan (base, size_bytes, out_used_bytes);
+            }
+
+          target_addr_t lo;
+          target_addr_t hi;
+          bounds_ (base, size_bytes, &lo, &hi);
+
+          std::size_t index = map_.find (id);
+          if (index != map_t::npos && entries_[index].base == base
+              && entries_[index].size_bytes == size_bytes)
+            {
+              entry_t& entry = entries_[index];
+              if (entry.mark == lo
+                  || ((sp == 0 || sp >= entry.mark)
+                      && is_fill_below_ (lo, entry.mark)))
+                {
+                  ++stats_.cache_hits;
+                  *out_used_bytes = hi - entry.mark;
+                  return 0;
+                }
+
+              // The part above the mark was already scanned.
+              ++stats_.partial_scans;
+              target_addr_t mark;
+              if (find_mark_down_ (lo, entry.mark, &mark) < 0)
+                {
+                  return -1;
+                }
+              entry.mark = mark;
+              *out_used_bytes = hi - mark;
+              return 0;
+            }
+
+          ++stats_.scans;
+          target_addr_t mark;
+          if (find_mark_ (lo, hi, &mark) < 0)
+            {
+              return -1;
+            }
+          *out_used_bytes = hi - mark;
+
+          // Without memory the result is simply not cached.
+          if (index != map_t::npos)
+            {
+              entries_[index] =
+                { base, size_bytes, mark };
+            }
+          else if (entries_.push_back (entry_t
+            { base, size_bytes, mark }) == 0)
+            {
+              if (map_.insert (id, entries_.size () - 1) < 0)
+                {
+                  entries_.resize (entries_.size () - 1);
+                }
+            }
+          return 0;
+        }
+
+        /**
+         * @brief Get the maximum stack usage, without caching.
+         *
+         * @retval 0 OK.
+         * @retval <0 Reading the stack failed.
+         */
+        int
+        scan (target_addr_t base, std::size_t size_bytes,
+              std::size_t* out_used_bytes)
+        {
+          target_addr_t lo;
+          target_addr_t hi;
+          bounds_ (base, size_bytes, &lo, &hi);
+
+          ++stats_.scans;
+          target_addr_t mark;
+          if (find_mark_ (lo, hi, &mark) < 0)
+            {
+              return -1;
+            }
+          *out_used_bytes = hi - mark;
+          return 0;
+        }
+
+        inline const stats_t&
+        stats (void) const
+        {
+          return stats_;
+        }
+
+      private:
+
+        struct entry_t
+        {
+          target_addr_t base;
+          std::size_t size_bytes;
+          // Address of the first word above the fill.
+          target_addr_t mark;
+        };
+
+        using map_t = thread_map<allocator<thread_map_slot, server_api_t>>;
+
+        /**
+         * @brief Align the stack limits to words.
+         */
+        static void
+        bounds_ (target_addr_t base, std::size_t size_bytes,
+                 target_addr_t* out_lo, target_addr_t* out_hi)
+        {
+          target_addr_t end = static_cast<target_addr_t> (base + size_bytes);
+          *out_lo = (base + 3) & ~target_addr_t (3);
+          *out_hi = end & ~target_addr_t (3);
+          if (*out_hi < *out_lo)
+            {
+              *out_hi = *out_lo;
+            }
+        }
+
+        int
+        read_ (target_addr_t addr, uint8_t* out_array, std::size_t bytes)
+        {
+          ++stats_.reads;
+          stats_.bytes_read += bytes;
+          return backend_.read_byte_array (addr, out_array, bytes);
+        }
+
+        /**
+         * @brief Check if the window just below `mark` is still
+         *  all fill.
+         */
+        bool
+        is_fill_below_ (target_addr_t lo, target_addr_t mark)
+        {
+          uint8_t window[window_size_bytes];
+          std::size_t bytes = mark - lo;
+          if (bytes > window_size_bytes)
+            {
+              bytes = window_size_bytes;
+            }
+          if (read_ (static_cast<target_addr_t> (mark - bytes), &window[0],
+                     bytes) < 0)
+            {
+              return false;
+            }
+          return find_not_fill (&window[0], bytes, fill_) == bytes;
+        }
+
+        /**
+         * @brief Find the first word in [lo, hi) that is not fill,
+         *  or `hi` if there is none.
+         */
+        int
+        find_mark_ (target_addr_t lo, target_addr_t hi,
+                    target_addr_t* out_mark)
+        {
+          if (mode_ == stack_scan_mode::bisect)
+            {
+              uint8_t window[window_size_bytes];
+              while (hi - lo > chunk_size_bytes_)
+                {
+                  target_addr_t mid = lo
+                      + (((hi - lo) / 2) & ~target_addr_t (3));
+                  std::size_t bytes = hi - mid;
+                  if (bytes > window_size_bytes)
+                    {
+                      bytes = window_size_bytes;
+                    }
+                  if (read_ (mid, &window[0], bytes) < 0)
+                    {
+                      return -1;
+                    }
+                  std::size_t offset = find_not_fill (&window[0], bytes,
+                                                      fill_);
+                  if (offset == bytes)
+                    {
+                      lo = static_cast<target_addr_t> (mid + bytes);
+                    }
+                  else
+                    {
+                      hi = static_cast<target_addr_t> (mid + offset);
+                    }
+                }
+            }
+
+          if (chunk_.resize (chunk_size_bytes_) < 0)
+            {
+              return -1;
+            }
+
+          for (target_addr_t addr = lo; addr < hi;)
+            {
+              std::size_t bytes = std::min (std::size_t (hi - addr),
+                                            chunk_size_bytes_);
+              if (read_ (addr, chunk_.data (), bytes) < 0)
+                {
+                  return -1;
+                }
+              std::size_t offset = find_not_fill (chunk_.data (), bytes,
+                                                  fill_);
+              if (offset != bytes)
+                {
+                  *out_mark = static_cast<target_addr_t> (addr + offset);
+                  return 0;
+                }
+              addr = static_cast<target_addr_t> (addr + bytes);
+            }
+
+          *out_mark = hi;
+          return 0;
+        }
+
+        /**
+         * @brief Scan down from `mark`, while the chunks are not
+         *  all fill, and get the lowest word that is not fill.
+         */
+        int
+        find_mark_down_ (target_addr_t lo, target_addr_t mark,
+                         target_addr_t* out_mark)
+        {
+          if (chunk_.resize (chunk_size_bytes_) < 0)
+            {
+              return -1;
+            }
+
+          *out_mark = mark;
+          for (target_addr_t addr = mark; addr > lo;)
+            {
+              std::size_t bytes = std::min (std::size_t (addr - lo),
+                                            chunk_size_bytes_);
+              addr = static_cast<target_addr_t> (addr - bytes);
+              if (read_ (addr, chunk_.data (), bytes) < 0)
+                {
+                  return -1;
+                }
+              std::size_t offset = find_not_fill (chunk_.data (), bytes,
+                                                  fill_);
+              if (offset == bytes)
+                {
+                  break;
+                }
+              *out_mark = static_cast<target_addr_t> (addr + offset);
+            }
+          return 0;
+        }
+
+      private:
+
+        backend_t& backend_;
+        std::size_t chunk_size_bytes_;
+        stack_scan_mode mode_;
+        uint32_t fill_;
+
+        // Cached marks, in a dense array indexed via the map.
+        map_t map_;
+        pod_buffer<entry_t, server_api_t> entries_;
+
+        pod_buffer<uint8_t, server_api_t> chunk_;
+
+        stats_t stats_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_STACK_SCANNER_H_ */
@@ -0,0 +1,222 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_STRUCT_H_
+#define SEGGER_JLINK_SDK_DRTM_STRUCT_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Descriptor of a field of a target structure.
+     *
+     * @tparam V Integral type of the field, 1, 2, 4 or 8 bytes wide.
+     * @tparam O Offset of the field, in bytes, from the beginning
+     *  of the structure.
+     */
+    template<typename V, std::size_t O>
+      struct field
+      {
+        static_assert(std::is_integral<V>::value, "field must be integral");
+        static_assert(sizeof(V) == 1 || sizeof(V) == 2 || sizeof(V) == 4
+                          || sizeof(V) == 8,
+                      "unsupported field width");
+
+        using value_type = V;
+
+        constexpr static std::size_t offset = O;
+        constexpr static std::size_t width = sizeof(V);
+      };
+
+    /**
+     * @brief Array of bytes inside a target structure, like a name
+     * stored in place.
+     */
+    template<std::size_t O, std::size_t N>
+      struct byte_field
+      {
+        using value_type = const uint8_t*;
+
+        constexpr static std::size_t offset = O;
+        constexpr static std::size_t width = N;
+      };
+
+    /**
+     * @brief Compile time layout of a target structure.
+     *
+     * @details
+     * Plug-ins describe each RTOS structure once, for example:
+     *
+     * @code{.cpp}
+     * struct tcb : struct_layout<64>
+     * {
+     *   using next = field<uint32_t, 0>;
+     *   using sp = field<uint32_t, 8>;
+     *   using state = field<uint8_t, 12>;
+     * };
+     * @endcode
+     *
+     * @tparam S Size of the structure in bytes, or of the leading
+     *  part of it that is of interest.
+     */
+    template<std::size_t S>
+      struct struct_layout
+      {
+        static_assert(S != 0, "empty structure");
+
+        constexpr static std::size_t size_bytes = S;
+      };
+
+    /**
+     * @brief Local copy of a target structure, fetched with a single
+     * `backend::read_struct()` and decoded field by field, with all
+     * offsets and widths resolved at compile time.
+     *
+     * @tparam L Layout, derived from `struct_layout`.
+     */
+    template<typename L>
+      class target_struct
+      {
+      public:
+
+        using layout_t = L;
+
+        constexpr static std::size_t size_bytes = L::size_bytes;
+
+      public:
+
+        target_struct () = default;
+
+        // The rule of five.
+        target_struct (const target_struct&) = default;
+        target_struct (target_struct&&) = default;
+        target_struct&
+        operator= (const target_struct&) = default;
+        target_struct&
+        operator= (target_struct&&) = default;
+
+        ~target_struct () = default;
+
+      public:
+
+        /**
+         * @brief Decode an integral field with the target byte order.
+         */
+        template<typename F>
+          inline typename F::value_type
+          get (void) const
+          {
+            static_assert(F::offset + F::width <= size_bytes,
+                          "field outside the structure");
+
+            using value_type = typename F::value_type;
+            using unsigned_type = typename std::make_unsigned<value_type>::type;
+
+            const uint8_t* p = &bytes_[F::offset];
+            unsigned_type v;
+            if (little_endian_)
+              {
+                v = little_endian_codec::load<unsigned_type> (p);
+              }
+            else
+              {
+                v = big_endian_codec::load<unsigned_type> (p);
+              }
+            return static_cast<value_type> (v);
+          }
+
+        /**
+         * @brief Get a pointer to the bytes of an in place array.
+         */
+        template<typename F>
+          inline const uint8_t*
+          bytes (void) const
+          {
+            static_assert(F::offset + F::width <= size_bytes,
+                          "field outside the structure");
+
+            return &bytes_[F::offset];
+          }
+
+        inline uint8_t*
+        data (void)
+        {
+          return &bytes_[0];
+        }
+
+        inline const uint8_t*
+        data (void) const
+        {
+          return &bytes_[0];
+        }
+
+        inline void
+        set_little_endian (bool little_endian)
+        {
+          little_endian_ = little_endian;
+        }
+
+      private:
+
+        uint8_t bytes_[size_bytes];
+        bool little_endian_ = true;
+      };
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_STRUCT_H_ */
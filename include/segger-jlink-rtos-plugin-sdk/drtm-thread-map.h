@@ -0,0 +1,372 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_THREAD_MAP_H_
+#define SEGGER_JLINK_SDK_DRTM_THREAD_MAP_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Slot of a `thread_map` table.
+     */
+    struct thread_map_slot
+    {
+      rtos_plugin_thread_id_t id;
+      // Valid only if equal to the map generation.
+      uint32_t generation;
+      uint32_t index;
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Open addressing map of thread IDs to dense indices.
+     *
+     * @details
+     * The C API identifies threads by ID (`RTOS_GetThreadDisplay()`,
+     * `RTOS_GetThreadReg()`, ...) while `RTOS_GetThreadId()` works
+     * by position; the map avoids searching the thread array at
+     * each call:
+     *
+     * @code{.cpp}
+     * // RTOS_UpdateThreads()
+     * map.rebuild (ids, count);
+     *
+     * // RTOS_GetThreadDisplay()
+     * std::size_t i = map.find (thread_id);
+     * @endcode
+     *
+     * The table uses linear probing with a load factor below 1/2
+     * and is cleared in O(1) by incrementing a generation, so
+     * rebuilding it at each update costs only the insertions.
+     *
+     * @tparam A Allocator of `thread_map_slot`, like
+     *  `allocator<thread_map_slot, server_api_t>` or
+     *  `arena_allocator<thread_map_slot, server_api_t>`.
+     */
+    template<typename A>
+      class thread_map
+      {
+      public:
+
+        using allocator_type = A;
+        using thread_id_t = rtos_plugin_thread_id_t;
+        using slot_t = thread_map_slot;
+
+        static_assert(std::is_same<typename A::value_type, slot_t>::value,
+                      "the allocator must allocate thread_map_slot");
+
+        constexpr static std::size_t npos = static_cast<std::size_t> (-1);
+
+      public:
+
+        thread_map (const allocator_type& allocator) :
+            allocator_ (allocator), //
+            slots_ (nullptr), //
+            slots_count_ (0), //
+            used_ (0), //
+            generation_ (1), //
+            shift_ (32)
+        {
+          ;
+        }
+
+        // The rule of five.
+        thread_map (const thread_map&) = delete;
+        thread_map (thread_map&&) = delete;
+        thread_map&
+        operator= (const thread_map&) = delete;
+        thread_map&
+        operator= (thread_map&&) = delete;
+
+        ~thread_map ()
+        {
+          if (slots_ != nullptr)
+            {
+              allocator_.deallocate (slots_, slots_count_);
+            }
+        }
+
+      public:
+
+        /**
+         * @brief Remove all entries, in O(1).
+         */
+        void
+        clear (void)
+        {
+          used_ = 0;
+          if (++generation_ == 0)
+            {
+              // On wrap around, old slots might match again.
+              for (std::size_t i = 0; i < slots_count_; ++i)
+                {
+                  slots_[i].generation = 0;
+                }
+              generation_ = 1;
+            }
+        }
+
+        /**
+         * @brief Make room for a number of entries.
+         *
+         * @retval 0 OK.
+         * @retval <0 Allocating the table failed.
+         */
+        int
+        reserve (std::size_t count)
+        {
+          if (2 * count <= slots_count_)
+            {
+              return 0;
+            }
+
+          std::size_t slots_count = (slots_count_ != 0) ? slots_count_ : 32;
+          while (slots_count < 2 * count)
+            {
+              slots_count *= 2;
+            }
+          return rehash_ (slots_count);
+        }
+
+        /**
+         * @brief Map a thread ID to an index, replacing any previous
+         *  index.
+         *
+         * @retval 0 OK.
+         * @retval <0 Growing the table failed.
+         */
+        int
+        insert (thread_id_t id, std::size_t index)
+        {
+          if (reserve (used_ + 1) < 0)
+            {
+              return -1;
+            }
+
+          std::size_t mask = slots_count_ - 1;
+          for (std::size_t i = hash_ (id, shift_);; i = (i + 1) & mask)
+            {
+              slot_t& slot = slots_[i];
+              if (slot.generation != generation_)
+                {
+                  slot.id = id;
+                  slot.generation = generation_;
+                  ++used_;
+                }
+              else if (slot.id != id)
+                {
+                  continue;
+                }
+              slot.index = static_cast<uint32_t> (index);
+              return 0;
+            }
+        }
+
+        /**
+         * @brief Clear the map and map each ID to its position
+         *  in an array.
+         *
+         * @retval 0 OK.
+         * @retval <0 Allocating the table failed.
+         */
+        int
+        rebuild (const thread_id_t* ids, std::size_t count)
+        {
+          clear ();
+          if (reserve (count) < 0)
+            {
+              return -1;
+            }
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              insert (ids[i], i);
+            }
+          return 0;
+        }
+
+        /**
+         * @brief Get the index of a thread.
+         *
+         * @return The index, or `npos` if the ID is not in the map.
+         */
+        std::size_t
+        find (thread_id_t id) const
+        {
+          if (slots_count_ == 0)
+            {
+              return npos;
+            }
+          std::size_t mask = slots_count_ - 1;
+          for (std::size_t i = hash_ (id, shift_);; i = (i + 1) & mask)
+            {
+              const slot_t& slot = slots_[i];
+              if (slot.generation != generation_)
+                {
+                  return npos;
+                }
+              if (slot.id == id)
+                {
+                  return slot.index;
+                }
+            }
+        }
+
+        inline bool
+        contains (thread_id_t id) const
+        {
+          return find (id) != npos;
+        }
+
+        inline std::size_t
+        size (void) const
+        {
+          return used_;
+        }
+
+      private:
+
+        /**
+         * @brief Fibonacci hashing: keep the high bits of the
+         *  product, which depend on all bits of the ID.
+         *
+         * @details
+         * Thread IDs are usually aligned addresses, so their low
+         * bits are zero; masking the low bits of the product would
+         * put all the IDs with a large stride in a few slots.
+         */
+        static inline std::size_t
+        hash_ (thread_id_t id, unsigned shift)
+        {
+          return static_cast<std::size_t> (
+              static_cast<uint32_t> (static_cast<uint32_t> (id) * 2654435761u)
+                  >> shift);
+        }
+
+        /**
+         * @brief Get `32 - log2 (slots_count)`, for `hash_()`.
+         */
+        static inline unsigned
+        shift_for_ (std::size_t slots_count)
+        {
+          unsigned shift = 32;
+          for (std::size_t n = slots_count; n > 1; n >>= 1)
+            {
+              --shift;
+            }
+          return shift;
+        }
+
+        int
+        rehash_ (std::size_t slots_count)
+        {
+          slot_t* slots = allocator_.allocate (slots_count);
+          if (slots == nullptr)
+            {
+              return -1;
+            }
+          for (std::size_t i = 0; i < slots_count; ++i)
+            {
+              slots[i].generation = 0;
+            }
+
+          unsigned shift = shift_for_ (slots_count);
+          std::size_t mask = slots_count - 1;
+          for (std::size_t k = 0; k < slots_count_; ++k)
+            {
+              const slot_t& slot = slots_[k];
+              if (slot.generation != generation_)
+                {
+                  continue;
+                }
+              std::size_t i = hash_ (slot.id, shift);
+              while (slots[i].generation == generation_)
+                {
+                  i = (i + 1) & mask;
+                }
+              slots[i] = slot;
+            }
+
+          if (slots_ != nullptr)
+            {
+              allocator_.deallocate (slots_, slots_count_);
+            }
+          slots_ = slots;
+          slots_count_ = slots_count;
+          shift_ = shift;
+          return 0;
+        }
+
+      private:
+
+        allocator_type allocator_;
+
+        slot_t* slots_;
+        std::size_t slots_count_;
+        std::size_t used_;
+        uint32_t generation_;
+        unsigned shift_;
+      };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_THREAD_MAP_H_ */
@@ -0,0 +1,892 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_DRTM_TRACE_H_
+#define SEGGER_JLINK_SDK_DRTM_TRACE_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-adapter.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+
+#include <cstring>
+#include <cstdarg>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Layout of the binary memory traffic traces.
+     *
+     * @details
+     * A trace starts with an 8 bytes magic, followed by a flags
+     * byte (bit 0 set for little endian targets) and 3 reserved
+     * bytes. Each record has a 14 bytes header, all fields little
+     * endian, followed by `length` bytes of data, in target memory
+     * order: the bytes read (if the read succeeded) or written.
+     */
+    struct trace_format
+    {
+      constexpr static std::size_t magic_size_bytes = 8;
+      constexpr static std::size_t header_size_bytes = 12;
+
+      constexpr static std::size_t kind_offset = 0; // server_function
+      constexpr static std::size_t failed_offset = 1; // 1 if < 0 returned
+      constexpr static std::size_t addr_offset = 2;
+      constexpr static std::size_t length_offset = 6;
+      constexpr static std::size_t duration_offset = 10; // ns, saturated
+      constexpr static std::size_t record_size_bytes = 14;
+
+      constexpr static uint8_t flag_little_endian = 0x01;
+
+      static inline const char*
+      magic (void)
+      {
+        return "DRTMTRC1";
+      }
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A GDB server API implementation that forwards all
+     * calls to the real server and records the memory traffic.
+     *
+     * @details
+     * To record a debug session, pass the recorder table, instead
+     * of the one received by `RTOS_Init()`, to the backend:
+     *
+     * @code{.cpp}
+     * static segger::drtm::trace_recorder recorder
+     *   { api, fopen ("/tmp/rtos.trace", "wb") };
+     * backend_t backend { recorder.api (), symbols };
+     * @endcode
+     *
+     * Each read and write is logged with the address, the length,
+     * the data, the result and the time spent in the server.
+     * Records are written directly to the stream; no memory is
+     * allocated, except for long messages, via the real server.
+     */
+    class trace_recorder : public server_adapter<trace_recorder>
+    {
+    public:
+
+      using target_addr_t = rtos_plugin_target_addr_t;
+
+      constexpr static std::size_t tmp_buf_size_bytes = 256;
+
+    public:
+
+      /**
+       * @param [in] api The real server API.
+       * @param [in] f Binary output stream; it is not closed.
+       */
+      trace_recorder (const rtos_plugin_server_api_t* api, FILE* f) :
+          real_ (api), //
+          f_ (f), //
+          little_endian_ (true), //
+          failed_ (f == nullptr), //
+          records_ (0)
+      {
+        const uint8_t probe[2] =
+          { 1, 0 };
+        little_endian_ = (real_->load_short (&probe[0]) == 1);
+
+        uint8_t header[trace_format::header_size_bytes] =
+          { };
+        std::memcpy (&header[0], trace_format::magic (),
+                     trace_format::magic_size_bytes);
+        header[trace_format::magic_size_bytes] =
+            little_endian_ ? trace_format::flag_little_endian : 0;
+        write_ (&header[0], sizeof(header));
+      }
+
+      // The rule of five.
+      trace_recorder (const trace_recorder&) = delete;
+      trace_recorder (trace_recorder&&) = delete;
+      trace_recorder&
+      operator= (const trace_recorder&) = delete;
+      trace_recorder&
+      operator= (trace_recorder&&) = delete;
+
+      ~trace_recorder ()
+      {
+        flush ();
+      }
+
+    public:
+
+      void
+      flush (void)
+      {
+        if (f_ != nullptr)
+          {
+            fflush (f_);
+          }
+      }
+
+      /**
+       * @brief Check if all records were written to the stream.
+       */
+      inline bool
+      is_ok (void) const
+      {
+        return !failed_;
+      }
+
+      inline std::size_t
+      records (void) const
+      {
+        return records_;
+      }
+
+    public:
+
+      // Server API, forwarded to the real server.
+
+      void*
+      malloc (std::size_t bytes)
+      {
+        return real_->malloc (bytes);
+      }
+
+      void
+      free (void* p)
+      {
+        real_->free (p);
+      }
+
+      void*
+      realloc (void* p, unsigned bytes)
+      {
+        return real_->realloc (p, bytes);
+      }
+
+      /**
+       * @brief Format the message and pass it to the real server.
+       *
+       * @details
+       * Short messages are formatted on the stack; longer ones in
+       * a block from the real server `malloc()`, like the backend
+       * does, so the recorder does not use the C++ heap while the
+       * plug-in runs in the server.
+       */
+      void
+      voutput (server_function channel, const char* fmt, std::va_list args)
+      {
+        char buf[tmp_buf_size_bytes];
+
+        std::va_list args_copy;
+        va_copy(args_copy, args);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+        int n = vsnprintf (buf, sizeof(buf), fmt, args);
+        if (n < 0)
+          {
+            va_end(args_copy);
+            return;
+          }
+
+        char* msg = &buf[0];
+        std::size_t msg_bytes = static_cast<std::size_t> (n) + 1;
+        if (msg_bytes > sizeof(buf))
+          {
+            char* p = static_cast<char*> (real_->malloc (msg_bytes));
+            if (p != nullptr)
+              {
+                vsnprintf (p, msg_bytes, fmt, args_copy);
+                msg = p;
+              }
+          }
+#pragma GCC diagnostic pop
+        va_end(args_copy);
+
+        switch (channel)
+          {
+          case server_function::output_debug:
+            real_->output_debug ("%s", msg);
+            break;
+          case server_function::output_warning:
+            real_->output_warning ("%s", msg);
+            break;
+          case server_function::output_error:
+            real_->output_error ("%s", msg);
+            break;
+          default:
+            real_->output ("%s", msg);
+            break;
+          }
+
+        if (msg != &buf[0])
+          {
+            real_->free (msg);
+          }
+      }
+
+      int
+      read_byte_array (target_addr_t addr, uint8_t* out_array,
+                       std::size_t bytes)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        int ret = real_->read_byte_array (addr, out_array, bytes);
+        record_ (server_function::read_byte_array, ret, addr, out_array,
+                 bytes, begin);
+        return ret;
+      }
+
+      int
+      read_byte (target_addr_t addr, uint8_t* out_value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        int ret = real_->read_byte (addr, out_value);
+        record_ (server_function::read_byte, ret, addr, out_value, 1, begin);
+        return ret;
+      }
+
+      int
+      read_short (target_addr_t addr, uint16_t* out_value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        int ret = real_->read_short (addr, out_value);
+        uint8_t buf[2];
+        if (ret >= 0)
+          {
+            store_ (&buf[0], *out_value, sizeof(buf));
+          }
+        record_ (server_function::read_short, ret, addr, &buf[0],
+                 sizeof(buf), begin);
+        return ret;
+      }
+
+      int
+      read_long (target_addr_t addr, uint32_t* out_value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        int ret = real_->read_long (addr, out_value);
+        uint8_t buf[4];
+        if (ret >= 0)
+          {
+            store_ (&buf[0], *out_value, sizeof(buf));
+          }
+        record_ (server_function::read_long, ret, addr, &buf[0], sizeof(buf),
+                 begin);
+        return ret;
+      }
+
+      int
+      write_byte_array (target_addr_t addr, const uint8_t* array,
+                        std::size_t bytes)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        int ret = real_->write_byte_array (addr, array, bytes);
+        record_ (server_function::write_byte_array, ret, addr, array, bytes,
+                 begin);
+        return ret;
+      }
+
+      void
+      write_byte (target_addr_t addr, uint8_t value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        real_->write_byte (addr, value);
+        record_ (server_function::write_byte, 0, addr, &value, 1, begin);
+      }
+
+      void
+      write_short (target_addr_t addr, uint16_t value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        real_->write_short (addr, value);
+        uint8_t buf[2];
+        store_ (&buf[0], value, sizeof(buf));
+        record_ (server_function::write_short, 0, addr, &buf[0], sizeof(buf),
+                 begin);
+      }
+
+      void
+      write_long (target_addr_t addr, uint32_t value)
+      {
+        auto begin = std::chrono::steady_clock::now ();
+        real_->write_long (addr, value);
+        uint8_t buf[4];
+        store_ (&buf[0], value, sizeof(buf));
+        record_ (server_function::write_long, 0, addr, &buf[0], sizeof(buf),
+                 begin);
+      }
+
+      inline bool
+      is_little_endian (void) const
+      {
+        return little_endian_;
+      }
+
+      uint32_t
+      load_short (const uint8_t* p)
+      {
+        return real_->load_short (p);
+      }
+
+      uint32_t
+      load_3bytes (const uint8_t* p)
+      {
+        return real_->load_3bytes (p);
+      }
+
+      uint32_t
+      load_long (const uint8_t* p)
+      {
+        return real_->load_long (p);
+      }
+
+    private:
+
+      void
+      record_ (server_function kind, int ret, target_addr_t addr,
+               const void* data, std::size_t bytes,
+               std::chrono::steady_clock::time_point begin)
+      {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now () - begin).count ();
+        uint32_t duration_ns =
+            (ns > 0xFFFFFFFF) ? 0xFFFFFFFF : static_cast<uint32_t> (ns);
+
+        bool is_read = (kind <= server_function::read_long);
+        bool has_data = (ret >= 0) || !is_read;
+
+        uint8_t r[trace_format::record_size_bytes];
+        r[trace_format::kind_offset] = static_cast<uint8_t> (kind);
+        r[trace_format::failed_offset] = static_cast<uint8_t> (ret < 0 ? 1 : 0);
+        little_endian_codec::store (&r[trace_format::addr_offset],
+                                    uint32_t (addr));
+        little_endian_codec::store (
+            &r[trace_format::length_offset],
+            static_cast<uint32_t> (has_data ? bytes : 0));
+        little_endian_codec::store (&r[trace_format::duration_offset],
+                                    duration_ns);
+        write_ (&r[0], sizeof(r));
+        if (has_data)
+          {
+            write_ (data, bytes);
+          }
+        ++records_;
+      }
+
+      void
+      write_ (const void* data, std::size_t bytes)
+      {
+        if (failed_)
+          {
+            return;
+          }
+        if (fwrite (data, 1, bytes, f_) != bytes)
+          {
+            failed_ = true;
+          }
+      }
+
+    private:
+
+      const rtos_plugin_server_api_t* real_;
+      FILE* f_;
+      bool little_endian_;
+      bool failed_;
+      std::size_t records_;
+    };
+
+    /**
+     * @brief A GDB server API implementation that serves the memory
+     * traffic of a recorded trace.
+     *
+     * @details
+     * Accesses that match the next record (same function, address
+     * and length) get the recorded data and result, so an unchanged
+     * plug-in replays deterministically. When the plug-in changes
+     * its access pattern, the next records are searched for a
+     * match, within a window, to resynchronise; accesses without
+     * a match are served from a memory image made of the data
+     * seen so far, or, for bytes not seen yet, of the last data
+     * seen in the whole trace. Bytes never seen cannot be read,
+     * unless `set_fill_unknown()` allows reading them as zeros,
+     * which is enough to benchmark changed access patterns.
+     *
+     * Writes are applied to the image and, without a match,
+     * succeed.
+     *
+     * The replayer runs only in host tools, never inside the GDB
+     * server, so it keeps the trace and the image in standard
+     * containers.
+     */
+    class trace_replayer : public server_adapter<trace_replayer>
+    {
+    public:
+
+      using target_addr_t = rtos_plugin_target_addr_t;
+
+      constexpr static std::size_t default_resync_window = 64;
+
+      struct replay_stats_t
+      {
+        // Accesses served by the matching record.
+        std::size_t matched;
+        // Records skipped to resynchronise.
+        std::size_t skipped;
+        // Accesses served from the image.
+        std::size_t from_image;
+        // Accesses touching bytes never seen in the trace.
+        std::size_t unknown;
+        // Server time recorded for the matched accesses.
+        uint64_t recorded_ns;
+      };
+
+    public:
+
+      trace_replayer () :
+          little_endian_ (true), //
+          cursor_ (0), //
+          resync_window_ (default_resync_window), //
+          fill_unknown_ (false), //
+          replay_stats_
+            { }
+      {
+        ;
+      }
+
+      // The rule of five.
+      trace_replayer (const trace_replayer&) = delete;
+      trace_replayer (trace_replayer&&) = delete;
+      trace_replayer&
+      operator= (const trace_replayer&) = delete;
+      trace_replayer&
+      operator= (trace_replayer&&) = delete;
+
+      ~trace_replayer () = default;
+
+    public:
+
+      /**
+       * @brief Load a trace written by `trace_recorder`.
+       *
+       * @retval 0 The trace was loaded.
+       * @retval <0 The file could not be read or is not a valid trace.
+       */
+      int
+      load_file (const char* path)
+      {
+        FILE* f = fopen (path, "rb");
+        if (f == nullptr)
+          {
+            return -1;
+          }
+
+        std::vector<uint8_t> data;
+        uint8_t buf[4096];
+        std::size_t n;
+        while ((n = fread (buf, 1, sizeof(buf), f)) > 0)
+          {
+            data.insert (data.end (), buf, buf + n);
+          }
+        bool failed = ferror (f) != 0;
+        fclose (f);
+        if (failed)
+          {
+            return -1;
+          }
+
+        return load (std::move (data));
+      }
+
+      /**
+       * @brief Load a trace from memory.
+       *
+       * @details
+       * The whole trace is validated before it is used; if it is
+       * not valid, the replayer is left empty.
+       */
+      int
+      load (std::vector<uint8_t> data)
+      {
+        data_.clear ();
+        records_.clear ();
+        past_.clear ();
+        all_.clear ();
+        cursor_ = 0;
+
+        if (data.size () < trace_format::header_size_bytes
+            || std::memcmp (data.data (), trace_format::magic (),
+                            trace_format::magic_size_bytes) != 0)
+          {
+            return -1;
+          }
+
+        std::vector<record_t> records;
+        std::size_t offset = trace_format::header_size_bytes;
+        while (offset < data.size ())
+          {
+            if (data.size () - offset < trace_format::record_size_bytes)
+              {
+                return -1;
+              }
+            const uint8_t* p = &data[offset];
+            record_t r;
+            r.kind = static_cast<server_function> (
+                p[trace_format::kind_offset]);
+            r.failed = p[trace_format::failed_offset] != 0;
+            r.addr = little_endian_codec::load_long (
+                p + trace_format::addr_offset);
+            r.length = little_endian_codec::load_long (
+                p + trace_format::length_offset);
+            r.duration_ns = little_endian_codec::load_long (
+                p + trace_format::duration_offset);
+            r.data = offset + trace_format::record_size_bytes;
+            if (r.kind > server_function::write_long
+                || r.kind < server_function::read_byte_array
+                || data.size () - r.data < r.length)
+              {
+                return -1;
+              }
+            offset = r.data + r.length;
+            records.push_back (r);
+          }
+
+        // Valid; the records and their data are kept together.
+        little_endian_ = (data[trace_format::magic_size_bytes]
+            & trace_format::flag_little_endian) != 0;
+        data_ = std::move (data);
+        records_ = std::move (records);
+        for (const record_t& r : records_)
+          {
+            apply_ (all_, r.addr, data_.data () + r.data, r.length);
+          }
+        return 0;
+      }
+
+      /**
+       * @brief Set how many records are searched to resynchronise
+       *  after an access without a match.
+       */
+      inline void
+      set_resync_window (std::size_t records)
+      {
+        resync_window_ = records;
+      }
+
+      /**
+       * @brief Read the bytes never seen in the trace as zeros,
+       *  instead of failing.
+       */
+      inline void
+      set_fill_unknown (bool fill)
+      {
+        fill_unknown_ = fill;
+      }
+
+      /**
+       * @brief Restart the replay from the first record.
+       */
+      void
+      rewind (void)
+      {
+        cursor_ = 0;
+        past_.clear ();
+        replay_stats_ = replay_stats_t
+          { };
+      }
+
+      inline std::size_t
+      records (void) const
+      {
+        return records_.size ();
+      }
+
+      inline const replay_stats_t&
+      replay_stats (void) const
+      {
+        return replay_stats_;
+      }
+
+      inline bool
+      is_little_endian (void) const
+      {
+        return little_endian_;
+      }
+
+    public:
+
+      // Server API.
+
+      int
+      read_byte_array (target_addr_t addr, uint8_t* out_array,
+                       std::size_t bytes)
+      {
+        return read_ (server_function::read_byte_array, addr, out_array,
+                      bytes);
+      }
+
+      int
+      read_byte (target_addr_t addr, uint8_t* out_value)
+      {
+        return read_ (server_function::read_byte, addr, out_value, 1);
+      }
+
+      int
+      read_short (target_addr_t addr, uint16_t* out_value)
+      {
+        uint8_t buf[2];
+        int ret = read_ (server_function::read_short, addr, &buf[0],
+                         sizeof(buf));
+        if (ret >= 0)
+          {
+            *out_value = static_cast<uint16_t> (load_ (&buf[0], sizeof(buf)));
+          }
+        return ret;
+      }
+
+      int
+      read_long (target_addr_t addr, uint32_t* out_value)
+      {
+        uint8_t buf[4];
+        int ret = read_ (server_function::read_long, addr, &buf[0],
+                         sizeof(buf));
+        if (ret >= 0)
+          {
+            *out_value = load_ (&buf[0], sizeof(buf));
+          }
+        return ret;
+      }
+
+      int
+      write_byte_array (target_addr_t addr, const uint8_t* array,
+                        std::size_t bytes)
+      {
+        return write_ (server_function::write_byte_array, addr, array, bytes);
+      }
+
+      void
+      write_byte (target_addr_t addr, uint8_t value)
+      {
+        write_ (server_function::write_byte, addr, &value, 1);
+      }
+
+      void
+      write_short (target_addr_t addr, uint16_t value)
+      {
+        uint8_t buf[2];
+        store_ (&buf[0], value, sizeof(buf));
+        write_ (server_function::write_short, addr, &buf[0], sizeof(buf));
+      }
+
+      void
+      write_long (target_addr_t addr, uint32_t value)
+      {
+        uint8_t buf[4];
+        store_ (&buf[0], value, sizeof(buf));
+        write_ (server_function::write_long, addr, &buf[0], sizeof(buf));
+      }
+
+    private:
+
+      struct record_t
+      {
+        server_function kind;
+        bool failed;
+        uint32_t addr;
+        uint32_t length;
+        uint32_t duration_ns;
+        std::size_t data;
+      };
+
+      constexpr static std::size_t page_size_bytes = 256;
+
+      struct page_t
+      {
+        uint8_t data[page_size_bytes];
+        bool known[page_size_bytes];
+      };
+
+      using image_t = std::unordered_map<uint32_t, page_t>;
+
+      /**
+       * @brief Find the record matching an access, at the cursor or
+       *  within the resync window, and consume it.
+       *
+       * @return Pointer to the record, or NULL.
+       */
+      const record_t*
+      match_ (server_function kind, target_addr_t addr, std::size_t bytes)
+      {
+        std::size_t end = records_.size ();
+        if (end - cursor_ > resync_window_ + 1)
+          {
+            end = cursor_ + resync_window_ + 1;
+          }
+
+        for (std::size_t i = cursor_; i < end; ++i)
+          {
+            const record_t& r = records_[i];
+            bool is_read = (r.kind <= server_function::read_long);
+            if (r.kind == kind && r.addr == addr
+                && (r.length == bytes || (is_read && r.failed)))
+              {
+                // Skipped records still advance the past image.
+                for (std::size_t k = cursor_; k <= i; ++k)
+                  {
+                    apply_ (past_, records_[k].addr,
+                            data_.data () + records_[k].data,
+                            records_[k].length);
+                  }
+                replay_stats_.skipped += i - cursor_;
+                cursor_ = i + 1;
+                ++replay_stats_.matched;
+                replay_stats_.recorded_ns += r.duration_ns;
+                return &r;
+              }
+          }
+        return nullptr;
+      }
+
+      int
+      read_ (server_function kind, target_addr_t addr, uint8_t* out,
+             std::size_t bytes)
+      {
+        const record_t* r = match_ (kind, addr, bytes);
+        if (r != nullptr)
+          {
+            if (r->failed)
+              {
+                return -1;
+              }
+            std::memcpy (out, data_.data () + r->data, bytes);
+            return 0;
+          }
+
+        ++replay_stats_.from_image;
+        bool unknown = false;
+        for (std::size_t i = 0; i < bytes; ++i)
+          {
+            uint32_t a = static_cast<uint32_t> (addr + i);
+            if (!lookup_ (past_, a, out + i) && !lookup_ (all_, a, out + i))
+              {
+                out[i] = 0;
+                unknown = true;
+              }
+          }
+        if (unknown)
+          {
+            ++replay_stats_.unknown;
+            return fill_unknown_ ? 0 : -1;
+          }
+        return 0;
+      }
+
+      int
+      write_ (server_function kind, target_addr_t addr, const uint8_t* array,
+              std::size_t bytes)
+      {
+        const record_t* r = match_ (kind, addr, bytes);
+        if (r != nullptr)
+          {
+            return r->failed ? -1 : 0;
+          }
+
+        ++replay_stats_.from_image;
+        apply_ (past_, addr, array, bytes);
+        return 0;
+      }
+
+      static void
+      apply_ (image_t& image, uint32_t addr, const uint8_t* data,
+              std::size_t bytes)
+      {
+        for (std::size_t i = 0; i < bytes; ++i)
+          {
+            uint32_t a = static_cast<uint32_t> (addr + i);
+            page_t& page = image[static_cast<uint32_t> (a / page_size_bytes)];
+            page.data[a % page_size_bytes] = data[i];
+            page.known[a % page_size_bytes] = true;
+          }
+      }
+
+      static bool
+      lookup_ (const image_t& image, uint32_t addr, uint8_t* out)
+      {
+        auto it = image.find (static_cast<uint32_t> (addr / page_size_bytes));
+        if (it == image.end () || !it->second.known[addr % page_size_bytes])
+          {
+            return false;
+          }
+        *out = it->second.data[addr % page_size_bytes];
+        return true;
+      }
+
+    private:
+
+      std::vector<uint8_t> data_;
+      std::vector<record_t> records_;
+
+      // Data seen up to the cursor, and in the whole trace.
+      image_t past_;
+      image_t all_;
+
+      bool little_endian_;
+      std::size_t cursor_;
+      std::size_t resync_window_;
+      bool fill_unknown_;
+      replay_stats_t replay_stats_;
+    };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_DRTM_TRACE_H_ */
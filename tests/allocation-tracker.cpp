@@ -0,0 +1,251 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `allocation_tracker` and `tracking_allocator`, over
+ * a server adapter whose `malloc()` can fail.
+ *
+ * Blocks must be registered while live, so `owns()` recognises
+ * them, and the statistics must track the live blocks and bytes
+ * and their peaks. `release_all()` must return all blocks to the
+ * server. The allocator must reject the same sizes as `allocator`
+ * and work with standard containers, rebinding included.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-allocation-tracker.h>
+
+#include "heap-target.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace segger::drtm;
+
+using tracker_t = allocation_tracker<rtos_plugin_server_api_t>;
+
+template<typename T>
+  using tracking_allocator_t = tracking_allocator<T, rtos_plugin_server_api_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+/**
+ * @brief Keep the last line printed by `report()`.
+ */
+struct report_capture
+{
+  int
+  output_debug (const char* fmt, ...)
+  {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int ret = vsnprintf (buf, sizeof(buf), fmt, args);
+    va_end(args);
+    line = buf;
+    return ret;
+  }
+
+  std::string line;
+};
+
+static bool
+is_aligned (const void* p)
+{
+  return (reinterpret_cast<uintptr_t> (p) % alignof(std::max_align_t)) == 0;
+}
+
+static void
+check_blocks (heap_target& heap)
+{
+  tracker_t tracker
+    { heap_target::api () };
+
+  void* a = tracker.allocate (10);
+  void* b = tracker.allocate (100);
+  void* c = tracker.allocate (0);
+  expect (a != nullptr && b != nullptr && c != nullptr, "allocate");
+  expect (is_aligned (a) && is_aligned (b) && is_aligned (c), "aligned");
+  std::memset (b, 0x55, 100);
+
+  expect (tracker.owns (a) && tracker.owns (b) && tracker.owns (c),
+          "owns live");
+  int local;
+  expect (!tracker.owns (&local) && !tracker.owns (nullptr), "owns other");
+
+  const tracker_t::stats_t& stats = tracker.stats ();
+  expect (stats.live_blocks == 3 && stats.live_bytes == 110
+              && stats.allocations == 3,
+          "live stats");
+  expect (heap.blocks == 3, "one server block each");
+
+  tracker.deallocate (b);
+  tracker.deallocate (nullptr);
+  expect (!tracker.owns (b) && tracker.owns (a) && tracker.owns (c),
+          "owns after deallocate");
+  expect (stats.live_blocks == 2 && stats.live_bytes == 10
+              && stats.peak_blocks == 3 && stats.peak_bytes == 110,
+          "peak stats");
+
+  // Fails without calling the server.
+  heap.clear_stats ();
+  expect (tracker.allocate (SIZE_MAX) == nullptr
+              && tracker.allocate (SIZE_MAX - 8) == nullptr
+              && heap.calls (server_function::malloc) == 0,
+          "overflow rejected");
+  heap.malloc_fails = true;
+  expect (tracker.allocate (8) == nullptr && stats.live_blocks == 2
+              && stats.allocations == 3,
+          "failed malloc");
+  heap.malloc_fails = false;
+
+  report_capture capture;
+  tracker.report (capture, "test");
+  expect (capture.line
+              == "test: 2 live blocks, 10 bytes; "
+                  "peak 3 blocks, 110 bytes; 3 allocations",
+          "report");
+
+  heap.clear_stats ();
+  expect (tracker.release_all () == 2, "release all count");
+  expect (heap.calls (server_function::free) == 2 && heap.blocks == 0,
+          "release all frees");
+  expect (!tracker.owns (a) && !tracker.owns (c) && stats.live_blocks == 0
+              && stats.live_bytes == 0 && stats.peak_blocks == 3,
+          "released stats");
+
+  // Usable again.
+  a = tracker.allocate (4);
+  expect (tracker.owns (a) && stats.live_blocks == 1, "after release all");
+  expect (tracker.release_all () == 1 && tracker.release_all () == 0,
+          "release all again");
+}
+
+static void
+check_destructor (heap_target& heap)
+{
+  {
+    tracker_t tracker
+      { heap_target::api () };
+    tracker.allocate (16);
+    tracker.allocate (32);
+    expect (heap.blocks == 2, "live before destruction");
+  }
+  expect (heap.blocks == 0, "destructor releases");
+}
+
+static void
+check_allocator (heap_target& heap)
+{
+  tracker_t tracker
+    { heap_target::api () };
+  tracking_allocator_t<uint32_t> a
+    { &tracker };
+
+  expect (a.get_api () == heap_target::api ()
+              && a.max_size () == allocator<uint32_t,
+                  rtos_plugin_server_api_t> (heap_target::api ()).max_size (),
+          "same limits as allocator");
+
+  bool thrown = false;
+  try
+    {
+      a.allocate (a.max_size () + 1);
+    }
+  catch (const std::system_error&)
+    {
+      thrown = true;
+    }
+  expect (thrown && tracker.stats ().allocations == 0, "too large rejected");
+
+  uint32_t* p = a.allocate (5);
+  expect (tracker.owns (p) && tracker.stats ().live_bytes == 20,
+          "allocator registers");
+  a.deallocate (p, 5);
+  expect (tracker.stats ().live_blocks == 0, "allocator unregisters");
+
+  {
+    std::vector<uint32_t, tracking_allocator_t<uint32_t>> v
+      { a };
+    for (uint32_t i = 0; i < 100; ++i)
+      {
+        v.push_back (i);
+      }
+    std::vector<uint32_t, tracking_allocator_t<uint32_t>> copy
+      { v };
+    expect (copy.get_allocator () == a && copy[99] == 99, "vector copy");
+
+    // Nodes, rebound from the element allocator.
+    std::list<uint64_t, tracking_allocator_t<uint64_t>> l
+      { tracking_allocator_t<uint64_t> (a) };
+    l.push_back (1);
+    l.push_back (2);
+    expect (tracker.stats ().live_blocks == 4 && heap.blocks == 4,
+            "containers registered");
+  }
+  expect (tracker.stats ().live_blocks == 0 && heap.blocks == 0,
+          "containers unregistered");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+
+  check_blocks (heap);
+  check_destructor (heap);
+  check_allocator (heap);
+
+  printf ("allocation-tracker: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
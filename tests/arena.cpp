@@ -0,0 +1,236 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `arena` and `arena_allocator`, over a server adapter
+ * whose `malloc()` can fail.
+ *
+ * Blocks must be aligned and served from the current chunk;
+ * `reset()` must reuse the chunks, in order, without server calls,
+ * and `release()` must return them all. Sizes that would overflow
+ * the chunk size, and failed chunk allocations, must return NULL
+ * and leave the arena usable.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+
+#include "heap-target.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace segger::drtm;
+
+using arena_t = arena<rtos_plugin_server_api_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static bool
+is_aligned (const void* p, std::size_t alignment)
+{
+  return (reinterpret_cast<uintptr_t> (p) & (alignment - 1)) == 0;
+}
+
+static void
+check_allocate (heap_target& heap)
+{
+  heap.clear_stats ();
+  arena_t arena
+    { heap_target::api (), 256 };
+  expect (arena.capacity_bytes () == 0 && heap.blocks == 0,
+          "nothing allocated at construction");
+
+  uint8_t* a = static_cast<uint8_t*> (arena.allocate (3, 1));
+  void* b = arena.allocate (8, 8);
+  void* c = arena.allocate (1, 64);
+  expect (a != nullptr && b != nullptr && c != nullptr, "allocated");
+  expect (is_aligned (b, 8) && is_aligned (c, 64), "aligned");
+  expect (static_cast<uint8_t*> (b) >= a + 3, "not overlapping");
+  expect (heap.calls (server_function::malloc) == 1
+              && arena.capacity_bytes () == 256,
+          "one chunk");
+
+  // Larger than a chunk.
+  void* d = arena.allocate (1000);
+  expect (d != nullptr && is_aligned (d, alignof(std::max_align_t)),
+          "large block");
+  expect (heap.calls (server_function::malloc) == 2
+              && arena.capacity_bytes () >= 256 + 1000,
+          "large chunk");
+
+  arena.release ();
+  expect (heap.blocks == 0 && heap.calls (server_function::free) == 2,
+          "all chunks freed");
+  expect (arena.capacity_bytes () == 0, "no capacity after release");
+
+  // Usable again.
+  expect (arena.allocate (16) != nullptr && heap.blocks == 1,
+          "allocate after release");
+}
+
+static void
+check_reset (heap_target& heap)
+{
+  arena_t arena
+    { heap_target::api (), 256 };
+
+  void* first[4];
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      // Two blocks fill a chunk.
+      first[i] = arena.allocate (128, 1);
+    }
+  expect (heap.blocks == 2, "two chunks");
+
+  heap.clear_stats ();
+  arena.reset ();
+  bool same = true;
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      same = same && (arena.allocate (128, 1) == first[i]);
+    }
+  expect (same, "chunks reused in order");
+  expect (heap.calls (server_function::malloc) == 0, "no malloc after reset");
+
+  // A block not fitting the first chunk continues in the next one.
+  arena.reset ();
+  arena.allocate (200, 1);
+  expect (arena.allocate (100, 1) == first[2]
+              && heap.calls (server_function::malloc) == 0,
+          "next kept chunk");
+
+  // Past the kept chunks, a new one is appended.
+  expect (arena.allocate (200, 1) != nullptr && heap.blocks == 3,
+          "chunk appended");
+  arena.reset ();
+  arena.allocate (256, 1);
+  arena.allocate (256, 1);
+  expect (arena.allocate (200, 1) != nullptr
+              && heap.calls (server_function::malloc) == 1,
+          "appended chunk kept");
+}
+
+static void
+check_failures (heap_target& heap)
+{
+  constexpr std::size_t max = std::numeric_limits<std::size_t>::max ();
+
+  arena_t arena
+    { heap_target::api (), 256 };
+  void* a = arena.allocate (16);
+
+  heap.clear_stats ();
+  expect (arena.allocate (max) == nullptr, "max size");
+  expect (arena.allocate (max - 8, 64) == nullptr, "max size with alignment");
+  expect (arena.allocate (max - 2 * sizeof(void*), 1) == nullptr,
+          "max size with header");
+  expect (heap.calls (server_function::malloc) == 0,
+          "no malloc for overflowing sizes");
+
+  // A failed chunk allocation keeps the current chunk.
+  heap.malloc_fails = true;
+  expect (arena.allocate (1000) == nullptr, "malloc failure");
+  void* b = arena.allocate (16);
+  heap.malloc_fails = false;
+  expect (b != nullptr && b != a && heap.blocks == 1,
+          "current chunk kept after failure");
+}
+
+static void
+check_allocator (heap_target& heap)
+{
+  using allocator_t = arena_allocator<uint32_t, rtos_plugin_server_api_t>;
+
+  heap.clear_stats ();
+  arena_t arena
+    { heap_target::api (), 1024 };
+  allocator_t allocator
+    { &arena };
+  std::vector<uint32_t, allocator_t> v
+    { allocator };
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      v.push_back (i);
+    }
+  bool same = true;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      same = same && (v[i] == i);
+    }
+  expect (same, "vector contents");
+  expect (is_aligned (v.data (), alignof(uint32_t)), "vector aligned");
+  expect (heap.calls (server_function::free) == 0,
+          "deallocate does not free");
+
+  arena_allocator<uint8_t, rtos_plugin_server_api_t> other
+    { allocator };
+  arena_t another
+    { heap_target::api () };
+  expect (other == allocator && other.get_arena () == &arena
+              && allocator != allocator_t (&another),
+          "allocator equality");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+
+  check_allocate (heap);
+  expect (heap.blocks == 0, "no leaks");
+  check_reset (heap);
+  expect (heap.blocks == 0, "no leaks after reset");
+  check_failures (heap);
+  check_allocator (heap);
+  expect (heap.blocks == 0, "no leaks at the end");
+
+  printf ("arena: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+/*
+ * Run the benchmarks of the backend and of the helpers layered on
+ * it, over the simulated target.
+ *
+ * Usage: bench [name...]
+ *
+ * Without arguments all benchmarks are run; otherwise only those
+ * named (update, snapshot, thread-map, buffer, symbols, pool, display,
+ * stack, hex, endian).
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+
+#include "benchmark.h"
+
+#include <cstring>
+
+using backend_t = segger::drtm::backend<rtos_plugin_server_api_t,
+rtos_plugin_symbols_t>;
+
+static bool
+is_selected (int argc, char* argv[], const char* name)
+{
+  if (argc <= 1)
+    {
+      return true;
+    }
+  for (int i = 1; i < argc; ++i)
+    {
+      if (std::strcmp (argv[i], name) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+int
+main (int argc, char* argv[])
+{
+  using namespace segger::drtm;
+
+  if (is_selected (argc, argv, "update"))
+    {
+      printf ("\n# Update, without read cache\n");
+      run_update_benchmarks<backend_t> (stdout, false);
+      printf ("\n# Update, with read cache\n");
+      run_update_benchmarks<backend_t> (stdout, true);
+    }
+  if (is_selected (argc, argv, "snapshot"))
+    {
+      printf ("\n# Incremental snapshot\n");
+      run_snapshot_benchmarks<backend_t> (stdout);
+    }
+  if (is_selected (argc, argv, "thread-map"))
+    {
+      printf ("\n# Thread map\n");
+      run_thread_map_benchmarks (stdout);
+    }
+  if (is_selected (argc, argv, "buffer"))
+    {
+      printf ("\n# Growable buffer\n");
+      run_buffer_benchmarks (stdout);
+    }
+  if (is_selected (argc, argv, "symbols"))
+    {
+      printf ("\n# Symbols index\n");
+      run_symbol_benchmarks<backend_t> (stdout);
+    }
+  if (is_selected (argc, argv, "pool"))
+    {
+      printf ("\n# Slot pool\n");
+      run_pool_benchmarks (stdout);
+    }
+  if (is_selected (argc, argv, "display"))
+    {
+      printf ("\n# Thread display strings\n");
+      run_display_benchmarks (stdout);
+    }
+  if (is_selected (argc, argv, "stack"))
+    {
+      printf ("\n# Stack scanner\n");
+      run_stack_scanner_benchmarks<backend_t> (stdout);
+    }
+  if (is_selected (argc, argv, "hex"))
+    {
+      printf ("\n# Hex encoder\n");
+      run_hex_benchmarks (stdout);
+    }
+  if (is_selected (argc, argv, "endian"))
+    {
+      printf ("\n# Endian codec\n");
+      run_endian_benchmarks (stdout);
+    }
+
+  return 0;
+}
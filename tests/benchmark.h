@@ -0,0 +1,1522 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+#ifndef SEGGER_JLINK_SDK_TESTS_BENCHMARK_H_
+#define SEGGER_JLINK_SDK_TESTS_BENCHMARK_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-struct.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-list.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-snapshot.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-thread-map.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-stack-scanner.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-hex.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-display-cache.h>
+
+#include <chrono>
+#include <vector>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+    /**
+     * @brief Layout of the thread control blocks created by
+     * `synthetic_thread_list`, similar to most RTOSes.
+     */
+    struct synthetic_tcb
+    {
+      constexpr static std::size_t next_offset = 0;
+      constexpr static std::size_t prev_offset = 4;
+      constexpr static std::size_t sp_offset = 8;
+      constexpr static std::size_t state_offset = 12;
+      constexpr static std::size_t prio_offset = 13;
+      constexpr static std::size_t flags_offset = 14;
+      constexpr static std::size_t name_offset = 16;
+      constexpr static std::size_t stack_base_offset = 20;
+      constexpr static std::size_t stack_size_offset = 24;
+      constexpr static std::size_t generation_offset = 28;
+
+      constexpr static std::size_t size_bytes = 64;
+      constexpr static std::size_t name_size_bytes = 16;
+    };
+
+    /**
+     * @brief The same layout, as descriptors for `backend::read_struct()`.
+     */
+    struct synthetic_tcb_layout : struct_layout<32>
+    {
+      using next = field<uint32_t, synthetic_tcb::next_offset>;
+      using prev = field<uint32_t, synthetic_tcb::prev_offset>;
+      using sp = field<uint32_t, synthetic_tcb::sp_offset>;
+      using state = field<uint8_t, synthetic_tcb::state_offset>;
+      using prio = field<uint8_t, synthetic_tcb::prio_offset>;
+      using name = field<uint32_t, synthetic_tcb::name_offset>;
+      using stack_base = field<uint32_t, synthetic_tcb::stack_base_offset>;
+      using stack_size = field<uint32_t, synthetic_tcb::stack_size_offset>;
+      using generation = field<uint8_t, synthetic_tcb::generation_offset>;
+    };
+
+    /**
+     * @brief The whole control block, with the generation counter
+     * as fingerprint, for `snapshot`.
+     */
+    struct synthetic_tcb_object : struct_layout<synthetic_tcb::size_bytes>
+    {
+      using fingerprint = byte_field<synthetic_tcb::generation_offset, 4>;
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Create, in a simulated target, a NULL terminated,
+     * doubly linked list of threads.
+     *
+     * @details
+     * The head pointer is stored at `base`, followed by the thread
+     * control blocks and their names. With `contiguous` false,
+     * the blocks are spread in a pseudo-random order, as if
+     * allocated from a fragmented heap.
+     */
+    class synthetic_thread_list
+    {
+    public:
+
+      using target_addr_t = rtos_plugin_target_addr_t;
+
+    public:
+
+      synthetic_thread_list (simulated_target& target, target_addr_t base,
+                             std::size_t threads, bool contiguous = true) :
+          target_ (target), //
+          base_ (base), //
+          threads_ (threads), //
+          contiguous_ (contiguous), //
+          seed_ (1)
+      {
+        // Spread blocks over 4 times the space, if not contiguous.
+        std::size_t slots = contiguous ? threads : 4 * threads;
+        tcbs_base_ = base + 16;
+        names_base_ = static_cast<target_addr_t> (tcbs_base_
+            + slots * synthetic_tcb::size_bytes);
+        target_.add_region (
+            base,
+            16 + slots * synthetic_tcb::size_bytes
+                + threads * synthetic_tcb::name_size_bytes);
+
+        target_addr_t prev = 0;
+        for (std::size_t i = 0; i < threads; ++i)
+          {
+            target_addr_t tcb = tcb_address (i);
+            if (prev == 0)
+              {
+                target_.poke_long (base_, tcb);
+              }
+            else
+              {
+                target_.poke_long (
+                    static_cast<target_addr_t> (prev
+                        + synthetic_tcb::next_offset),
+                    tcb);
+              }
+
+            target_.poke_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::prev_offset),
+                prev);
+            target_.poke_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::sp_offset),
+                static_cast<uint32_t> (0x20080000 + i * 0x400 - 0x40));
+            uint8_t state = static_cast<uint8_t> (i % 4);
+            uint8_t prio = static_cast<uint8_t> (1 + i % 32);
+            target_.poke (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::state_offset),
+                &state, 1);
+            target_.poke (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::prio_offset),
+                &prio, 1);
+
+            target_addr_t name = static_cast<target_addr_t> (names_base_
+                + i * synthetic_tcb::name_size_bytes);
+            char buf[synthetic_tcb::name_size_bytes] =
+              { };
+            snprintf (buf, sizeof(buf), "th%u", static_cast<unsigned> (i));
+            target_.poke (name, buf, sizeof(buf));
+            target_.poke_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::name_offset),
+                name);
+            target_.poke_long (
+                static_cast<target_addr_t> (tcb
+                    + synthetic_tcb::stack_base_offset),
+                static_cast<uint32_t> (0x20080000 + i * 0x400 - 0x400));
+            target_.poke_long (
+                static_cast<target_addr_t> (tcb
+                    + synthetic_tcb::stack_size_offset),
+                0x400);
+
+            prev = tcb;
+          }
+      }
+
+      // The rule of five.
+      synthetic_thread_list (const synthetic_thread_list&) = delete;
+      synthetic_thread_list (synthetic_thread_list&&) = delete;
+      synthetic_thread_list&
+      operator= (const synthetic_thread_list&) = delete;
+      synthetic_thread_list&
+      operator= (synthetic_thread_list&&) = delete;
+
+      ~synthetic_thread_list () = default;
+
+    public:
+
+      /**
+       * @brief Get the address of the variable pointing to the
+       *  first thread.
+       */
+      inline target_addr_t
+      head_address (void) const
+      {
+        return base_;
+      }
+
+      inline std::size_t
+      threads (void) const
+      {
+        return threads_;
+      }
+
+      /**
+       * @brief Get the address of the control block of a thread.
+       */
+      target_addr_t
+      tcb_address (std::size_t index) const
+      {
+        std::size_t slot = index;
+        if (!contiguous_)
+          {
+            // Multiplying by a large prime is a permutation
+            // of [0, 4 * threads).
+            slot = static_cast<std::size_t> ((uint64_t (index) * 2654435761u)
+                % (4 * threads_));
+          }
+        return static_cast<target_addr_t> (tcbs_base_
+            + slot * synthetic_tcb::size_bytes);
+      }
+
+      /**
+       * @brief Simulate the target running, by changing the state,
+       *  the stack pointer and the generation of some threads.
+       *
+       * @param [in] count Number of threads to change.
+       */
+      void
+      mutate (std::size_t count)
+      {
+        for (std::size_t k = 0; k < count && threads_ != 0; ++k)
+          {
+            seed_ = seed_ * 1103515245u + 12345u;
+            std::size_t i = (seed_ >> 8) % threads_;
+            target_addr_t tcb = tcb_address (i);
+
+            uint8_t* p = target_.peek (tcb, synthetic_tcb::size_bytes);
+            uint8_t& state = p[synthetic_tcb::state_offset];
+            state = static_cast<uint8_t> ((state + 1) % 4);
+            uint8_t& sp = p[synthetic_tcb::sp_offset];
+            sp = static_cast<uint8_t> (sp - 8);
+            ++p[synthetic_tcb::generation_offset];
+          }
+      }
+
+    private:
+
+      simulated_target& target_;
+      target_addr_t base_;
+      target_addr_t tcbs_base_;
+      target_addr_t names_base_;
+      std::size_t threads_;
+      bool contiguous_;
+      uint32_t seed_;
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief The reference update workload: walk the thread list,
+     * reading the fields a plug-in needs for the thread view,
+     * one access per field.
+     *
+     * @return The number of threads found.
+     */
+    template<typename B>
+      std::size_t
+      walk_synthetic_threads (B& backend,
+                              rtos_plugin_target_addr_t head_address,
+                              std::size_t max_threads)
+      {
+        using target_addr_t = rtos_plugin_target_addr_t;
+
+        std::size_t count = 0;
+        uint32_t tcb = 0;
+        if (backend.read_long (head_address, &tcb) < 0)
+          {
+            return 0;
+          }
+
+        while (tcb != 0 && count < max_threads)
+          {
+            uint32_t next;
+            uint32_t sp;
+            uint8_t state;
+            uint8_t prio;
+            uint32_t name;
+            uint32_t stack_base;
+            uint8_t name_buf[synthetic_tcb::name_size_bytes];
+
+            if (backend.read_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::next_offset),
+                &next) < 0)
+              {
+                break;
+              }
+            backend.read_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::sp_offset),
+                &sp);
+            backend.read_byte (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::state_offset),
+                &state);
+            backend.read_byte (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::prio_offset),
+                &prio);
+            backend.read_long (
+                static_cast<target_addr_t> (tcb + synthetic_tcb::name_offset),
+                &name);
+            backend.read_long (
+                static_cast<target_addr_t> (tcb
+                    + synthetic_tcb::stack_base_offset),
+                &stack_base);
+            backend.read_byte_array (name, &name_buf[0], sizeof(name_buf));
+
+            ++count;
+            tcb = next;
+          }
+
+        return count;
+      }
+
+    /**
+     * @brief The reference update workload, reading each thread
+     * control block with a single `read_struct()`.
+     *
+     * @return The number of threads found.
+     */
+    template<typename B>
+      std::size_t
+      walk_synthetic_threads_struct (B& backend,
+                                     rtos_plugin_target_addr_t head_address,
+                                     std::size_t max_threads)
+      {
+        std::size_t count = 0;
+        uint32_t tcb = 0;
+        if (backend.read_long (head_address, &tcb) < 0)
+          {
+            return 0;
+          }
+
+        target_struct<synthetic_tcb_layout> s;
+        while (tcb != 0 && count < max_threads)
+          {
+            if (backend.read_struct (tcb, s) < 0)
+              {
+                break;
+              }
+
+            uint8_t name_buf[synthetic_tcb::name_size_bytes];
+            backend.read_byte_array (s.get<synthetic_tcb_layout::name> (),
+                                     &name_buf[0], sizeof(name_buf));
+
+            ++count;
+            tcb = s.get<synthetic_tcb_layout::next> ();
+          }
+
+        return count;
+      }
+
+    /**
+     * @brief The reference update workload, walking the thread
+     * list with a `list_walker`, optionally with read-ahead.
+     *
+     * @return The number of threads found.
+     */
+    template<typename B>
+      std::size_t
+      walk_synthetic_threads_list (B& backend,
+                                   rtos_plugin_target_addr_t head_address,
+                                   std::size_t max_threads, bool read_ahead)
+      {
+        uint32_t first = 0;
+        if (backend.read_long (head_address, &first) < 0)
+          {
+            return 0;
+          }
+
+        list_walker<B, synthetic_tcb_layout, synthetic_tcb_layout::next> w
+          { backend, first };
+        w.set_max_nodes (max_threads);
+        w.set_read_ahead (read_ahead);
+
+        while (w.next ())
+          {
+            uint8_t name_buf[synthetic_tcb::name_size_bytes];
+            backend.read_byte_array (
+                w.node ().template get<synthetic_tcb_layout::name> (),
+                &name_buf[0], sizeof(name_buf));
+          }
+
+        return w.stats ().nodes;
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Measurements of one update pass.
+     */
+    struct benchmark_result_t
+    {
+      std::size_t threads;
+      uint64_t wall_ns;
+      uint64_t simulated_ns;
+      std::size_t transactions;
+      std::size_t bytes;
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief Measure one update pass of a workload.
+     *
+     * @details
+     * A cold pass starts with an invalidated read cache, like
+     * the first update after the target was running; a warm
+     * pass reuses whatever the previous pass left in the cache.
+     *
+     * @param [in] target The simulated target, for the counters.
+     * @param [in] backend The backend used by the workload.
+     * @param [in] cold Invalidate the read cache first.
+     * @param [in] workload Callable returning the number of threads.
+     */
+    template<typename B, typename F>
+      benchmark_result_t
+      measure_update (simulated_target& target, B& backend, bool cold,
+                      F workload)
+      {
+        if (cold)
+          {
+            backend.invalidate_cache ();
+          }
+        target.clear_stats ();
+
+        auto begin = std::chrono::steady_clock::now ();
+        std::size_t threads = workload ();
+        auto end = std::chrono::steady_clock::now ();
+
+        benchmark_result_t result;
+        result.threads = threads;
+        result.wall_ns = static_cast<uint64_t> (std::chrono::duration_cast<
+            std::chrono::nanoseconds> (end - begin).count ());
+        result.simulated_ns = target.simulated_ns ();
+        result.transactions = target.transactions ();
+        result.bytes = target.stats ().bytes_read
+            + target.stats ().bytes_written;
+        return result;
+      }
+
+    /**
+     * @brief Print a benchmark result as a table row.
+     */
+    inline void
+    print_benchmark_result (FILE* f, const char* name,
+                            const benchmark_result_t& result)
+    {
+      fprintf (f, "%-24s %6zu %12llu %12llu %8zu %10zu\n", name,
+               result.threads,
+               static_cast<unsigned long long> (result.wall_ns),
+               static_cast<unsigned long long> (result.simulated_ns),
+               result.transactions, result.bytes);
+    }
+
+    inline void
+    print_benchmark_header (FILE* f)
+    {
+      fprintf (f, "%-24s %6s %12s %12s %8s %10s\n", "workload", "thr",
+               "wall ns", "probe ns", "trans", "bytes");
+    }
+
+    /**
+     * @brief Run the reference update workload for 8 to 1024 threads,
+     * with cold and warm passes, plus cold passes reading whole
+     * control blocks, directly and through a list walker with and
+     * without read-ahead, and print the results.
+     *
+     * @details
+     * `B` is a backend type constructible from the server API
+     * table and a symbols table. The probe is modelled as 20 µs
+     * per transaction plus 250 ns per byte, roughly a 4 MHz SWD
+     * link behind USB.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] cache Enable the backend read cache.
+     */
+    template<typename B>
+      void
+      run_update_benchmarks (FILE* f, bool cache)
+      {
+        print_benchmark_header (f);
+
+        for (std::size_t threads = 8; threads <= 1024; threads *= 2)
+          {
+            simulated_target target;
+            target.set_latency (20000, 250);
+
+            synthetic_thread_list list
+              { target, 0x20000000, threads };
+
+            static typename B::symbols_t symbols[] =
+              {
+                { nullptr, 0, 0 } };
+            B backend
+              { simulated_target::api (), symbols };
+            if (cache)
+              {
+                backend.enable_cache ();
+              }
+
+            auto workload = [&]()
+              {
+                return walk_synthetic_threads (backend, list.head_address (),
+                    threads);
+              };
+
+            print_benchmark_result (
+                f, cache ? "update cold, cached" : "update cold",
+                measure_update (target, backend, true, workload));
+            print_benchmark_result (
+                f, cache ? "update warm, cached" : "update warm",
+                measure_update (target, backend, false, workload));
+
+            auto workload_struct = [&]()
+              {
+                return walk_synthetic_threads_struct (backend,
+                    list.head_address (), threads);
+              };
+
+            print_benchmark_result (
+                f, cache ? "struct cold, cached" : "struct cold",
+                measure_update (target, backend, true, workload_struct));
+
+            for (bool read_ahead :
+              { false, true})
+              {
+                auto workload_list = [&]()
+                  {
+                    return walk_synthetic_threads_list (backend,
+                        list.head_address (), threads, read_ahead);
+                  };
+
+                const char* name;
+                if (read_ahead)
+                  {
+                    name = cache ?
+                        "list ahead cold, cached" : "list ahead cold";
+                  }
+                else
+                  {
+                    name = cache ? "list cold, cached" : "list cold";
+                  }
+                print_benchmark_result (
+                    f, name,
+                    measure_update (target, backend, true, workload_list));
+              }
+          }
+      }
+
+    /**
+     * @brief Compare full and incremental refreshes of 8 to 1024
+     * threads, after a few threads changed, and print the results.
+     *
+     * @details
+     * The full refresh reads every control block and name; the
+     * incremental one reads the generation counters, then the
+     * control blocks and names of the changed threads only. The
+     * thread addresses are those of the previous update. The
+     * batch gap is raised to the control block size, so the
+     * counters are read in merged spans.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] changed Number of threads changed between updates.
+     */
+    template<typename B>
+      void
+      run_snapshot_benchmarks (FILE* f, std::size_t changed = 4)
+      {
+        print_benchmark_header (f);
+
+        for (std::size_t threads = 8; threads <= 1024; threads *= 2)
+          {
+            simulated_target target;
+            target.set_latency (20000, 250);
+
+            synthetic_thread_list list
+              { target, 0x20000000, threads };
+
+            static typename B::symbols_t symbols[] =
+              {
+                { nullptr, 0, 0 } };
+            B backend
+              { simulated_target::api (), symbols };
+            backend.set_batch_gap (synthetic_tcb::size_bytes);
+
+            std::vector<rtos_plugin_target_addr_t> addrs;
+            for (std::size_t i = 0; i < threads; ++i)
+              {
+                addrs.push_back (list.tcb_address (i));
+              }
+
+            snapshot<B, synthetic_tcb_object,
+                synthetic_tcb_object::fingerprint> snap
+              { backend };
+            snap.update (addrs.data (), addrs.size ());
+            list.mutate (changed);
+
+            auto workload_full = [&]()
+              {
+                return walk_synthetic_threads_struct (backend,
+                    list.head_address (), threads);
+              };
+            auto workload_snapshot = [&]()
+              {
+                snap.update (addrs.data (), addrs.size ());
+                for (std::size_t i = 0; i < snap.size (); ++i)
+                  {
+                    if (snap.is_changed (i))
+                      {
+                        uint8_t name_buf[synthetic_tcb::name_size_bytes];
+                        backend.read_byte_array (
+                            snap.object (i).template get<
+                                synthetic_tcb_layout::name> (),
+                            &name_buf[0], sizeof(name_buf));
+                      }
+                  }
+                return snap.size ();
+              };
+
+            print_benchmark_result (
+                f, "refresh full",
+                measure_update (target, backend, false, workload_full));
+            print_benchmark_result (
+                f, "refresh incremental",
+                measure_update (target, backend, false, workload_snapshot));
+          }
+      }
+
+    /**
+     * @brief Compare linear search and `thread_map` for the thread
+     * ID lookups of a GDB refresh, for 8 to 1024 threads, and print
+     * the average wall time of a refresh.
+     *
+     * @details
+     * A refresh rebuilds the map, then looks up each thread three
+     * times, as for `RTOS_GetThreadDisplay()`, `RTOS_GetThreadRegList()`
+     * and `RTOS_GetThreadReg()`. The IDs are control block addresses,
+     * either of a fragmented heap or of statically allocated blocks
+     * 4 KiB apart, which share all their low bits.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] refreshes Number of refreshes measured.
+     */
+    inline void
+    run_thread_map_benchmarks (FILE* f, std::size_t refreshes = 100)
+    {
+      using thread_id_t = rtos_plugin_thread_id_t;
+      using clock = std::chrono::steady_clock;
+
+      fprintf (f, "%-24s %6s %12s %12s\n", "lookups", "thr", "linear ns",
+               "map ns");
+
+      simulated_target target;
+      thread_map<allocator<thread_map_slot, rtos_plugin_server_api_t>> map
+        { allocator<thread_map_slot, rtos_plugin_server_api_t>
+          { simulated_target::api () } };
+
+      // Prevent the lookups from being optimised out.
+      volatile std::size_t sink = 0;
+
+      auto measure = [&](const char* name, const std::vector<thread_id_t>& ids)
+        {
+          const std::size_t threads = ids.size ();
+
+          auto begin = clock::now ();
+          for (std::size_t r = 0; r < refreshes; ++r)
+            {
+              for (std::size_t k = 0; k < 3 * threads; ++k)
+                {
+                  thread_id_t id = ids[k % threads];
+                  std::size_t i = 0;
+                  while (i < threads && ids[i] != id)
+                    {
+                      ++i;
+                    }
+                  sink = sink + i;
+                }
+            }
+          auto middle = clock::now ();
+          for (std::size_t r = 0; r < refreshes; ++r)
+            {
+              map.rebuild (ids.data (), threads);
+              for (std::size_t k = 0; k < 3 * threads; ++k)
+                {
+                  sink = sink + map.find (ids[k % threads]);
+                }
+            }
+          auto end = clock::now ();
+
+          auto ns = [refreshes](clock::duration d)
+            {
+              auto total =
+                  std::chrono::duration_cast<std::chrono::nanoseconds> (d);
+              return static_cast<unsigned long long> (total.count ())
+                  / refreshes;
+            };
+          fprintf (f, "%-24s %6zu %12llu %12llu\n", name, threads,
+                   ns (middle - begin), ns (end - middle));
+        };
+
+      for (std::size_t threads = 8; threads <= 1024; threads *= 2)
+        {
+          std::vector<thread_id_t> ids;
+          for (std::size_t i = 0; i < threads; ++i)
+            {
+              ids.push_back (static_cast<thread_id_t> (0x20000000
+                  + ((uint64_t (i) * 2654435761u) % (4 * threads)) * 64));
+            }
+          measure ("refresh heap", ids);
+
+          for (std::size_t i = 0; i < threads; ++i)
+            {
+              ids[i] = static_cast<thread_id_t> (0x20000000 + i * 4096);
+            }
+          measure ("refresh aligned 4K", ids);
+        }
+    }
+
+    /**
+     * @brief Compare growing a buffer by copying, as containers
+     * using `allocator` do, and growing a `pod_buffer` via the
+     * server `realloc()`, and print the average wall time of a
+     * build.
+     *
+     * @details
+     * A build appends 64 bytes chunks, as when collecting memory
+     * snapshots or hex strings, up to 4 KiB to 4 MiB, starting
+     * from an empty buffer. The copied bytes are those moved by
+     * the buffer itself; the moves are the grows that returned
+     * a different block.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] builds Number of builds measured for each size.
+     */
+    inline void
+    run_buffer_benchmarks (FILE* f, std::size_t builds = 20)
+    {
+      using server_api_t = rtos_plugin_server_api_t;
+      using clock = std::chrono::steady_clock;
+
+      constexpr std::size_t chunk_bytes = 64;
+      constexpr std::size_t initial_bytes = 64;
+
+      fprintf (f, "%-24s %8s %12s %12s %10s %11s %6s\n", "growth", "KiB",
+               "copy ns", "realloc ns", "copy KiB", "realloc KiB", "moves");
+
+      simulated_target target;
+      const server_api_t* api = simulated_target::api ();
+
+      uint8_t chunk[chunk_bytes];
+      for (std::size_t i = 0; i < chunk_bytes; ++i)
+        {
+          chunk[i] = static_cast<uint8_t> (i);
+        }
+
+      for (std::size_t total = 4096; total <= 4 * 1024 * 1024; total *= 4)
+        {
+          // Prevent the builds from being optimised out.
+          volatile std::size_t sink = 0;
+          std::size_t copied_bytes = 0;
+
+          auto begin = clock::now ();
+          for (std::size_t b = 0; b < builds; ++b)
+            {
+              allocator<uint8_t, server_api_t> a
+                { api };
+              uint8_t* buf = nullptr;
+              std::size_t size = 0;
+              std::size_t capacity = 0;
+              for (std::size_t n = 0; n < total; n += chunk_bytes)
+                {
+                  if (size + chunk_bytes > capacity)
+                    {
+                      std::size_t new_capacity =
+                          (capacity != 0) ? 2 * capacity : initial_bytes;
+                      uint8_t* p = a.allocate (new_capacity);
+                      if (p == nullptr)
+                        {
+                          break;
+                        }
+                      if (buf != nullptr)
+                        {
+                          std::memcpy (p, buf, size);
+                          copied_bytes += size;
+                          a.deallocate (buf, capacity);
+                        }
+                      buf = p;
+                      capacity = new_capacity;
+                    }
+                  std::memcpy (buf + size, chunk, chunk_bytes);
+                  size += chunk_bytes;
+                }
+              sink = sink + buf[size - 1];
+              a.deallocate (buf, capacity);
+            }
+          auto middle = clock::now ();
+
+          std::size_t moves = 0;
+          std::size_t realloc_copied_bytes = 0;
+          for (std::size_t b = 0; b < builds; ++b)
+            {
+              pod_buffer<uint8_t, server_api_t> buf
+                { api, initial_bytes };
+              for (std::size_t n = 0; n < total; n += chunk_bytes)
+                {
+                  if (buf.append (chunk, chunk_bytes) < 0)
+                    {
+                      break;
+                    }
+                }
+              sink = sink + buf[buf.size () - 1];
+              moves += buf.stats ().moves;
+              realloc_copied_bytes += buf.stats ().copied_bytes;
+            }
+          auto end = clock::now ();
+
+          auto ns = [builds](clock::duration d)
+            {
+              auto all = std::chrono::duration_cast<std::chrono::nanoseconds> (
+                  d).count ();
+              return static_cast<unsigned long long> (all) / builds;
+            };
+          fprintf (f, "%-24s %8zu %12llu %12llu %10zu %11zu %6zu\n",
+                   "append 64", total / 1024, ns (middle - begin),
+                   ns (end - middle), copied_bytes / builds / 1024,
+                   realloc_copied_bytes / builds / 1024, moves / builds);
+        }
+    }
+
+    /**
+     * @brief Compare ways of finding the stack high-water mark of
+     * 16 threads, for 1 KiB to 64 KiB stacks, and print the results.
+     *
+     * @details
+     * Each stack is filled with the µOS++ fill word, and its upper
+     * quarter is used. The reference reads one word at a time with
+     * `read_long()`; the scanner reads chunks linearly or bisects,
+     * and a second halt, with one thread grown by 64 bytes, is served
+     * from the cache of the bisect mode. The probe is modelled as in
+     * `run_update_benchmarks()`.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     */
+    template<typename B>
+      void
+      run_stack_scanner_benchmarks (FILE* f)
+      {
+        using target_addr_t = rtos_plugin_target_addr_t;
+
+        constexpr std::size_t threads = 16;
+        constexpr uint32_t fill = 0xEFBEADDE;
+        constexpr target_addr_t base = 0x20000000;
+
+        print_benchmark_header (f);
+
+        for (std::size_t size_bytes = 1024; size_bytes <= 64 * 1024;
+            size_bytes *= 4)
+          {
+            simulated_target target;
+            target.set_latency (20000, 250);
+
+            uint8_t* image = target.add_region (base, threads * size_bytes);
+            std::size_t used_bytes = size_bytes / 4;
+            for (std::size_t t = 0; t < threads; ++t)
+              {
+                uint8_t* stack = image + t * size_bytes;
+                for (std::size_t i = 0; i + 4 <= size_bytes; i += 4)
+                  {
+                    uint32_t w =
+                        (i < size_bytes - used_bytes) ? fill :
+                            static_cast<uint32_t> (i * 2654435761u);
+                    little_endian_codec::store (stack + i, w);
+                  }
+              }
+
+            static typename B::symbols_t symbols[] =
+              {
+                { nullptr, 0, 0 } };
+            B backend
+              { simulated_target::api (), symbols };
+
+            stack_scanner<B> scanner
+              { backend, fill };
+
+            auto stack_base = [=](std::size_t t)
+              {
+                return static_cast<target_addr_t> (base + t * size_bytes);
+              };
+
+            auto workload_long = [&]()
+              {
+                for (std::size_t t = 0; t < threads; ++t)
+                  {
+                    target_addr_t addr = stack_base (t);
+                    uint32_t w;
+                    while (addr < stack_base (t) + size_bytes
+                        && backend.read_long (addr, &w) == 0 && w == fill)
+                      {
+                        addr += 4;
+                      }
+                  }
+                return threads;
+              };
+            auto workload_scanner = [&]()
+              {
+                for (std::size_t t = 0; t < threads; ++t)
+                  {
+                    std::size_t used;
+                    scanner.high_water_mark (
+                        static_cast<rtos_plugin_thread_id_t> (t + 1),
+                        stack_base (t), size_bytes, 0, &used);
+                  }
+                return threads;
+              };
+
+            char name[48];
+            snprintf (name, sizeof(name), "stack %zuK read_long",
+                      size_bytes / 1024);
+            print_benchmark_result (
+                f, name,
+                measure_update (target, backend, false, workload_long));
+
+            snprintf (name, sizeof(name), "stack %zuK linear",
+                      size_bytes / 1024);
+            print_benchmark_result (
+                f, name,
+                measure_update (target, backend, false, workload_scanner));
+
+            scanner.set_mode (stack_scan_mode::bisect);
+            snprintf (name, sizeof(name), "stack %zuK bisect",
+                      size_bytes / 1024);
+            print_benchmark_result (
+                f, name,
+                measure_update (target, backend, false, workload_scanner));
+
+            // The next halt; one thread used 64 more bytes.
+            uint8_t* grown = image + size_bytes - used_bytes - 64;
+            std::memset (grown, 0, 64);
+            snprintf (name, sizeof(name), "stack %zuK bisect, cached",
+                      size_bytes / 1024);
+            print_benchmark_result (
+                f, name,
+                measure_update (target, backend, false, workload_scanner));
+          }
+      }
+
+    /**
+     * @brief Compare a linear scan of the symbols table and
+     * `get_symbol_address()` for tables of 10, 100 and 1000
+     * symbols, and print the total wall time of the lookups.
+     *
+     * @details
+     * Names are looked up in a pseudo-random order; the index
+     * is built by the first lookup, outside the measurement.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] lookups Number of lookups measured.
+     */
+    template<typename B>
+      void
+      run_symbol_benchmarks (FILE* f, std::size_t lookups = 100000)
+      {
+        using symbols_t = typename B::symbols_t;
+        using clock = std::chrono::steady_clock;
+
+        fprintf (f, "%-24s %6s %12s %12s\n", "lookups", "syms", "linear ns",
+                 "index ns");
+
+        simulated_target target;
+
+        for (std::size_t count = 10; count <= 1000; count *= 10)
+          {
+            std::vector<std::vector<char>> names;
+            std::vector<symbols_t> symbols;
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                names.push_back (std::vector<char> (32));
+                snprintf (names.back ().data (), names.back ().size (),
+                          "os_symbol_%zu", i);
+              }
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                symbols.push_back (symbols_t
+                  { names[i].data (), 0,
+                      static_cast<rtos_plugin_target_addr_t> (0x20000000
+                          + i * 4) });
+              }
+            symbols.push_back (symbols_t
+              { nullptr, 0, 0 });
+
+            B backend
+              { simulated_target::api (), symbols.data () };
+            backend.get_symbol_address (names[0].data ());
+
+            // Prevent the lookups from being optimised out.
+            volatile rtos_plugin_target_addr_t sink = 0;
+
+            auto begin = clock::now ();
+            for (std::size_t k = 0; k < lookups; ++k)
+              {
+                const char* name = names[(k * 7919) % count].data ();
+                for (const symbols_t* p = symbols.data (); p->name; ++p)
+                  {
+                    if (std::strcmp (name, p->name) == 0)
+                      {
+                        sink = sink + p->address;
+                        break;
+                      }
+                  }
+              }
+            auto middle = clock::now ();
+            for (std::size_t k = 0; k < lookups; ++k)
+              {
+                sink = sink
+                    + backend.get_symbol_address (
+                        names[(k * 7919) % count].data ());
+              }
+            auto end = clock::now ();
+
+            auto ns = [](clock::duration d)
+              {
+                return static_cast<unsigned long long> (
+                    std::chrono::duration_cast<std::chrono::nanoseconds> (
+                        d).count ());
+              };
+            fprintf (f, "%-24s %6zu %12llu %12llu\n", "get_symbol_address",
+                     count, ns (middle - begin), ns (end - middle));
+          }
+      }
+
+    /**
+     * @brief Compare `allocator` and `pool_allocator` for thread
+     * descriptors created and destroyed at each update, and print
+     * the wall time and the number of server `malloc()` calls.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] rebuilds Number of updates measured.
+     * @param [in] nodes Number of descriptors per update.
+     */
+    inline void
+    run_pool_benchmarks (FILE* f, std::size_t rebuilds = 2000,
+                         std::size_t nodes = 40)
+    {
+      using server_api_t = rtos_plugin_server_api_t;
+      using clock = std::chrono::steady_clock;
+
+      // A thread descriptor, as kept by plug-ins in a linked list.
+      struct descriptor_t
+      {
+        descriptor_t* next;
+        rtos_plugin_target_addr_t tcb;
+        rtos_plugin_thread_id_t id;
+        char name[16];
+      };
+
+      fprintf (f, "%-24s %6s %12s %12s %8s %8s\n", "rebuild", "nodes",
+               "malloc ns", "pool ns", "mallocs", "pooled");
+
+      simulated_target target;
+      const server_api_t* api = simulated_target::api ();
+      pool<server_api_t> p
+        { api, sizeof(descriptor_t) };
+
+      auto rebuild = [nodes, rebuilds](auto& a)
+        {
+          descriptor_t* head = nullptr;
+          for (std::size_t r = 0; r < rebuilds; ++r)
+            {
+              while (head != nullptr)
+                {
+                  descriptor_t* next = head->next;
+                  a.deallocate (head, 1);
+                  head = next;
+                }
+              for (std::size_t i = 0; i < nodes; ++i)
+                {
+                  descriptor_t* d = a.allocate (1);
+                  if (d == nullptr)
+                    {
+                      break;
+                    }
+                  d->next = head;
+                  d->tcb = static_cast<rtos_plugin_target_addr_t> (i * 64);
+                  d->id = static_cast<rtos_plugin_thread_id_t> (i);
+                  d->name[0] = '\0';
+                  head = d;
+                }
+            }
+          while (head != nullptr)
+            {
+              descriptor_t* next = head->next;
+              a.deallocate (head, 1);
+              head = next;
+            }
+        };
+
+      auto ns = [](clock::duration d)
+        {
+          return static_cast<unsigned long long> (std::chrono::duration_cast<
+              std::chrono::nanoseconds> (d).count ());
+        };
+
+      allocator<descriptor_t, server_api_t> malloc_allocator
+        { api };
+      target.clear_stats ();
+      auto begin = clock::now ();
+      rebuild (malloc_allocator);
+      auto end = clock::now ();
+      std::size_t mallocs = target.calls (server_function::malloc);
+      auto malloc_ns = ns (end - begin);
+
+      pool_allocator<descriptor_t, server_api_t> pooled_allocator
+        { &p, api };
+      target.clear_stats ();
+      begin = clock::now ();
+      rebuild (pooled_allocator);
+      end = clock::now ();
+      std::size_t pooled = target.calls (server_function::malloc);
+
+      fprintf (f, "%-24s %6zu %12llu %12llu %8zu %8zu\n", "descriptors",
+               nodes, malloc_ns, ns (end - begin), mallocs, pooled);
+    }
+
+    /**
+     * @brief Compare formatting the thread display string on each
+     * `RTOS_GetThreadDisplay()` call with rendering all strings
+     * once per update in a `display_cache`, and print the average
+     * wall time of an update.
+     *
+     * @details
+     * Each update asks for the display string of every thread
+     * `calls` times, as GDB does after a stop.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] updates Number of updates measured.
+     * @param [in] calls Number of requests per thread and update.
+     */
+    inline void
+    run_display_benchmarks (FILE* f, std::size_t updates = 2000,
+                            std::size_t calls = 3)
+    {
+      using server_api_t = rtos_plugin_server_api_t;
+      using clock = std::chrono::steady_clock;
+      using cache_t = display_cache<server_api_t>;
+
+      fprintf (f, "%-24s %6s %12s %12s %8s\n", "display", "thr",
+               "format ns", "cache ns", "mallocs");
+
+      simulated_target target;
+      const server_api_t* api = simulated_target::api ();
+      char out[cache_t::display_size_bytes];
+      // Keeps the copies from being optimised out.
+      std::size_t total = 0;
+
+      auto render = [&out](std::size_t i)
+        {
+          return snprintf (out, sizeof(out), "thread%zu [%s, prio %zu]", i,
+                           (i % 3 == 0) ? "Running" : "Waiting", i % 8);
+        };
+
+      auto ns = [](clock::duration d, std::size_t n)
+        {
+          return static_cast<unsigned long long> (std::chrono::duration_cast<
+              std::chrono::nanoseconds> (d).count () / n);
+        };
+
+      for (std::size_t threads = 8; threads <= 256; threads *= 4)
+        {
+          auto begin = clock::now ();
+          for (std::size_t u = 0; u < updates; ++u)
+            {
+              for (std::size_t c = 0; c < calls; ++c)
+                {
+                  for (std::size_t i = 0; i < threads; ++i)
+                    {
+                      total += static_cast<std::size_t> (render (i));
+                    }
+                }
+            }
+          auto format_ns = ns (clock::now () - begin, updates);
+
+          cache_t cache
+            { api };
+          target.clear_stats ();
+          begin = clock::now ();
+          for (std::size_t u = 0; u < updates; ++u)
+            {
+              cache.invalidate ();
+              for (std::size_t i = 0; i < threads; ++i)
+                {
+                  cache.format (static_cast<rtos_plugin_thread_id_t> (i),
+                                "thread%zu [%s, prio %zu]", i,
+                                (i % 3 == 0) ? "Running" : "Waiting", i % 8);
+                }
+              for (std::size_t c = 0; c < calls; ++c)
+                {
+                  for (std::size_t i = 0; i < threads; ++i)
+                    {
+                      total += static_cast<std::size_t> (cache.get (
+                          static_cast<rtos_plugin_thread_id_t> (i), out));
+                    }
+                }
+            }
+          auto cache_ns = ns (clock::now () - begin, updates);
+
+          fprintf (f, "%-24s %6zu %12llu %12llu %8zu\n", "strings", threads,
+                   format_ns, cache_ns, target.calls (server_function::malloc));
+        }
+      if (total == 0)
+        {
+          fprintf (f, "no output\n");
+        }
+    }
+
+    /**
+     * @brief Compare the hex encoder paths with the per-byte
+     * `snprintf()` encoding, and the decoder with `sscanf()` and
+     * with a per-digit loop, for a Cortex-M register list (68
+     * bytes), and for 256 and 4096 bytes memory blocks, and print
+     * the average wall time of an encoding or a decoding.
+     *
+     * @details
+     * The SSE2 and AVX2 encoder rows are printed only if the
+     * compiler targets them (for example with `-march=native`); the
+     * block paths are completed by the scalar code, as in
+     * `hex_encode()`. The `hex_decode()` row uses the widest path
+     * the compiler targets.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] iterations Number of encodings and decodings
+     *  measured.
+     */
+    inline void
+    run_hex_benchmarks (FILE* f, std::size_t iterations = 20000)
+    {
+      using clock = std::chrono::steady_clock;
+
+      fprintf (f, "%-24s %8s %12s %10s\n", "encoder", "bytes", "ns",
+               "MB/s");
+
+      const std::size_t sizes[] =
+        { 68, 256, 4096 };
+      for (std::size_t size : sizes)
+        {
+          std::vector<uint8_t> bytes (size);
+          for (std::size_t i = 0; i < size; ++i)
+            {
+              bytes[i] = static_cast<uint8_t> (i * 2654435761u >> 24);
+            }
+          std::vector<char> out (2 * size + 1);
+
+          // Prevent the encodings from being optimised out.
+          volatile char sink = 0;
+
+          auto measure = [&](const char* name, auto encode)
+            {
+              auto begin = clock::now ();
+              for (std::size_t k = 0; k < iterations; ++k)
+                {
+                  encode (bytes.data (), size, out.data ());
+                  sink = sink + out[k % (2 * size)];
+                }
+              auto end = clock::now ();
+
+              auto ns = static_cast<unsigned long long> (
+                  std::chrono::duration_cast<std::chrono::nanoseconds> (
+                      end - begin).count ()) / iterations;
+              fprintf (f, "%-24s %8zu %12llu %10llu\n", name, size, ns,
+                       (ns != 0) ? 1000ull * size / ns : 0);
+            };
+
+          measure ("snprintf", [](const uint8_t* p, std::size_t n, char* o)
+            {
+              for (std::size_t i = 0; i < n; ++i)
+                {
+                  snprintf (o + 2 * i, 3, "%02x", p[i]);
+                }
+            });
+          measure ("hex_encode_scalar", &hex_encode_scalar);
+#if defined(__SSE2__)
+          measure ("hex_encode_sse2",
+                   [](const uint8_t* p, std::size_t n, char* o)
+                     {
+                       std::size_t i = hex_encode_sse2 (p, n, o);
+                       hex_encode_scalar (p + i, n - i, o + 2 * i);
+                     });
+#endif /* defined(__SSE2__) */
+#if defined(__AVX2__)
+          measure ("hex_encode_avx2",
+                   [](const uint8_t* p, std::size_t n, char* o)
+                     {
+                       std::size_t i = hex_encode_avx2 (p, n, o);
+                       hex_encode_scalar (p + i, n - i, o + 2 * i);
+                     });
+#endif /* defined(__AVX2__) */
+          measure ("hex_encode",
+                   [&out](const uint8_t* p, std::size_t n, char* o)
+                     {
+                       hex_encode (p, n, o, out.size ());
+                     });
+        }
+
+      fprintf (f, "\n%-24s %8s %12s %10s\n", "decoder", "bytes", "ns",
+               "MB/s");
+
+      for (std::size_t size : sizes)
+        {
+          std::vector<uint8_t> bytes (size);
+          for (std::size_t i = 0; i < size; ++i)
+            {
+              bytes[i] = static_cast<uint8_t> (i * 2654435761u >> 24);
+            }
+          std::vector<char> hex (2 * size + 1);
+          hex_encode (bytes.data (), size, hex.data (), hex.size ());
+          std::vector<uint8_t> out (size);
+
+          volatile uint8_t sink = 0;
+
+          auto measure = [&](const char* name, auto decode)
+            {
+              auto begin = clock::now ();
+              for (std::size_t k = 0; k < iterations; ++k)
+                {
+                  decode (hex.data (), 2 * size, out.data ());
+                  sink = static_cast<uint8_t> (sink + out[k % size]);
+                }
+              auto end = clock::now ();
+
+              auto ns = static_cast<unsigned long long> (
+                  std::chrono::duration_cast<std::chrono::nanoseconds> (
+                      end - begin).count ()) / iterations;
+              fprintf (f, "%-24s %8zu %12llu %10llu\n", name, size, ns,
+                       (ns != 0) ? 1000ull * size / ns : 0);
+            };
+
+          measure ("sscanf", [](const char* h, std::size_t n, uint8_t* o)
+            {
+              for (std::size_t i = 0; i < n; i += 2)
+                {
+                  char digits[3] =
+                    { h[i], h[i + 1], '\0' };
+                  unsigned int v = 0;
+                  sscanf (digits, "%2x", &v);
+                  o[i / 2] = static_cast<uint8_t> (v);
+                }
+            });
+          measure ("hex_digit_value", [](const char* h, std::size_t n,
+                                         uint8_t* o)
+            {
+              for (std::size_t i = 0; i < n; i += 2)
+                {
+                  o[i / 2] = static_cast<uint8_t> (
+                      (hex_digit_value (h[i]) << 4)
+                          | hex_digit_value (h[i + 1]));
+                }
+            });
+          measure ("hex_decode",
+                   [size](const char* h, std::size_t n, uint8_t* o)
+                     {
+                       hex_decode (h, n, o, size);
+                     });
+          if (size % 4 == 0)
+            {
+              std::vector<uint32_t> values (size / 4);
+              measure ("hex_decode_registers",
+                       [&values](const char* h, std::size_t n, uint8_t* o)
+                         {
+                           hex_decode_registers (h, n, true, values.data (),
+                                                 values.size ());
+                           o[0] = static_cast<uint8_t> (values[0]);
+                         });
+            }
+        }
+    }
+
+    /**
+     * @brief The rows of `run_endian_benchmarks()` for codec `C`
+     * and values of type `V`.
+     */
+    template<typename C, typename V>
+      void
+      run_endian_codec_benchmarks (FILE* f, const char* order,
+                                   const std::vector<uint8_t>& bytes,
+                                   std::size_t iterations)
+      {
+        using clock = std::chrono::steady_clock;
+
+        const std::size_t count = bytes.size () / sizeof(V);
+        std::vector<V> values (count);
+        std::vector<uint8_t> out (bytes.size ());
+
+        // Prevent the conversions from being optimised out.
+        volatile V sink = 0;
+
+        auto measure = [&](const char* kind, auto convert)
+          {
+            auto begin = clock::now ();
+            for (std::size_t k = 0; k < iterations; ++k)
+              {
+                convert ();
+                sink = static_cast<V> (sink + values[k % count]
+                    + out[k % out.size ()]);
+              }
+            auto end = clock::now ();
+
+            auto ns = static_cast<unsigned long long> (
+                std::chrono::duration_cast<std::chrono::nanoseconds> (
+                    end - begin).count ()) / iterations;
+            char name[32];
+            snprintf (name, sizeof(name), "%s u%zu %s", order,
+                      8 * sizeof(V), kind);
+            fprintf (f, "%-24s %8zu %12llu %10llu\n", name, bytes.size (),
+                     ns, (ns != 0) ? 1000ull * bytes.size () / ns : 0);
+          };
+
+        measure ("load scalar", [&]()
+          {
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                values[i] = C::template load<V> (&bytes[i * sizeof(V)]);
+              }
+          });
+        measure ("load array", [&]()
+          {
+            C::load_array (bytes.data (), values.data (), count);
+          });
+        measure ("store scalar", [&]()
+          {
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                C::store (&out[i * sizeof(V)], values[i]);
+              }
+          });
+        measure ("store array", [&]()
+          {
+            C::store_array (values.data (), out.data (), count);
+          });
+      }
+
+    /**
+     * @brief Compare `endian_codec::load_array()` and
+     * `store_array()` (memcpy or `byte_swap_copy()`) with
+     * per-element `load()` and `store()`, for 16, 32 and 64-bits
+     * values in both target byte orders, and print the average
+     * wall time of a conversion of 4096 bytes.
+     *
+     * @param [in] f Output stream, usually `stdout`.
+     * @param [in] iterations Number of conversions measured.
+     */
+    inline void
+    run_endian_benchmarks (FILE* f, std::size_t iterations = 20000)
+    {
+      constexpr std::size_t size_bytes = 4096;
+
+      fprintf (f, "%-24s %8s %12s %10s\n", "conversion", "bytes", "ns",
+               "MB/s");
+
+      std::vector<uint8_t> bytes (size_bytes);
+      for (std::size_t i = 0; i < size_bytes; ++i)
+        {
+          bytes[i] = static_cast<uint8_t> (i * 2654435761u >> 24);
+        }
+
+      run_endian_codec_benchmarks<little_endian_codec, uint16_t> (
+          f, "little", bytes, iterations);
+      run_endian_codec_benchmarks<little_endian_codec, uint32_t> (
+          f, "little", bytes, iterations);
+      run_endian_codec_benchmarks<little_endian_codec, uint64_t> (
+          f, "little", bytes, iterations);
+      run_endian_codec_benchmarks<big_endian_codec, uint16_t> (
+          f, "big", bytes, iterations);
+      run_endian_codec_benchmarks<big_endian_codec, uint32_t> (
+          f, "big", bytes, iterations);
+      run_endian_codec_benchmarks<big_endian_codec, uint64_t> (
+          f, "big", bytes, iterations);
+    }
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_TESTS_BENCHMARK_H_ */
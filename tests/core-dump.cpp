@@ -0,0 +1,309 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `core_dump_target`, over small dumps written to
+ * temporary files.
+ *
+ * An ELF32 core with two adjacent `PT_LOAD` segments must be
+ * served as one memory range, so reads and writes across the
+ * segment boundary are split over both mappings; bytes outside
+ * the segments must not be read. Raw images are mapped at the
+ * given base address.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-core-dump.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t segment_size_bytes = 64;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+/**
+ * @brief Write a buffer to a new temporary file.
+ *
+ * @return The path, in a static buffer, or NULL.
+ */
+static const char*
+write_temp (const uint8_t* data, std::size_t bytes)
+{
+  static char path[64];
+  std::strcpy (path, "/tmp/core-dump-XXXXXX");
+  int fd = mkstemp (path);
+  if (fd < 0)
+    {
+      return nullptr;
+    }
+  bool ok = (write (fd, data, bytes) == static_cast<ssize_t> (bytes));
+  close (fd);
+  return ok ? path : nullptr;
+}
+
+static void
+store (uint8_t* p, uint32_t value, std::size_t bytes, bool little_endian)
+{
+  for (std::size_t i = 0; i < bytes; ++i)
+    {
+      std::size_t shift = little_endian ? i : bytes - 1 - i;
+      p[i] = static_cast<uint8_t> (value >> (8 * shift));
+    }
+}
+
+/**
+ * @brief Build an ELF32 core: the header, three program headers,
+ *  a `PT_NOTE` and two adjacent `PT_LOAD` segments, then the
+ *  segment bytes, each the low byte of its address.
+ */
+static std::size_t
+make_elf (uint8_t* elf, bool little_endian)
+{
+  constexpr std::size_t ehsize = 52;
+  constexpr std::size_t phentsize = 32;
+  constexpr std::size_t phnum = 3;
+  constexpr std::size_t data_offset = ehsize + phnum * phentsize;
+
+  std::memset (elf, 0, data_offset + 2 * segment_size_bytes);
+  std::memcpy (elf, "\177ELF", 4);
+  elf[4] = 1; // ELFCLASS32
+  elf[5] = little_endian ? 1 : 2;
+  elf[6] = 1; // EV_CURRENT
+  store (elf + 16, 4, 2, little_endian); // ET_CORE
+  store (elf + 18, 40, 2, little_endian); // EM_ARM
+  store (elf + 28, ehsize, 4, little_endian);
+  store (elf + 40, ehsize, 2, little_endian);
+  store (elf + 42, phentsize, 2, little_endian);
+  store (elf + 44, phnum, 2, little_endian);
+
+  uint8_t* ph = elf + ehsize;
+  store (ph, 4, 4, little_endian); // PT_NOTE, ignored.
+  store (ph + 4, data_offset, 4, little_endian);
+  store (ph + 8, 0x10000000, 4, little_endian);
+  store (ph + 16, 8, 4, little_endian);
+
+  // The second segment first, to check that regions are sorted.
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      ph += phentsize;
+      std::size_t k = 1 - i;
+      store (ph, 1, 4, little_endian); // PT_LOAD
+      store (ph + 4, data_offset + k * segment_size_bytes, 4, little_endian);
+      store (ph + 8, ram_base + k * segment_size_bytes, 4, little_endian);
+      store (ph + 16, segment_size_bytes, 4, little_endian);
+      store (ph + 20, segment_size_bytes, 4, little_endian);
+    }
+
+  for (std::size_t i = 0; i < 2 * segment_size_bytes; ++i)
+    {
+      elf[data_offset + i] = static_cast<uint8_t> (ram_base + i);
+    }
+  return data_offset + 2 * segment_size_bytes;
+}
+
+static void
+check_elf (void)
+{
+  static uint8_t elf[512];
+  std::size_t bytes = make_elf (elf, true);
+  const char* path = write_temp (elf, bytes);
+  expect (path != nullptr, "elf written");
+  if (path == nullptr)
+    {
+      return;
+    }
+
+  core_dump_target target
+    { false };
+  expect (target.map_elf (path) == 0, "elf mapped");
+  unlink (path);
+  expect (target.regions () == 2, "load segments only");
+  expect (target.is_little_endian (), "byte order from the header");
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { core_dump_target::api (), symbols };
+
+  // Across the segment boundary.
+  uint8_t out[16];
+  target_addr_t addr = ram_base + segment_size_bytes - 8;
+  expect (backend.read_byte_array (addr, out, sizeof(out)) == 0,
+          "read across segments");
+  bool same = true;
+  for (std::size_t i = 0; i < sizeof(out); ++i)
+    {
+      same = same && (out[i] == static_cast<uint8_t> (addr + i));
+    }
+  expect (same, "data across segments");
+
+  uint32_t value = 0;
+  expect (backend.read_long (ram_base + segment_size_bytes - 2, &value) == 0
+              && value == 0x41403F3Eu,
+          "long across segments");
+
+  // Writes across the boundary stay in the private mapping.
+  uint8_t in[8] =
+    { 1, 2, 3, 4, 5, 6, 7, 8 };
+  expect (backend.write_byte_array (ram_base + segment_size_bytes - 4, in,
+                                    sizeof(in))
+              == 0,
+          "write across segments");
+  expect (target.peek (ram_base + segment_size_bytes - 4, 4) != nullptr
+              && target.peek (ram_base + segment_size_bytes - 4, 4)[3] == 4
+              && target.peek (ram_base + segment_size_bytes, 4)[0] == 5,
+          "written data");
+  expect (target.peek (ram_base + segment_size_bytes - 4, 8) == nullptr,
+          "no direct pointer across segments");
+
+  // Past the end, and before the first segment; nothing is copied.
+  std::memset (out, 0xAA, sizeof(out));
+  expect (backend.read_byte_array (ram_base + 2 * segment_size_bytes - 8, out,
+                                   sizeof(out))
+              < 0,
+          "read past the end fails");
+  expect (out[0] == 0xAA, "nothing read past the end");
+  expect (backend.read_byte_array (ram_base - 4, out, 8) < 0,
+          "read before the start fails");
+  expect (backend.read_byte_array (0x10000000, out, 4) < 0,
+          "notes not mapped");
+}
+
+static void
+check_elf_big_endian (void)
+{
+  static uint8_t elf[512];
+  std::size_t bytes = make_elf (elf, false);
+  const char* path = write_temp (elf, bytes);
+  if (path == nullptr)
+    {
+      expect (false, "big endian elf written");
+      return;
+    }
+
+  core_dump_target target;
+  expect (target.map_elf (path) == 0, "big endian elf mapped");
+  unlink (path);
+  expect (target.regions () == 2 && !target.is_little_endian (),
+          "big endian regions");
+}
+
+static void
+check_invalid (void)
+{
+  static uint8_t elf[512];
+  std::size_t bytes = make_elf (elf, true);
+  // More program headers than the file holds.
+  store (elf + 44, 100, 2, true);
+  const char* path = write_temp (elf, bytes);
+  if (path == nullptr)
+    {
+      expect (false, "invalid elf written");
+      return;
+    }
+
+  core_dump_target target;
+  expect (target.map_elf (path) < 0, "invalid elf rejected");
+  expect (target.regions () == 0 && target.is_little_endian (),
+          "invalid elf ignored");
+  unlink (path);
+
+  expect (target.map_elf ("/nonexistent/core") < 0, "missing file");
+}
+
+static void
+check_raw (void)
+{
+  uint8_t image[32];
+  for (std::size_t i = 0; i < sizeof(image); ++i)
+    {
+      image[i] = static_cast<uint8_t> (i);
+    }
+  const char* path = write_temp (image, sizeof(image));
+  if (path == nullptr)
+    {
+      expect (false, "raw image written");
+      return;
+    }
+
+  core_dump_target target;
+  expect (target.map_raw (0x08000000, path) == 0, "raw mapped");
+  unlink (path);
+  expect (target.regions () == 1, "raw region");
+
+  uint8_t out[8];
+  expect (target.read_byte_array (0x08000000 + 24, out, sizeof(out)) == 0
+              && out[0] == 24 && out[7] == 31,
+          "raw read");
+  expect (target.read_byte_array (0x08000000 + 28, out, sizeof(out)) < 0,
+          "raw read past the end");
+}
+
+int
+main (void)
+{
+  check_elf ();
+  check_elf_big_endian ();
+  check_invalid ();
+  check_raw ();
+
+  printf ("core-dump: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `display_cache`, over the simulated target.
+ *
+ * Strings must be served from the cache until `invalidate()`,
+ * replaced when set again, and truncated to the size of the
+ * `RTOS_GetThreadDisplay()` buffer, whether set or formatted,
+ * without reading past the end of the source.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-display-cache.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace segger::drtm;
+
+using cache_t = display_cache<rtos_plugin_server_api_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static void
+check_hits (void)
+{
+  cache_t cache
+    { simulated_target::api () };
+  char out[cache_t::display_size_bytes];
+
+  expect (cache.get (1, out) < 0 && cache.stats ().misses == 1,
+          "miss before set");
+
+  expect (cache.set (1, "idle") == 0, "set");
+  expect (cache.format (2, "%s [prio %u]", "main", 5u) == 0, "format");
+  expect (cache.size () == 2 && cache.contains (1) && !cache.contains (3),
+          "contains");
+
+  for (int i = 0; i < 3; ++i)
+    {
+      expect (cache.get (1, out) == 4 && std::strcmp (out, "idle") == 0,
+              "hit");
+    }
+  expect (cache.get (2, out) == 13 && std::strcmp (out, "main [prio 5]") == 0,
+          "formatted hit");
+  expect (cache.stats ().hits == 4, "hits");
+
+  // Set again in the same update.
+  expect (cache.set (1, "running") == 0 && cache.size () == 2, "replace");
+  expect (cache.get (1, out) == 7 && std::strcmp (out, "running") == 0,
+          "replaced");
+
+  // A new update; the old strings are gone.
+  cache.invalidate ();
+  expect (cache.size () == 0 && cache.get (2, out) < 0, "invalidated");
+  expect (cache.set (2, "waiting") == 0
+              && cache.get (2, out) == 7
+              && std::strcmp (out, "waiting") == 0,
+          "refreshed");
+
+  // Many threads, beyond the initial table.
+  for (rtos_plugin_thread_id_t id = 100; id < 200; ++id)
+    {
+      cache.format (id, "t%u", static_cast<unsigned> (id));
+    }
+  expect (cache.get (150, out) == 4 && std::strcmp (out, "t150") == 0,
+          "many threads");
+}
+
+static void
+check_truncation (void)
+{
+  constexpr std::size_t max_length = cache_t::display_size_bytes - 1;
+
+  cache_t cache
+    { simulated_target::api () };
+  char out[cache_t::display_size_bytes];
+
+  // Exactly the size of the buffer, not terminated; nothing past
+  // it may be read.
+  char* exact = new char[cache_t::display_size_bytes];
+  std::memset (exact, 'a', cache_t::display_size_bytes);
+  expect (cache.set (1, exact) == 0, "set long");
+  delete[] exact;
+  expect (cache.get (1, out) == static_cast<int> (max_length)
+              && out[max_length] == '\0' && out[max_length - 1] == 'a',
+          "set truncated");
+
+  std::string shorter (max_length - 1, 'b');
+  expect (cache.set (2, shorter.c_str ()) == 0
+              && cache.get (2, out) == static_cast<int> (max_length - 1),
+          "not truncated");
+
+  std::string longer (1000, 'c');
+  expect (cache.format (3, "%s", longer.c_str ()) == 0, "format long");
+  expect (cache.get (3, out) == static_cast<int> (max_length)
+              && out[max_length - 1] == 'c',
+          "format truncated");
+
+  // A smaller output buffer.
+  char small[8];
+  expect (cache.get (3, small, sizeof(small)) == 7
+              && std::strcmp (small, "ccccccc") == 0,
+          "output truncated");
+
+  expect (cache.set (4, "") == 0 && cache.get (4, out) == 0 && out[0] == '\0',
+          "empty");
+}
+
+int
+main (void)
+{
+  simulated_target target;
+
+  check_hits ();
+  check_truncation ();
+
+  printf ("display-cache: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
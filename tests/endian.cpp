@@ -0,0 +1,236 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+/*
+ * Round trip checks of the endian codec, for all value widths and
+ * both target byte orders, at all offsets in a 64-bits word.
+ *
+ * The expected bytes are computed one at a time with shifts, so
+ * the checks do not depend on the host byte order. Array lengths
+ * cover the AVX2 and SSE2 blocks and the scalar tails.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-endian.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace segger::drtm;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what, const char* order,
+        std::size_t width, std::size_t offset, std::size_t count)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s, %s endian, %zu bytes, offset %zu, count %zu\n",
+              what, order, width, offset, count);
+      ++failures;
+    }
+}
+
+static uint64_t
+next_value (uint64_t& seed)
+{
+  seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+  return seed ^ (seed >> 29);
+}
+
+/**
+ * @brief Store a value in target memory, one byte at a time.
+ */
+template<endianness E, typename V>
+  static void
+  reference_store (uint8_t* p, V value)
+  {
+    for (std::size_t i = 0; i < sizeof(V); ++i)
+      {
+        std::size_t k = (E == endianness::little) ? i : sizeof(V) - 1 - i;
+        p[k] = static_cast<uint8_t> (static_cast<uint64_t> (value) >> (8 * i));
+      }
+  }
+
+template<endianness E, typename V>
+  static void
+  check_scalar (const char* order)
+  {
+    using codec = endian_codec<E>;
+
+    uint64_t seed = sizeof(V);
+    const V edges[] =
+      { V (0), V (~V (0)), V (0x0102030405060708ull), V (1) };
+
+    for (std::size_t offset = 0; offset < 8; ++offset)
+      {
+        for (std::size_t k = 0; k < 64 + 4; ++k)
+          {
+            V value = (k < 4) ? edges[k] : static_cast<V> (next_value (seed));
+
+            uint8_t expected[16] =
+              { };
+            reference_store<E> (&expected[offset], value);
+
+            uint8_t buf[16] =
+              { };
+            codec::store (&buf[offset], value);
+            expect (std::memcmp (buf, expected, sizeof(buf)) == 0, "store",
+                    order, sizeof(V), offset, 1);
+            expect (codec::template load<V> (&expected[offset]) == value,
+                    "load", order, sizeof(V), offset, 1);
+
+            if (sizeof(V) == 2)
+              {
+                expect (codec::load_short (&expected[offset]) == value,
+                        "load_short", order, sizeof(V), offset, 1);
+              }
+            else if (sizeof(V) == 4)
+              {
+                expect (codec::load_long (&expected[offset]) == value,
+                        "load_long", order, sizeof(V), offset, 1);
+              }
+            else if (sizeof(V) == 8)
+              {
+                expect (codec::load_long_long (&expected[offset]) == value,
+                        "load_long_long", order, sizeof(V), offset, 1);
+              }
+          }
+      }
+  }
+
+template<endianness E, typename V>
+  static void
+  check_array (const char* order)
+  {
+    using codec = endian_codec<E>;
+
+    uint64_t seed = 100 + sizeof(V);
+    for (std::size_t count = 0; count <= 80; ++count)
+      {
+        // One spare element, so data() is never null.
+        std::vector<V> values (count + 1);
+        for (V& v : values)
+          {
+            v = static_cast<V> (next_value (seed));
+          }
+
+        for (std::size_t offset = 0; offset < 8; ++offset)
+          {
+            std::vector<uint8_t> expected (offset + count * sizeof(V) + 8);
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                reference_store<E> (&expected[offset + i * sizeof(V)],
+                                    values[i]);
+              }
+
+            std::vector<uint8_t> bytes (expected.size ());
+            codec::store_array (values.data (), &bytes[offset], count);
+            expect (bytes == expected, "store_array", order, sizeof(V),
+                    offset, count);
+
+            // Load into an unaligned array too.
+            std::vector<uint8_t> raw ((count + 1) * sizeof(V));
+            V* loaded = reinterpret_cast<V*> (raw.data () + 1);
+            codec::load_array (&expected[offset], loaded, count);
+            expect (std::memcmp (loaded, values.data (),
+                                 count * sizeof(V)) == 0,
+                    "load_array", order, sizeof(V), offset, count);
+          }
+      }
+  }
+
+template<std::size_t W>
+  static void
+  check_byte_swap_copy (void)
+  {
+    uint64_t seed = 200 + W;
+    for (std::size_t count = 0; count <= 80; ++count)
+      {
+        for (std::size_t offset = 0; offset < 8; ++offset)
+          {
+            std::vector<uint8_t> src (offset + count * W + 8);
+            for (uint8_t& b : src)
+              {
+                b = static_cast<uint8_t> (next_value (seed));
+              }
+            std::vector<uint8_t> dst (offset + count * W + 8);
+            byte_swap_copy<W> (&src[offset], &dst[offset], count);
+
+            bool ok = true;
+            for (std::size_t i = 0; i < count * W; ++i)
+              {
+                std::size_t k = (i / W) * W + (W - 1 - i % W);
+                ok = ok && dst[offset + i] == src[offset + k];
+              }
+            expect (ok, "byte_swap_copy", "either", W, offset, count);
+          }
+      }
+  }
+
+int
+main (void)
+{
+  check_scalar<endianness::little, uint8_t> ("little");
+  check_scalar<endianness::little, uint16_t> ("little");
+  check_scalar<endianness::little, uint32_t> ("little");
+  check_scalar<endianness::little, uint64_t> ("little");
+  check_scalar<endianness::big, uint8_t> ("big");
+  check_scalar<endianness::big, uint16_t> ("big");
+  check_scalar<endianness::big, uint32_t> ("big");
+  check_scalar<endianness::big, uint64_t> ("big");
+
+  check_array<endianness::little, uint8_t> ("little");
+  check_array<endianness::little, uint16_t> ("little");
+  check_array<endianness::little, uint32_t> ("little");
+  check_array<endianness::little, uint64_t> ("little");
+  check_array<endianness::big, uint8_t> ("big");
+  check_array<endianness::big, uint16_t> ("big");
+  check_array<endianness::big, uint32_t> ("big");
+  check_array<endianness::big, uint64_t> ("big");
+
+  check_byte_swap_copy<2> ();
+  check_byte_swap_copy<4> ();
+  check_byte_swap_copy<8> ();
+
+  printf ("endian: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,420 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+
+/*
+ * Checks of the hex encoder, against `snprintf()`, and of the
+ * decoder.
+ *
+ * Each SIMD path is checked on its own, followed by the scalar
+ * path for the rest, at all source alignments in a 32 bytes block
+ * and for lengths covering the blocks and the tails. Register
+ * strings are checked in both target byte orders, and too small
+ * output buffers must be rejected without writing anything.
+ *
+ * Strings with mixed case digits must decode to the encoded bytes.
+ * An invalid digit at each position of the first SIMD blocks and
+ * of the tail must be reported at its offset; register strings
+ * with an error must leave the registers unchanged.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-hex.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace segger::drtm;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what, std::size_t count,
+        std::size_t offset)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s, count %zu, offset %zu\n", what, count, offset);
+      ++failures;
+    }
+}
+
+static uint64_t
+next_value (uint64_t& seed)
+{
+  seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+  return seed >> 24;
+}
+
+static std::vector<char>
+reference_encode (const uint8_t* bytes, std::size_t count)
+{
+  std::vector<char> out (2 * count + 1);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      snprintf (&out[2 * i], 3, "%02x", bytes[i]);
+    }
+  out[2 * count] = '\0';
+  return out;
+}
+
+/**
+ * @brief Encode with one SIMD function, then with the scalar one
+ *  for the bytes it left.
+ */
+template<typename F>
+  static bool
+  check_path (F encode, const uint8_t* bytes, std::size_t count,
+              const std::vector<char>& expected)
+  {
+    std::vector<char> out (2 * count + 1, '#');
+    std::size_t done = encode (bytes, count, out.data ());
+    if (done > count)
+      {
+        return false;
+      }
+    hex_encode_scalar (bytes + done, count - done, out.data () + 2 * done);
+    return std::memcmp (out.data (), expected.data (), 2 * count) == 0
+        && out[2 * count] == '#';
+  }
+
+static void
+check_encode (void)
+{
+  uint64_t seed = 1;
+  std::vector<uint8_t> buf (300 + 32);
+  for (uint8_t& b : buf)
+    {
+      b = static_cast<uint8_t> (next_value (seed));
+    }
+  // All byte values, including those with the high nibble 0xA-0xF.
+  for (std::size_t i = 0; i < 256; ++i)
+    {
+      buf[i] = static_cast<uint8_t> (i);
+    }
+
+  for (std::size_t count = 0; count <= 300; ++count)
+    {
+      for (std::size_t offset = 0; offset < 32; ++offset)
+        {
+          const uint8_t* bytes = buf.data () + offset;
+          std::vector<char> expected = reference_encode (bytes, count);
+
+          std::vector<char> out (2 * count + 1);
+          int ret = hex_encode (bytes, count, out.data (), out.size ());
+          expect (ret == static_cast<int> (2 * count)
+                      && std::strcmp (out.data (), expected.data ()) == 0,
+                  "hex_encode", count, offset);
+
+          expect (check_path ([](const uint8_t* b, std::size_t n, char* o)
+                                {
+                                  hex_encode_scalar (b, n, o);
+                                  return n;
+                                },
+                              bytes, count, expected),
+                  "hex_encode_scalar", count, offset);
+#if defined(__SSE2__)
+          expect (check_path (hex_encode_sse2, bytes, count, expected),
+                  "hex_encode_sse2", count, offset);
+#endif /* defined(__SSE2__) */
+#if defined(__AVX2__)
+          expect (check_path (hex_encode_avx2, bytes, count, expected),
+                  "hex_encode_avx2", count, offset);
+#endif /* defined(__AVX2__) */
+        }
+    }
+}
+
+static void
+check_encode_registers (void)
+{
+  uint64_t seed = 2;
+  for (std::size_t count = 0; count <= 40; ++count)
+    {
+      std::vector<uint32_t> values (count + 1);
+      for (uint32_t& v : values)
+        {
+          v = static_cast<uint32_t> (next_value (seed));
+        }
+      if (count > 0)
+        {
+          values[0] = 0x12345678;
+        }
+
+      for (int little_endian = 0; little_endian < 2; ++little_endian)
+        {
+          std::vector<char> expected (8 * count + 1);
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              uint32_t v = values[i];
+              if (little_endian)
+                {
+                  v = __builtin_bswap32 (v);
+                }
+              snprintf (&expected[8 * i], 9, "%08x", v);
+            }
+          expected[8 * count] = '\0';
+
+          std::vector<char> out (8 * count + 1);
+          int ret = hex_encode_registers (values.data (), count,
+                                          little_endian != 0, out.data (),
+                                          out.size ());
+          expect (ret == static_cast<int> (8 * count)
+                      && std::strcmp (out.data (), expected.data ()) == 0,
+                  little_endian ? "registers little" : "registers big",
+                  count, 0);
+        }
+    }
+}
+
+static void
+check_bounds (void)
+{
+  uint8_t bytes[40] =
+    { };
+  uint32_t values[5] =
+    { };
+  char out[128];
+
+  for (std::size_t count = 0; count <= 40; ++count)
+    {
+      // One byte short of the digits and the terminator.
+      std::memset (out, '#', sizeof(out));
+      expect (hex_encode (bytes, count, out, 2 * count) < 0 && out[0] == '#',
+              "hex_encode short buffer", count, 0);
+      expect (hex_encode (bytes, count, out, 2 * count + 1)
+                  == static_cast<int> (2 * count),
+              "hex_encode exact buffer", count, 0);
+    }
+  expect (hex_encode (bytes, 0, out, 0) < 0, "hex_encode no buffer", 0, 0);
+
+  for (std::size_t count = 0; count <= 5; ++count)
+    {
+      std::memset (out, '#', sizeof(out));
+      expect (hex_encode_registers (values, count, true, out, 8 * count) < 0
+                  && out[0] == '#',
+              "registers short buffer", count, 0);
+      expect (hex_encode_registers (values, count, true, out, 8 * count + 1)
+                  == static_cast<int> (8 * count),
+              "registers exact buffer", count, 0);
+    }
+}
+
+/**
+ * @brief Encode, with the letters in random case.
+ */
+static std::vector<char>
+mixed_case_encode (const uint8_t* bytes, std::size_t count, uint64_t& seed)
+{
+  std::vector<char> hex = reference_encode (bytes, count);
+  for (std::size_t i = 0; i < 2 * count; ++i)
+    {
+      if (hex[i] >= 'a' && next_value (seed) % 2 == 0)
+        {
+          hex[i] = static_cast<char> (hex[i] - 'a' + 'A');
+        }
+    }
+  return hex;
+}
+
+// Characters next to the ranges of digits, and with the high bit set.
+static const char invalid_digits[] =
+  { '/', ':', '@', 'G', '`', 'g', ' ', '\0', '\x80', '\xff' };
+
+static void
+check_decode (void)
+{
+  uint64_t seed = 3;
+  std::vector<uint8_t> bytes (300);
+  for (uint8_t& b : bytes)
+    {
+      b = static_cast<uint8_t> (next_value (seed));
+    }
+  for (std::size_t i = 0; i < 256; ++i)
+    {
+      bytes[i] = static_cast<uint8_t> (i);
+    }
+
+  for (std::size_t count = 0; count <= 300; ++count)
+    {
+      std::vector<char> hex = mixed_case_encode (bytes.data (), count, seed);
+
+      std::vector<uint8_t> out (count + 1, 0xA5);
+      int ret = hex_decode (hex.data (), 2 * count, out.data (), count);
+      expect (ret == static_cast<int> (count)
+                  && std::memcmp (out.data (), bytes.data (), count) == 0
+                  && out[count] == 0xA5,
+              "hex_decode", count, 0);
+    }
+
+  // One invalid digit at each position; 80 bytes cover two AVX2
+  // blocks, then SSE2 and scalar tails.
+  for (std::size_t count = 1; count <= 80; ++count)
+    {
+      std::vector<char> hex = mixed_case_encode (bytes.data (), count, seed);
+      std::vector<uint8_t> out (count);
+      for (std::size_t offset = 0; offset < 2 * count; ++offset)
+        {
+          char saved = hex[offset];
+          hex[offset] = invalid_digits[offset % sizeof(invalid_digits)];
+
+          std::size_t error_offset = 0;
+          int ret = hex_decode (hex.data (), 2 * count, out.data (), count,
+                                &error_offset);
+          expect (ret == hex_error_invalid_digit && error_offset == offset,
+                  "hex_decode invalid digit", count, offset);
+          expect (hex_validate (hex.data (), 2 * count) == offset,
+                  "hex_validate", count, offset);
+
+          hex[offset] = saved;
+        }
+      expect (hex_validate (hex.data (), 2 * count) == 2 * count,
+              "hex_validate valid", count, 0);
+    }
+
+  uint8_t out[40];
+  std::memset (out, 0xA5, sizeof(out));
+  std::vector<char> hex = reference_encode (bytes.data (), 40);
+  for (std::size_t length = 1; length < 80; length += 2)
+    {
+      expect (hex_decode (hex.data (), length, out, sizeof(out))
+                  == hex_error_odd_length,
+              "hex_decode odd length", length, 0);
+    }
+  for (std::size_t count = 1; count <= 40; ++count)
+    {
+      expect (hex_decode (hex.data (), 2 * count, out, count - 1)
+                  == hex_error_no_space && out[0] == 0xA5,
+              "hex_decode short buffer", count, 0);
+    }
+}
+
+static void
+check_decode_registers (void)
+{
+  uint64_t seed = 4;
+  for (std::size_t count = 0; count <= 40; ++count)
+    {
+      std::vector<uint8_t> bytes (4 * count);
+      for (uint8_t& b : bytes)
+        {
+          b = static_cast<uint8_t> (next_value (seed));
+        }
+      std::vector<char> hex = mixed_case_encode (bytes.data (), bytes.size (),
+                                                 seed);
+
+      for (int little_endian = 0; little_endian < 2; ++little_endian)
+        {
+          std::vector<uint32_t> values (count + 1, 0xA5A5A5A5);
+          int ret = hex_decode_registers (hex.data (), 8 * count,
+                                          little_endian != 0, values.data (),
+                                          count);
+          bool same = (ret == static_cast<int> (count))
+              && values[count] == 0xA5A5A5A5;
+          for (std::size_t i = 0; i < count && same; ++i)
+            {
+              const uint8_t* b = &bytes[4 * i];
+              uint32_t expected =
+                  little_endian ?
+                      little_endian_codec::load_long (b) :
+                      big_endian_codec::load_long (b);
+              same = (values[i] == expected);
+            }
+          expect (same, little_endian ?
+                      "decode registers little" : "decode registers big",
+                  count, 0);
+        }
+
+      if (count == 0)
+        {
+          continue;
+        }
+
+      // Nothing is written if any digit is invalid, even in the
+      // last block.
+      std::vector<uint32_t> values (count, 0xA5A5A5A5);
+      for (std::size_t offset = 0; offset < 8 * count; ++offset)
+        {
+          char saved = hex[offset];
+          hex[offset] = invalid_digits[offset % sizeof(invalid_digits)];
+
+          std::size_t error_offset = 0;
+          int ret = hex_decode_registers (hex.data (), 8 * count, true,
+                                          values.data (), count,
+                                          &error_offset);
+          bool unchanged = true;
+          for (uint32_t v : values)
+            {
+              unchanged = unchanged && (v == 0xA5A5A5A5);
+            }
+          expect (ret == hex_error_invalid_digit && error_offset == offset
+                      && unchanged,
+                  "decode registers invalid digit", count, offset);
+
+          hex[offset] = saved;
+        }
+
+      expect (hex_decode_registers (hex.data (), 8 * count - 1, true,
+                                    values.data (), count)
+                  == hex_error_odd_length,
+              "decode registers odd length", count, 0);
+      expect (hex_decode_registers (hex.data (), 8 * count - 2, true,
+                                    values.data (), count)
+                  == hex_error_register_length,
+              "decode registers partial register", count, 0);
+      expect (hex_decode_registers (hex.data (), 8 * count, true,
+                                    values.data (), count - 1)
+                  == hex_error_no_space && values[0] == 0xA5A5A5A5,
+              "decode registers short buffer", count, 0);
+    }
+}
+
+int
+main (void)
+{
+  check_encode ();
+  check_encode_registers ();
+  check_bounds ();
+  check_decode ();
+  check_decode_registers ();
+
+  printf ("hex: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `call_instrumentation`, over the simulated target.
+ *
+ * A known sequence of backend calls must be counted per server
+ * function, with the bytes transferred, and each call must land
+ * in exactly one histogram bucket; durations set up in the past
+ * must land in the bucket of their power of 2.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-instrumentation.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include "output-capture.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t,
+log_level::debug, call_instrumentation>;
+using counters_t = call_instrumentation::counters_t;
+
+static constexpr rtos_plugin_target_addr_t ram_base = 0x20000000;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static rtos_plugin_symbols_t symbols[] =
+  {
+    { nullptr, 0, 0 } };
+
+static uint64_t
+histogram_total (const counters_t& c)
+{
+  uint64_t total = 0;
+  for (std::size_t k = 0; k < call_instrumentation::histogram_buckets; ++k)
+    {
+      total += c.histogram[k];
+    }
+  return total;
+}
+
+static void
+check_counts (void)
+{
+  simulated_target target;
+  target.add_region (ram_base, 1024);
+  backend_t backend
+    { simulated_target::api (), symbols };
+  call_instrumentation& in = backend.instrumentation ();
+  in.clear ();
+
+  uint8_t buf[64];
+  backend.read_byte_array (ram_base, buf, 4);
+  backend.read_byte_array (ram_base, buf, 8);
+  backend.read_byte_array (ram_base, buf, 16);
+  uint32_t value;
+  backend.read_long (ram_base, &value);
+  backend.read_long (ram_base + 4, &value);
+  backend.write_byte_array (ram_base, buf, 10);
+  backend.write_long (ram_base, 1);
+  // A failed read is counted too.
+  backend.read_byte_array (ram_base + 2048, buf, 32);
+
+  const counters_t& reads = in.counters (server_function::read_byte_array);
+  expect (reads.calls == 4 && reads.bytes == 60, "array reads");
+  expect (histogram_total (reads) == 4, "array reads histogram");
+
+  const counters_t& longs = in.counters (server_function::read_long);
+  expect (longs.calls == 2 && longs.bytes == 8
+              && histogram_total (longs) == 2,
+          "long reads");
+
+  const counters_t& writes = in.counters (server_function::write_byte_array);
+  expect (writes.calls == 1 && writes.bytes == 10, "array write");
+  const counters_t& write_longs = in.counters (server_function::write_long);
+  expect (write_longs.calls == 1 && write_longs.bytes == 4, "long write");
+
+  expect (in.counters (server_function::read_short).calls == 0
+              && in.counters (server_function::write_byte).calls == 0,
+          "other functions not called");
+
+  // The server saw the same calls.
+  expect (target.calls (server_function::read_byte_array) == 4
+              && target.calls (server_function::write_long) == 1,
+          "same as the server");
+
+  in.clear ();
+  expect (in.counters (server_function::read_byte_array).calls == 0
+              && histogram_total (in.counters (
+                  server_function::read_byte_array)) == 0,
+          "cleared");
+}
+
+static void
+check_histogram (void)
+{
+  using clock = std::chrono::steady_clock;
+
+  call_instrumentation in;
+  in.clear ();
+
+  // [2^20, 2^21) ns, with half a millisecond of margin.
+  in.end (server_function::read_long, 4,
+          clock::now () - std::chrono::microseconds (1500));
+  // [2^31, 2^32) ns.
+  in.end (server_function::read_long, 4,
+          clock::now () - std::chrono::seconds (3));
+  in.end (server_function::read_long, 4,
+          clock::now () - std::chrono::seconds (3));
+  // Past the last bucket, saturated.
+  in.end (server_function::read_long, 4,
+          clock::now () - std::chrono::seconds (10));
+
+  const counters_t& c = in.counters (server_function::read_long);
+  expect (c.calls == 4 && c.bytes == 16, "calls");
+  expect (c.histogram[21] == 1, "bucket 21");
+  expect (c.histogram[32] == 3, "last bucket");
+  expect (histogram_total (c) == 4, "one bucket per call");
+  expect (c.total_ns >= 16000000000ull && c.total_ns < 17000000000ull,
+          "total time");
+}
+
+static void
+check_dump (void)
+{
+  call_instrumentation in;
+  in.clear ();
+  in.end (server_function::read_byte_array, 100,
+          std::chrono::steady_clock::now ());
+
+  FILE* f = tmpfile ();
+  if (f == nullptr)
+    {
+      expect (false, "tmpfile");
+      return;
+    }
+  in.dump (f);
+  rewind (f);
+  char line[512] = "";
+  expect (fgets (line, sizeof(line), f) != nullptr, "one line");
+  expect (std::strncmp (line, "read_byte_array", 15) == 0
+              && std::strstr (line, " 1 calls") != nullptr
+              && std::strstr (line, " 100 bytes") != nullptr,
+          "dump line");
+  expect (fgets (line, sizeof(line), f) == nullptr,
+          "only called functions");
+  fclose (f);
+
+  // Through the backend; its own outputs are not in the dump.
+  output_capture capture;
+  backend_t backend
+    { output_capture::api (), symbols };
+  backend.instrumentation ().clear ();
+  backend.output ("first");
+  backend.instrumentation ().dump (backend);
+  expect (capture.messages.size () == 2
+              && std::strncmp (capture.messages[1].text.c_str (), "output ",
+                               7) == 0
+              && capture.messages[1].text.find (" 1 calls")
+                  != std::string::npos,
+          "dump via the backend");
+}
+
+int
+main (void)
+{
+  check_counts ();
+  check_histogram ();
+  check_dump ();
+
+  printf ("instrumentation: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
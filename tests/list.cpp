@@ -0,0 +1,303 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `list_walker`, over the simulated target.
+ *
+ * Walks must stop at NULL or at the sentinel, and report cycles,
+ * misaligned or out of range pointers, nodes that cannot be read
+ * and lists longer than the limit. With read-ahead, contiguous
+ * nodes must be served from the window, and a window that cannot
+ * be read must fall back to reading the node alone.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-list.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 4096;
+
+struct node_layout : struct_layout<16>
+{
+  using next = field<uint32_t, 0>;
+  using value = field<uint32_t, 4>;
+};
+
+using walker_t = list_walker<backend_t, node_layout, node_layout::next, 128>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static uint8_t* image;
+
+static void
+set_node (target_addr_t addr, target_addr_t next, uint32_t value)
+{
+  little_endian_codec::store (image + (addr - ram_base), uint32_t (next));
+  little_endian_codec::store (image + (addr - ram_base) + 4, value);
+}
+
+/**
+ * @brief Link `count` nodes, `stride` bytes apart, ending with
+ *  `last_next`; the values are 1, 2, ...
+ */
+static void
+make_list (target_addr_t first, std::size_t count, std::size_t stride,
+           target_addr_t last_next)
+{
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      target_addr_t addr = static_cast<target_addr_t> (first + i * stride);
+      target_addr_t next =
+          (i + 1 < count) ?
+              static_cast<target_addr_t> (addr + stride) : last_next;
+      set_node (addr, next, static_cast<uint32_t> (i + 1));
+    }
+}
+
+/**
+ * @brief Walk to the end, optionally checking the values are
+ *  1, 2, ...
+ *
+ * @return The number of nodes.
+ */
+static std::size_t
+walk (walker_t& w, bool check_values = true)
+{
+  std::size_t count = 0;
+  while (w.next ())
+    {
+      ++count;
+      if (check_values && w.node ().get<node_layout::value> () != count)
+        {
+          expect (false, "node value");
+        }
+    }
+  return count;
+}
+
+static void
+check_end (simulated_target& target, backend_t& backend)
+{
+  make_list (ram_base, 5, 32, 0);
+
+  walker_t w
+    { backend, ram_base };
+  target.clear_stats ();
+  expect (walk (w) == 5 && w.status () == list_status::end, "null end");
+  expect (target.transactions () == 5 && w.stats ().reads == 5,
+          "one read per node");
+  expect (!w.next () && w.status () == list_status::end, "stays at end");
+
+  w.rewind ();
+  expect (w.next () && w.address () == ram_base, "rewind");
+
+  // Circular, with the list head as sentinel.
+  const target_addr_t head = ram_base + 1024;
+  set_node (head, ram_base + 1040, 0);
+  make_list (ram_base + 1040, 4, 16, head);
+  walker_t c
+    { backend, ram_base + 1040 };
+  c.set_sentinel (head);
+  expect (walk (c) == 4 && c.status () == list_status::end, "sentinel end");
+
+  walker_t empty
+    { backend, 0 };
+  expect (!empty.next () && empty.status () == list_status::end
+              && empty.stats ().reads == 0,
+          "empty list");
+}
+
+static void
+check_cycles (backend_t& backend)
+{
+  // 1 -> 2 -> 3 -> 4 -> 5 -> 3 ...
+  make_list (ram_base + 2048, 5, 16, ram_base + 2048 + 32);
+  walker_t w
+    { backend, ram_base + 2048 };
+  std::size_t count = walk (w, false);
+  expect (w.status () == list_status::cycle, "cycle detected");
+  expect (count >= 5 && count <= 16, "cycle detected early");
+
+  // A node pointing to itself.
+  set_node (ram_base + 2304, ram_base + 2304, 1);
+  walker_t self
+    { backend, ram_base + 2304 };
+  self.next ();
+  expect (!self.next () && self.status () == list_status::cycle,
+          "self loop");
+
+  // Back to the first node, without sentinel.
+  make_list (ram_base + 2560, 3, 16, ram_base + 2560);
+  walker_t back
+    { backend, ram_base + 2560 };
+  walk (back, false);
+  expect (back.status () == list_status::cycle, "circular without sentinel");
+}
+
+static void
+check_bad (backend_t& backend)
+{
+  // Misaligned.
+  make_list (ram_base, 3, 32, ram_base + 66);
+  walker_t w
+    { backend, ram_base };
+  expect (walk (w) == 3 && w.status () == list_status::bad_pointer,
+          "misaligned");
+
+  walker_t any
+    { backend, ram_base };
+  any.set_alignment (1);
+  walk (any, false);
+  expect (any.status () != list_status::bad_pointer, "alignment relaxed");
+
+  // Outside the range, and straddling its end.
+  make_list (ram_base, 3, 32, ram_base + 512);
+  walker_t out
+    { backend, ram_base };
+  out.set_range (ram_base, ram_base + 512);
+  expect (walk (out) == 3 && out.status () == list_status::bad_pointer,
+          "outside the range");
+
+  make_list (ram_base, 3, 32, ram_base + 504);
+  walker_t straddling
+    { backend, ram_base };
+  straddling.set_range (ram_base, ram_base + 512);
+  expect (walk (straddling) == 3
+              && straddling.status () == list_status::bad_pointer,
+          "straddling the range end");
+
+  // Not readable, without range.
+  make_list (ram_base, 3, 32, ram_base + 0x100000);
+  walker_t unreadable
+    { backend, ram_base };
+  expect (walk (unreadable) == 3
+              && unreadable.status () == list_status::read_error,
+          "read error");
+
+  // Too long.
+  make_list (ram_base, 10, 32, 0);
+  walker_t limited
+    { backend, ram_base };
+  limited.set_max_nodes (4);
+  expect (walk (limited) == 4 && limited.status () == list_status::limit,
+          "max nodes");
+}
+
+static void
+check_read_ahead (simulated_target& target, backend_t& backend)
+{
+  // 6 contiguous nodes; a window of 128 bytes holds 8.
+  make_list (ram_base, 6, 16, 0);
+  walker_t w
+    { backend, ram_base };
+  w.set_read_ahead (true);
+  target.clear_stats ();
+  expect (walk (w) == 6 && w.status () == list_status::end, "read-ahead walk");
+  expect (target.transactions () == 1 && w.stats ().reads == 1
+              && w.stats ().read_ahead_hits == 5,
+          "nodes from the window");
+
+  // Scattered nodes need a read each.
+  make_list (ram_base, 3, 256, 0);
+  walker_t scattered
+    { backend, ram_base };
+  scattered.set_read_ahead (true);
+  expect (walk (scattered) == 3 && scattered.stats ().reads == 3
+              && scattered.stats ().read_ahead_hits == 0,
+          "scattered nodes");
+
+  // At the end of the region, the window cannot be read.
+  const target_addr_t last = ram_base + ram_size_bytes - 48;
+  make_list (last, 3, 16, 0);
+  walker_t tail
+    { backend, last };
+  tail.set_read_ahead (true);
+  target.clear_stats ();
+  expect (walk (tail) == 3 && tail.status () == list_status::end,
+          "read-ahead fallback");
+  expect (target.transactions () == 6, "window, then node, per node");
+
+  // With a range, the window is clipped to it.
+  walker_t clipped
+    { backend, last };
+  clipped.set_read_ahead (true);
+  clipped.set_range (ram_base, ram_base + ram_size_bytes);
+  target.clear_stats ();
+  expect (walk (clipped) == 3 && target.transactions () == 1,
+          "window clipped to the range");
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  image = target.add_region (ram_base, ram_size_bytes);
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+
+  check_end (target, backend);
+  check_cycles (backend);
+  check_bad (backend);
+  check_read_ahead (target, backend);
+
+  printf ("list: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the backend log level filtering.
+ *
+ * Messages above the compile time level `L` must never reach the
+ * server, whatever the run time level; below it, `set_log_level()`
+ * must filter them. Arguments must be formatted as by `printf()`,
+ * and `%` characters in the result passed through unchanged.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+
+#include "output-capture.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static rtos_plugin_symbols_t symbols[] =
+  {
+    { nullptr, 0, 0 } };
+
+/**
+ * @brief Issue one message on each channel.
+ */
+template<typename B>
+  static void
+  output_all (B& backend)
+  {
+    backend.output ("info %d", 1);
+    backend.output_debug ("debug %s", "2");
+    backend.output_warning ("warning %u", 3u);
+    backend.output_error ("error %c", '4');
+  }
+
+static bool
+has (const output_capture& capture, server_function channel,
+     const char* text)
+{
+  for (const auto& m : capture.messages)
+    {
+      if (m.channel == channel && m.text == text)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+static void
+check_run_time (output_capture& capture)
+{
+  backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t> backend
+    { output_capture::api (), symbols };
+
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.size () == 4, "all levels by default");
+  expect (has (capture, server_function::output, "info 1")
+              && has (capture, server_function::output_debug, "debug 2")
+              && has (capture, server_function::output_warning, "warning 3")
+              && has (capture, server_function::output_error, "error 4"),
+          "formatted messages");
+
+  backend.set_log_level (log_level::warning);
+  expect (!backend.is_log_enabled (log_level::info)
+              && backend.is_log_enabled (log_level::error),
+          "run time level");
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.size () == 2
+              && capture.messages[0].channel == server_function::output_warning
+              && capture.messages[1].channel == server_function::output_error,
+          "run time filtering");
+
+  backend.set_log_level (log_level::none);
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.empty (), "no output");
+
+  // The result is not used again as a format.
+  backend.set_log_level (log_level::debug);
+  capture.messages.clear ();
+  backend.output ("%s", "100%d");
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == "100%d",
+          "percent passed through");
+}
+
+static void
+check_compile_time (output_capture& capture)
+{
+  using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t,
+  log_level::warning>;
+  static_assert(backend_t::max_log_level == log_level::warning, "level");
+
+  backend_t backend
+    { output_capture::api (), symbols };
+
+  capture.clear_stats ();
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.size () == 2
+              && has (capture, server_function::output_warning, "warning 3")
+              && has (capture, server_function::output_error, "error 4"),
+          "compile time filtering");
+  expect (capture.calls (server_function::output) == 0
+              && capture.calls (server_function::output_debug) == 0,
+          "no server calls above the level");
+
+  // The run time level cannot go above the compile time one.
+  backend.set_log_level (log_level::debug);
+  expect (!backend.is_log_enabled (log_level::info), "capped level");
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.size () == 2, "still filtered");
+
+  backend.set_log_level (log_level::error);
+  capture.messages.clear ();
+  output_all (backend);
+  expect (capture.messages.size () == 1
+              && has (capture, server_function::output_error, "error 4"),
+          "both levels");
+}
+
+int
+main (void)
+{
+  output_capture capture;
+
+  check_run_time (capture);
+  check_compile_time (capture);
+
+  printf ("log-level: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
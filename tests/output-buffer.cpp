@@ -0,0 +1,227 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the backend output formatting and buffering.
+ *
+ * Messages longer than the stack buffer must be formatted in the
+ * heap, not cut at `tmp_buf_size_bytes`. With buffering enabled,
+ * log and debug messages must be joined, one per line, and passed
+ * to the server when the threshold is reached, when the channel
+ * changes, by `flush_output()` or by an `output_guard`; warnings
+ * and errors must never be delayed, and must follow the messages
+ * issued before them.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+
+#include "output-capture.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static rtos_plugin_symbols_t symbols[] =
+  {
+    { nullptr, 0, 0 } };
+
+static void
+check_long (output_capture& capture)
+{
+  backend_t backend
+    { output_capture::api (), symbols };
+
+  std::string text (1000, 'x');
+  capture.messages.clear ();
+  capture.clear_stats ();
+  int ret = backend.output ("<%s>", text.c_str ());
+  expect (ret == 1002, "length returned");
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == "<" + text + ">",
+          "long message not truncated");
+  expect (capture.calls (server_function::malloc) == 1
+              && capture.calls (server_function::free) == 1,
+          "long message in the heap");
+
+  // Just fits the stack buffer.
+  std::string fits (backend_t::tmp_buf_size_bytes - 1, 'y');
+  capture.clear_stats ();
+  backend.output_error ("%s", fits.c_str ());
+  expect (capture.messages.back ().text == fits
+              && capture.calls (server_function::malloc) == 0,
+          "stack buffer");
+
+  // One more byte needs the heap.
+  fits += 'z';
+  backend.output_warning ("%s", fits.c_str ());
+  expect (capture.messages.back ().text == fits
+              && capture.calls (server_function::malloc) == 1,
+          "one byte over");
+}
+
+static void
+check_buffering (output_capture& capture)
+{
+  backend_t backend
+    { output_capture::api (), symbols };
+  backend.enable_output_buffering (64);
+
+  capture.messages.clear ();
+  backend.output ("one");
+  backend.output ("two\n");
+  expect (capture.messages.empty (), "buffered");
+
+  backend.flush_output ();
+  expect (capture.messages.size () == 1
+              && capture.messages[0].channel == server_function::output
+              && capture.messages[0].text == "one\ntwo",
+          "joined by lines");
+  backend.flush_output ();
+  expect (capture.messages.size () == 1, "nothing to flush");
+
+  // Another channel flushes the previous messages first.
+  capture.messages.clear ();
+  backend.output ("log");
+  backend.output_debug ("debug %d", 1);
+  backend.output_debug ("debug %d", 2);
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == "log",
+          "flushed on channel change");
+  backend.flush_output ();
+  expect (capture.messages.size () == 2
+              && capture.messages[1].channel == server_function::output_debug
+              && capture.messages[1].text == "debug 1\ndebug 2",
+          "debug joined");
+
+  // Warnings and errors go out at once, after the buffered ones.
+  capture.messages.clear ();
+  backend.output ("before");
+  backend.output_warning ("warning");
+  expect (capture.messages.size () == 2
+              && capture.messages[0].text == "before"
+              && capture.messages[1].channel
+                  == server_function::output_warning,
+          "warning not delayed");
+  backend.output_error ("error");
+  expect (capture.messages.size () == 3
+              && capture.messages[2].channel == server_function::output_error,
+          "error not delayed");
+
+  // The threshold.
+  capture.messages.clear ();
+  std::string chunk (32, 'c');
+  backend.output ("%s", chunk.c_str ());
+  expect (capture.messages.empty (), "below threshold");
+  backend.output ("%s", chunk.c_str ());
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == chunk + "\n" + chunk,
+          "flushed at threshold");
+
+  // Long messages are buffered whole.
+  capture.messages.clear ();
+  std::string text (500, 'l');
+  backend.output ("%s", text.c_str ());
+  expect (capture.messages.size () == 1 && capture.messages[0].text == text,
+          "long message buffered whole");
+
+  // `%` in buffered messages is not used as format.
+  capture.messages.clear ();
+  backend.output ("100%%");
+  {
+    backend_t::output_guard guard
+      { backend };
+    backend.output ("%s", "%d");
+  }
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == "100%\n%d",
+          "flushed by the guard");
+
+  // Disabled, each message goes out at once.
+  backend.output ("pending");
+  backend.disable_output_buffering ();
+  expect (capture.messages.size () == 2
+              && capture.messages[1].text == "pending",
+          "flushed when disabled");
+  backend.output ("direct");
+  expect (capture.messages.size () == 3, "not buffered");
+}
+
+static void
+check_destruction (output_capture& capture)
+{
+  capture.messages.clear ();
+  {
+    backend_t backend
+      { output_capture::api (), symbols };
+    backend.enable_output_buffering ();
+    backend.output ("last words");
+    expect (capture.messages.empty (), "still buffered");
+  }
+  expect (capture.messages.size () == 1
+              && capture.messages[0].text == "last words",
+          "flushed by the destructor");
+}
+
+int
+main (void)
+{
+  output_capture capture;
+
+  check_long (capture);
+  check_buffering (capture);
+  check_destruction (capture);
+
+  printf ("output-buffer: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
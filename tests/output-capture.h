@@ -0,0 +1,132 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+#ifndef SEGGER_JLINK_SDK_TESTS_OUTPUT_CAPTURE_H_
+#define SEGGER_JLINK_SDK_TESTS_OUTPUT_CAPTURE_H_
+
+#include <segger-jlink-rtos-plugin-sdk/rtos-plugin.h>
+#include <stdio.h>
+
+#if defined(__cplusplus)
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-server-adapter.h>
+
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+namespace segger
+{
+  namespace drtm
+  {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief A GDB server API implementation that keeps the
+     * messages passed to the output functions, for checks of the
+     * backend logging.
+     *
+     * @details
+     * There is no target memory; all accesses fail.
+     */
+    class output_capture : public server_adapter<output_capture>
+    {
+    public:
+
+      struct message_t
+      {
+        server_function channel;
+        std::string text;
+      };
+
+    public:
+
+      int
+      read_byte_array (target_addr_t addr __attribute__((unused)),
+                       uint8_t* out_array __attribute__((unused)),
+                       std::size_t bytes __attribute__((unused)))
+      {
+        return -1;
+      }
+
+      int
+      write_byte_array (target_addr_t addr __attribute__((unused)),
+                        const uint8_t* array __attribute__((unused)),
+                        std::size_t bytes __attribute__((unused)))
+      {
+        return -1;
+      }
+
+      void
+      voutput (server_function channel, const char* fmt, std::va_list args)
+      {
+        char buf[4096];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+        vsnprintf (buf, sizeof(buf), fmt, args);
+#pragma GCC diagnostic pop
+        messages.push_back (message_t
+          { channel, buf });
+      }
+
+      inline bool
+      is_little_endian (void) const
+      {
+        return true;
+      }
+
+    public:
+
+      std::vector<message_t> messages;
+    };
+
+#pragma GCC diagnostic pop
+
+    ;
+  // Avoid formatter bug
+  // ==========================================================================
+  } /* namespace drtm */
+} /* namespace segger */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* SEGGER_JLINK_SDK_TESTS_OUTPUT_CAPTURE_H_ */
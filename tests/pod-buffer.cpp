@@ -0,0 +1,217 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `pod_buffer`, over a server adapter whose `malloc()`
+ * and `realloc()` can fail.
+ *
+ * The storage must be grown with `realloc()` and, when it fails,
+ * with `malloc()` and a copy, keeping the content either way;
+ * when both fail the buffer must be left as it was. `resize()`,
+ * `extend()`, `clear()` and `release()` must keep the size and
+ * capacity consistent, and no block may be leaked.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+
+#include "heap-target.h"
+
+#include <cstdint>
+#include <limits>
+
+using namespace segger::drtm;
+
+using buffer_t = pod_buffer<uint32_t, rtos_plugin_server_api_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static void
+fill (buffer_t& buf, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      buf.push_back (static_cast<uint32_t> (i * 3 + 1));
+    }
+}
+
+static bool
+is_filled (const buffer_t& buf, std::size_t count)
+{
+  if (buf.size () != count)
+    {
+      return false;
+    }
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      if (buf[i] != i * 3 + 1)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+static void
+check_realloc (heap_target& heap)
+{
+  heap.clear_stats ();
+  {
+    buffer_t buf
+      { heap_target::api (), 4 };
+
+    expect (buf.empty () && buf.capacity () == 0 && buf.data () == nullptr,
+            "no storage before use");
+
+    fill (buf, 4);
+    expect (buf.capacity () == 4 && heap.calls (server_function::malloc) == 1,
+            "first block");
+
+    fill (buf, 0);
+    buf.push_back (13);
+    expect (buf.capacity () == 8 && buf.stats ().grows == 1
+                && heap.calls (server_function::realloc) == 1
+                && heap.calls (server_function::malloc) == 1
+                && buf.stats ().copied_bytes == 0,
+            "grown with realloc");
+
+    buf.resize (4);
+    expect (is_filled (buf, 4) && buf.capacity () == 8, "contents kept");
+
+    expect (buf.resize (100) == 0 && buf.size () == 100
+                && buf.capacity () == 128,
+            "resize doubles");
+    expect (buf[3] == 10 && heap.blocks == 1, "resize kept contents");
+  }
+  expect (heap.blocks == 0, "destructor frees");
+}
+
+static void
+check_fallback (heap_target& heap)
+{
+  heap.clear_stats ();
+  {
+    buffer_t buf
+      { heap_target::api (), 4 };
+    fill (buf, 4);
+
+    heap.realloc_fails = true;
+    fill (buf, 0);
+    expect (buf.push_back (13) == 0 && buf.capacity () == 8, "fallback grow");
+    expect (heap.calls (server_function::malloc) == 2
+                && heap.calls (server_function::free) == 1
+                && heap.blocks == 1,
+            "old block freed");
+    expect (buf.stats ().grows == 1 && buf.stats ().moves == 1
+                && buf.stats ().copied_bytes == 4 * sizeof(uint32_t),
+            "fallback stats");
+    buf.resize (4);
+    expect (is_filled (buf, 4), "fallback contents kept");
+
+    // Both fail; nothing changes.
+    heap.malloc_fails = true;
+    const uint32_t* data = buf.data ();
+    expect (buf.resize (9) < 0, "failed resize");
+    expect (buf.extend (5) == nullptr, "failed extend");
+    expect (buf.data () == data && buf.capacity () == 8 && is_filled (buf, 4),
+            "unchanged after failure");
+    heap.malloc_fails = false;
+    heap.realloc_fails = false;
+  }
+  expect (heap.blocks == 0, "fallback freed");
+}
+
+static void
+check_extend (heap_target& heap)
+{
+  buffer_t buf
+    { heap_target::api (), 4 };
+
+  uint32_t* p = buf.extend (3);
+  expect (p == buf.data () && buf.size () == 3, "extend empty");
+  p[0] = 1;
+  p[1] = 4;
+  p[2] = 7;
+
+  p = buf.extend (2);
+  expect (p == buf.data () + 3 && buf.size () == 5 && buf.capacity () == 8,
+          "extend grows");
+  expect (buf[2] == 7, "extend kept contents");
+
+  expect (buf.extend (std::numeric_limits<std::size_t>::max ()) == nullptr
+              && buf.size () == 5,
+          "extend overflow");
+  expect (buf.append (nullptr, 0) == 0 && buf.size () == 5, "append nothing");
+
+  buf.clear ();
+  expect (buf.empty () && buf.capacity () == 8 && heap.blocks == 1,
+          "clear keeps storage");
+
+  buf.release ();
+  expect (buf.empty () && buf.capacity () == 0 && buf.data () == nullptr
+              && heap.blocks == 0,
+          "release frees");
+
+  // Usable again.
+  fill (buf, 5);
+  expect (is_filled (buf, 5) && buf.capacity () == 8, "after release");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+
+  check_realloc (heap);
+  check_fallback (heap);
+  check_extend (heap);
+  expect (heap.blocks == 0, "no leaks");
+
+  printf ("pod-buffer: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
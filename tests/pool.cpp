@@ -0,0 +1,251 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `pool` and `pool_allocator`, over a server adapter
+ * whose `malloc()` can fail.
+ *
+ * Freed slots must be reused before new slabs are allocated,
+ * slabs must be added one at a time, and the statistics must
+ * track the live objects and the high-water mark. `release()`
+ * must return all slabs. The allocator must serve single objects
+ * from the pool and other requests from the server.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+
+#include "heap-target.h"
+
+#include <cstdint>
+#include <list>
+#include <set>
+
+using namespace segger::drtm;
+
+using pool_t = pool<rtos_plugin_server_api_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static void
+check_slots (heap_target& heap)
+{
+  heap.clear_stats ();
+  pool_t pool
+    { heap_target::api (), 20, 4 };
+
+  expect (pool.slot_size_bytes () % alignof(std::max_align_t) == 0
+              && pool.slot_size_bytes () >= 20,
+          "slot size rounded");
+  expect (pool.stats ().slabs == 0 && heap.blocks == 0,
+          "no slab at construction");
+
+  void* slots[10];
+  std::set<void*> distinct;
+  for (std::size_t i = 0; i < 10; ++i)
+    {
+      slots[i] = pool.allocate ();
+      distinct.insert (slots[i]);
+      expect (slots[i] != nullptr
+                  && (reinterpret_cast<uintptr_t> (slots[i])
+                      % alignof(std::max_align_t)) == 0,
+              "aligned slot");
+    }
+  expect (distinct.size () == 10, "distinct slots");
+  expect (pool.stats ().slabs == 3 && heap.calls (server_function::malloc) == 3,
+          "one slab per 4 slots");
+  expect (pool.stats ().live_objects == 10
+              && pool.stats ().high_water_mark == 10,
+          "live objects");
+
+  // The last freed slot is reused first, without new slabs.
+  pool.deallocate (slots[3]);
+  pool.deallocate (slots[7]);
+  expect (pool.stats ().live_objects == 8, "live after free");
+  expect (pool.allocate () == slots[7] && pool.allocate () == slots[3],
+          "slots reused");
+  expect (pool.stats ().slabs == 3 && pool.stats ().high_water_mark == 10,
+          "no growth on reuse");
+
+  // The remaining slots of the last slab, then a new slab.
+  void* a = pool.allocate ();
+  void* b = pool.allocate ();
+  expect (pool.stats ().slabs == 3, "last slab filled");
+  void* extra = pool.allocate ();
+  expect (pool.stats ().slabs == 4 && pool.stats ().high_water_mark == 13,
+          "slab added");
+
+  pool.deallocate (nullptr);
+  expect (pool.stats ().live_objects == 13, "null ignored");
+
+  // Rebuild, as on each update; the high-water mark is kept.
+  pool.deallocate (extra);
+  for (std::size_t i = 0; i < 10; ++i)
+    {
+      pool.deallocate (slots[i]);
+    }
+  pool.deallocate (a);
+  pool.deallocate (b);
+  expect (pool.stats ().live_objects == 0
+              && pool.stats ().high_water_mark == 13,
+          "all freed");
+  expect (heap.calls (server_function::free) == 0, "slabs kept");
+}
+
+static void
+check_release (heap_target& heap)
+{
+  pool_t pool
+    { heap_target::api (), 8, 2 };
+  void* slots[5];
+  for (std::size_t i = 0; i < 5; ++i)
+    {
+      slots[i] = pool.allocate ();
+    }
+  expect (heap.blocks == 3, "three slabs");
+  for (std::size_t i = 0; i < 5; ++i)
+    {
+      pool.deallocate (slots[i]);
+    }
+
+  heap.clear_stats ();
+  pool.release ();
+  expect (heap.blocks == 0 && heap.calls (server_function::free) == 3,
+          "all slabs freed");
+  expect (pool.stats ().slabs == 0 && pool.stats ().live_objects == 0
+              && pool.stats ().high_water_mark == 5,
+          "stats after release");
+
+  // Usable again.
+  void* p = pool.allocate ();
+  expect (p != nullptr && heap.blocks == 1, "allocate after release");
+  pool.deallocate (p);
+
+  // A failed slab allocation, once the first slab is full.
+  slots[0] = pool.allocate ();
+  slots[1] = pool.allocate ();
+  heap.malloc_fails = true;
+  expect (pool.allocate () == nullptr, "malloc failure");
+  heap.malloc_fails = false;
+  expect (pool.stats ().live_objects == 2, "live after failure");
+  slots[2] = pool.allocate ();
+  expect (slots[2] != nullptr && pool.stats ().slabs == 2,
+          "slab after failure");
+  for (std::size_t i = 0; i < 3; ++i)
+    {
+      pool.deallocate (slots[i]);
+    }
+}
+
+struct node_t
+{
+  node_t* next;
+  uint32_t value;
+};
+
+static void
+check_allocator (heap_target& heap)
+{
+  using allocator_t = pool_allocator<node_t, rtos_plugin_server_api_t>;
+
+  pool_t pool
+    { heap_target::api (), 64, 8 };
+  allocator_t allocator
+    { &pool, heap_target::api () };
+
+  heap.clear_stats ();
+  node_t* n = allocator.allocate (1);
+  expect (n != nullptr && pool.stats ().live_objects == 1,
+          "single object pooled");
+  node_t* array = allocator.allocate (4);
+  expect (array != nullptr && pool.stats ().live_objects == 1
+              && heap.calls (server_function::malloc) == 2,
+          "array from the server");
+  allocator.deallocate (array, 4);
+  allocator.deallocate (n, 1);
+  expect (pool.stats ().live_objects == 0
+              && heap.calls (server_function::free) == 1,
+          "deallocated");
+
+  // Standard containers rebind the allocator to their node type.
+  {
+    std::list<uint32_t, pool_allocator<uint32_t, rtos_plugin_server_api_t>> l
+      { pool_allocator<uint32_t, rtos_plugin_server_api_t> (&pool,
+          heap_target::api ()) };
+    for (uint32_t i = 0; i < 20; ++i)
+      {
+        l.push_back (i);
+      }
+    expect (pool.stats ().live_objects == 20 && pool.stats ().slabs == 3,
+            "list nodes pooled");
+    l.clear ();
+    expect (pool.stats ().live_objects == 0, "list nodes freed");
+  }
+
+  pool_t another
+    { heap_target::api (), 64 };
+  pool_allocator<uint8_t, rtos_plugin_server_api_t> rebound
+    { allocator };
+  expect (rebound == allocator && rebound.get_api () == heap_target::api ()
+              && allocator != allocator_t (&another, heap_target::api ()),
+          "allocator equality");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+
+  check_slots (heap);
+  check_release (heap);
+  check_allocator (heap);
+  expect (heap.blocks == 0, "no leaks");
+
+  printf ("pool: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `backend::read_batch()`, over the simulated target,
+ * counting the transactions seen by the server.
+ *
+ * Ranges closer than the batch gap must be read together, up to
+ * `batch_max_span_bytes`, whatever the order of the requests and
+ * even if they overlap. If a merged read fails, because the gap
+ * is not readable, each range must be read on its own.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+using request_t = backend_t::read_request_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 4096;
+// A second region, after a hole of 16 bytes.
+static constexpr target_addr_t next_base = ram_base + ram_size_bytes + 16;
+static constexpr std::size_t next_size_bytes = 256;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+/**
+ * @brief Check that a buffer holds the image bytes of an address.
+ */
+static bool
+holds (const uint8_t* out, target_addr_t addr, std::size_t bytes)
+{
+  for (std::size_t i = 0; i < bytes; ++i)
+    {
+      if (out[i] != static_cast<uint8_t> ((addr + i) * 7))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+static void
+check_gap (simulated_target& target, backend_t& backend)
+{
+  uint8_t a[8];
+  uint8_t b[8];
+  uint8_t c[8];
+
+  // 16 bytes apart, within the default gap of 32.
+  request_t requests[] =
+    {
+      { ram_base, sizeof(a), a },
+      { ram_base + 24, sizeof(b), b },
+      // Far apart.
+      { ram_base + 1024, sizeof(c), c } };
+  target.clear_stats ();
+  expect (backend.read_batch (requests, 3) == 0, "read");
+  expect (target.transactions () == 2, "close ranges merged");
+  expect (holds (a, ram_base, 8) && holds (b, ram_base + 24, 8)
+              && holds (c, ram_base + 1024, 8),
+          "merged data");
+
+  // Without gap, touching ranges are still merged.
+  backend.set_batch_gap (0);
+  request_t touching[] =
+    {
+      { ram_base, sizeof(a), a },
+      { ram_base + 8, sizeof(b), b },
+      { ram_base + 17, sizeof(c), c } };
+  target.clear_stats ();
+  expect (backend.read_batch (touching, 3) == 0
+              && target.transactions () == 2,
+          "no gap");
+  expect (holds (b, ram_base + 8, 8) && holds (c, ram_base + 17, 8),
+          "no gap data");
+  backend.set_batch_gap (32);
+}
+
+static void
+check_span (simulated_target& target, backend_t& backend)
+{
+  // Three contiguous ranges of 400 bytes; the third would make the
+  // span larger than batch_max_span_bytes.
+  static uint8_t out[3][400];
+  request_t requests[3];
+  for (std::size_t i = 0; i < 3; ++i)
+    {
+      requests[i] =
+        { static_cast<target_addr_t> (ram_base + 400 * i), 400, out[i] };
+    }
+  static_assert(2 * 400 <= backend_t::batch_max_span_bytes
+                    && 3 * 400 > backend_t::batch_max_span_bytes,
+                "span sizes");
+
+  target.clear_stats ();
+  expect (backend.read_batch (requests, 3) == 0, "span read");
+  expect (target.transactions () == 2, "span limited");
+  for (std::size_t i = 0; i < 3; ++i)
+    {
+      expect (holds (out[i], static_cast<target_addr_t> (ram_base + 400 * i),
+                     400),
+              "span data");
+    }
+}
+
+static void
+check_order (simulated_target& target, backend_t& backend)
+{
+  uint8_t a[32];
+  uint8_t b[8];
+  uint8_t c[16];
+
+  // Unsorted, with b inside a and c overlapping its end.
+  request_t requests[] =
+    {
+      { ram_base + 2040, sizeof(c), c },
+      { ram_base + 2008, sizeof(b), b },
+      { ram_base + 2000, sizeof(a), a } };
+  target.clear_stats ();
+  expect (backend.read_batch (requests, 3) == 0, "unsorted read");
+  expect (target.transactions () == 1, "unsorted ranges merged");
+  expect (holds (a, ram_base + 2000, 32) && holds (b, ram_base + 2008, 8)
+              && holds (c, ram_base + 2040, 16),
+          "unsorted data");
+  expect (requests[0].addr == ram_base + 2000
+              && requests[2].addr == ram_base + 2040,
+          "requests sorted in place");
+
+  expect (backend.read_batch (requests, 0) == 0, "no requests");
+}
+
+static void
+check_fallback (simulated_target& target, backend_t& backend)
+{
+  uint8_t a[8];
+  uint8_t b[8];
+
+  // The hole between the regions cannot be read.
+  request_t requests[] =
+    {
+      { next_base, sizeof(b), b },
+      { ram_base + ram_size_bytes - 8, sizeof(a), a } };
+  target.clear_stats ();
+  expect (backend.read_batch (requests, 2) == 0, "fallback read");
+  expect (target.transactions () == 3, "merged read, then each range");
+  expect (holds (a, ram_base + ram_size_bytes - 8, 8)
+              && holds (b, next_base, 8),
+          "fallback data");
+
+  // One range not readable; the other is still read.
+  std::memset (a, 0, sizeof(a));
+  request_t bad[] =
+    {
+      { ram_base + ram_size_bytes + 4, sizeof(b), b },
+      { ram_base + ram_size_bytes - 8, sizeof(a), a } };
+  expect (backend.read_batch (bad, 2) < 0, "failure reported");
+  expect (holds (a, ram_base + ram_size_bytes - 8, 8),
+          "other range still read");
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  uint8_t* image = target.add_region (ram_base, ram_size_bytes);
+  for (std::size_t i = 0; i < ram_size_bytes; ++i)
+    {
+      image[i] = static_cast<uint8_t> ((ram_base + i) * 7);
+    }
+  image = target.add_region (next_base, next_size_bytes);
+  for (std::size_t i = 0; i < next_size_bytes; ++i)
+    {
+      image[i] = static_cast<uint8_t> ((next_base + i) * 7);
+    }
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+
+  check_gap (target, backend);
+  check_span (target, backend);
+  check_order (target, backend);
+  check_fallback (target, backend);
+
+  printf ("read-batch: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
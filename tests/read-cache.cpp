@@ -0,0 +1,214 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the backend read cache, over the simulated target,
+ * counting the transactions seen by the server.
+ *
+ * Small reads must be served by one line fill, then hits; reads
+ * larger than a line must bypass the cache; writes must drop the
+ * lines they cover, and `invalidate_cache()` must drop all lines.
+ * Ranges at the top of the address space must not wrap to 0.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 4096;
+static constexpr target_addr_t top_base = 0xFFFFFF00;
+static constexpr std::size_t line_size_bytes = 64;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static bool
+stats_are (backend_t& backend, std::size_t hits, std::size_t misses,
+           std::size_t bypasses)
+{
+  const backend_t::cache_stats_t& stats = backend.cache_stats ();
+  return stats.hits == hits && stats.misses == misses
+      && stats.bypasses == bypasses;
+}
+
+static void
+check_hits (simulated_target& target, backend_t& backend)
+{
+  uint32_t value;
+  target.clear_stats ();
+
+  expect (backend.read_long (ram_base + 8, &value) == 0
+              && value == 0x0B0A0908,
+          "first read");
+  expect (stats_are (backend, 0, 1, 0) && target.transactions () == 1,
+          "first read fills a line");
+
+  uint8_t bytes[16];
+  expect (backend.read_long (ram_base + 12, &value) == 0
+              && backend.read_byte_array (ram_base + 32, bytes, 16) == 0
+              && bytes[0] == 32,
+          "reads in the line");
+  expect (stats_are (backend, 2, 1, 0) && target.transactions () == 1,
+          "reads in the line are hits");
+
+  // Across two lines: one hit, one miss.
+  expect (backend.read_byte_array (ram_base + 60, bytes, 8) == 0
+              && bytes[0] == 60 && bytes[7] == 67,
+          "read across lines");
+  expect (stats_are (backend, 3, 2, 0) && target.transactions () == 2,
+          "read across lines fills one line");
+
+  // Larger than a line.
+  uint8_t big[2 * line_size_bytes];
+  expect (backend.read_byte_array (ram_base + 256, big, sizeof(big)) == 0
+              && big[0] == 0 && big[127] == 127,
+          "large read");
+  expect (stats_are (backend, 3, 2, 1) && target.transactions () == 3,
+          "large read bypasses the cache");
+}
+
+static void
+check_writes (simulated_target& target, uint8_t* image, backend_t& backend)
+{
+  uint32_t value;
+  backend.read_long (ram_base + 512, &value);
+  backend.read_long (ram_base + 512 + line_size_bytes, &value);
+  target.clear_stats ();
+
+  // Covers the end of the first line and the next one.
+  const uint8_t data[8] =
+    { 1, 2, 3, 4, 5, 6, 7, 8 };
+  backend.write_byte_array (ram_base + 512 + line_size_bytes - 4, data, 8);
+  target.clear_stats ();
+
+  expect (backend.read_long (ram_base + 512 + line_size_bytes - 4, &value)
+              == 0 && value == 0x04030201,
+          "written data read back");
+  expect (backend.read_long (ram_base + 512 + line_size_bytes, &value) == 0
+              && value == 0x08070605,
+          "written data in the next line");
+  expect (target.transactions () == 2, "written lines read again");
+
+  // Changed behind the cache; seen only after invalidation.
+  image[1024] = 0xAA;
+  backend.read_long (ram_base + 1024, &value);
+  image[1024] = 0xBB;
+  target.clear_stats ();
+  backend.read_long (ram_base + 1024, &value);
+  expect ((value & 0xFF) == 0xAA && target.transactions () == 0,
+          "stale until invalidated");
+
+  std::size_t misses = backend.cache_stats ().misses;
+  backend.invalidate_cache ();
+  expect (target.transactions () == 0, "invalidation reads nothing");
+  backend.read_long (ram_base + 1024, &value);
+  expect ((value & 0xFF) == 0xBB && target.transactions () == 1
+              && backend.cache_stats ().misses == misses + 1,
+          "invalidation drops the lines");
+}
+
+static void
+check_top (simulated_target& target, backend_t& backend)
+{
+  uint32_t value;
+  target.clear_stats ();
+
+  expect (backend.read_long (0xFFFFFFFC, &value) == 0, "read at the top");
+  expect (target.transactions () == 1, "top line filled");
+
+  // Past the end of the address space; must not read line 0.
+  uint8_t bytes[16];
+  std::size_t bypasses = backend.cache_stats ().bypasses;
+  backend.read_byte_array (0xFFFFFFF8, bytes, sizeof(bytes));
+  expect (backend.cache_stats ().bypasses == bypasses + 1
+              && target.transactions () == 2,
+          "read past the top bypasses the cache");
+
+  // Must stop at the top line, not loop through the address space.
+  const uint8_t data[8] =
+    { };
+  backend.write_byte_array (0xFFFFFFFC, data, sizeof(data));
+  target.clear_stats ();
+  expect (backend.read_long (0xFFFFFFFC, &value) == 0
+              && target.transactions () == 1,
+          "write past the top drops the top line");
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  uint8_t* image = target.add_region (ram_base, ram_size_bytes);
+  for (std::size_t i = 0; i < ram_size_bytes; ++i)
+    {
+      image[i] = static_cast<uint8_t> (i);
+    }
+  target.add_region (top_base, 256);
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+  expect (backend.enable_cache (line_size_bytes, 16) == 0, "enable cache");
+
+  check_hits (target, backend);
+  check_writes (target, image, backend);
+  check_top (target, backend);
+
+  printf ("read-cache: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `register_cache`, over the simulated target.
+ *
+ * Contexts must be filled lazily, once per thread and update,
+ * refilled after `invalidate()`, and failed fills retried. The
+ * hex encoding must follow the byte order of the backend, and
+ * `get_reg()` must take GDB register numbers, like xPSR = 25.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-register-cache.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using cache_t = register_cache<rtos_plugin_server_api_t>;
+using thread_id_t = rtos_plugin_thread_id_t;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static rtos_plugin_symbols_t symbols[] =
+  {
+    { nullptr, 0, 0 } };
+
+/**
+ * @brief Fill callable, storing R<n> = id << 8 | n, and counting
+ *  the calls; fills of the thread `failing` fail.
+ */
+struct filler
+{
+  std::size_t calls;
+  thread_id_t failing;
+
+  int
+  operator() (thread_id_t id, uint32_t* values)
+  {
+    ++calls;
+    if (id == failing)
+      {
+        return -1;
+      }
+    for (std::size_t i = 0; i < cache_t::registers; ++i)
+      {
+        values[i] = (id << 8) | static_cast<uint32_t> (i);
+      }
+    return 0;
+  }
+};
+
+static void
+check_fill (void)
+{
+  simulated_target target;
+  backend_t backend
+    { simulated_target::api (), symbols };
+  cache_t cache
+    { backend };
+  filler fill
+    { 0, 0 };
+  auto f = [&fill](thread_id_t id, uint32_t* values)
+    {
+      return fill (id, values);
+    };
+
+  expect (fill.calls == 0, "nothing filled at construction");
+
+  char list[8 * cache_t::registers + 1];
+  expect (cache.get_reg_list (7, list, f) == 0, "list");
+  expect (fill.calls == 1, "filled on first request");
+  expect (std::strncmp (list, "00070000", 8) == 0
+              && std::strncmp (list + 8 * 16, "10070000", 8) == 0
+              && list[8 * cache_t::registers] == '\0',
+          "little endian list");
+
+  // The same halt; no more fills.
+  char reg[9];
+  expect (cache.get_reg (7, 15, reg, f) == 0
+              && std::strcmp (reg, "0f070000") == 0,
+          "pc");
+  expect (cache.get_reg (7, 25, reg, f) == 0
+              && std::strcmp (reg, "10070000") == 0,
+          "xpsr by gdb number");
+  expect (fill.calls == 1 && cache.stats ().hits == 2, "one fill per halt");
+
+  // Not in the thread context.
+  expect (cache.get_reg (7, 16, reg, f) < 0, "fpa register");
+  expect (cache.get_reg (7, 24, reg, f) < 0, "fps register");
+  expect (cache.get_reg (7, 26, reg, f) < 0, "past xpsr");
+
+  // Each thread once, beyond the initial capacity.
+  for (thread_id_t id = 100; id < 140; ++id)
+    {
+      cache.get (id, f);
+      cache.get (id, f);
+    }
+  expect (fill.calls == 41, "many threads");
+  const cache_t::context_t* context = cache.get (7, f);
+  expect (context != nullptr && context->values[3] == 0x0703,
+          "kept after growth");
+
+  // A new halt.
+  cache.invalidate ();
+  expect (cache.get_reg (7, 0, reg, f) == 0 && fill.calls == 42,
+          "filled again after invalidate");
+
+  // Failed fills are not cached.
+  fill.failing = 9;
+  expect (cache.get_reg_list (9, list, f) < 0, "fill failure");
+  expect (cache.get_reg (9, 0, reg, f) < 0 && fill.calls == 44,
+          "failed fill retried");
+  fill.failing = 0;
+  expect (cache.get_reg (9, 1, reg, f) == 0
+              && std::strcmp (reg, "01090000") == 0,
+          "filled after failures");
+  expect (cache.stats ().fill_errors == 2, "fill errors");
+}
+
+static void
+check_big_endian (void)
+{
+  simulated_target target
+    { false };
+  backend_t backend
+    { simulated_target::api (), symbols };
+  expect (!backend.is_target_little_endian (), "big endian target");
+
+  cache_t cache
+    { backend };
+  filler fill
+    { 0, 0 };
+  auto f = [&fill](thread_id_t id, uint32_t* values)
+    {
+      return fill (id, values);
+    };
+
+  char reg[9];
+  expect (cache.get_reg (0x12, 2, reg, f) == 0
+              && std::strcmp (reg, "00001202") == 0,
+          "big endian register");
+}
+
+int
+main (void)
+{
+  check_fill ();
+  check_big_endian ();
+
+  printf ("register-cache: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the `server_adapter` instance chain.
+ *
+ * The C API table must always forward to a live instance:
+ * the last constructed, the one activated, or, after the active
+ * one is destroyed, the one constructed before it, whatever the
+ * order of destruction.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+
+using namespace segger::drtm;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+/**
+ * @brief Read the first byte of a target through the C API table;
+ *  each target holds its own marker there.
+ */
+static int
+active_marker (void)
+{
+  uint8_t value = 0;
+  if (simulated_target::api ()->read_byte (0x20000000, &value) < 0)
+    {
+      return -1;
+    }
+  return value;
+}
+
+static simulated_target*
+make_target (uint8_t marker)
+{
+  simulated_target* target = new simulated_target;
+  target->add_region (0x20000000, 16)[0] = marker;
+  return target;
+}
+
+int
+main (void)
+{
+  simulated_target* a = make_target (1);
+  {
+    simulated_target* b = make_target (2);
+    expect (active_marker () == 2, "last constructed");
+
+    // Nested lifetimes.
+    delete b;
+    expect (active_marker () == 1, "enclosing restored");
+  }
+
+  // The active one destroyed first, not in LIFO order.
+  simulated_target* b = make_target (2);
+  simulated_target* c = make_target (3);
+  delete c;
+  expect (active_marker () == 2, "previous restored");
+
+  // An inactive one in the middle of the chain.
+  c = make_target (3);
+  delete b;
+  expect (active_marker () == 3, "active kept");
+  delete c;
+  expect (active_marker () == 1, "unlinked from the chain");
+
+  // The first one destroyed while active, with a newer one alive.
+  b = make_target (2);
+  a->activate ();
+  delete a;
+  expect (active_marker () == 2, "newer one activated");
+  delete b;
+
+  a = make_target (1);
+  expect (active_marker () == 1, "new chain");
+  delete a;
+
+  printf ("server-adapter: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
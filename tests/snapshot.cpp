@@ -0,0 +1,220 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `snapshot`, over the simulated target.
+ *
+ * Known objects must be read whole again only when their
+ * fingerprint changed; new objects always. When the batch of
+ * whole objects fails, the objects must be read one by one, so
+ * only those that cannot be read are marked not valid, and are
+ * read whole by the next update.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-snapshot.h>
+
+#include <cstdint>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 1024;
+
+struct tcb_layout : struct_layout<32>
+{
+  using value = field<uint32_t, 0>;
+  // Changes whenever the object does.
+  using generation = byte_field<4, 4>;
+};
+
+using snapshot_t = snapshot<backend_t, tcb_layout, tcb_layout::generation>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static uint8_t* image;
+
+static target_addr_t
+tcb (std::size_t i)
+{
+  return static_cast<target_addr_t> (ram_base + 128 * i);
+}
+
+static void
+set_tcb (std::size_t i, uint32_t value, uint32_t generation)
+{
+  little_endian_codec::store (image + (tcb (i) - ram_base), value);
+  little_endian_codec::store (image + (tcb (i) - ram_base) + 4, generation);
+}
+
+static uint32_t
+value (const snapshot_t& s, std::size_t index)
+{
+  return s.object (index).get<tcb_layout::value> ();
+}
+
+static void
+check_changes (backend_t& backend)
+{
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      set_tcb (i, static_cast<uint32_t> (100 + i), 1);
+    }
+
+  snapshot_t s
+    { backend };
+  // Not sorted.
+  target_addr_t addrs[] =
+    { tcb (2), tcb (0), tcb (3), tcb (1) };
+
+  expect (s.update (addrs, 4) == 0 && s.size () == 4, "first update");
+  expect (s.stats ().refetched == 4, "all new");
+  bool ok = true;
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      ok = ok && s.is_valid (i) && s.is_changed (i)
+          && s.address (i) == addrs[i]
+          && value (s, i) == 100 + (addrs[i] - ram_base) / 128;
+    }
+  expect (ok, "first contents");
+
+  s.clear_stats ();
+  expect (s.update (addrs, 4) == 0, "unchanged update");
+  expect (s.stats ().refetched == 0
+              && s.stats ().fingerprint_bytes == 4 * 4,
+          "only fingerprints read");
+  expect (!s.is_changed (0) && value (s, 0) == 102, "kept");
+
+  // A change without a new fingerprint is not seen, by design;
+  // a new fingerprint is.
+  set_tcb (3, 999, 1);
+  set_tcb (1, 555, 2);
+  s.clear_stats ();
+  expect (s.update (addrs, 4) == 0 && s.stats ().refetched == 1,
+          "one changed");
+  expect (s.is_changed (3) && value (s, 3) == 555, "changed object read");
+  expect (!s.is_changed (2) && value (s, 2) == 103, "stale by design");
+
+  // One object gone, one new.
+  set_tcb (4, 104, 1);
+  target_addr_t next[] =
+    { tcb (0), tcb (4), tcb (1) };
+  s.clear_stats ();
+  expect (s.update (next, 3) == 0 && s.size () == 3, "set changed");
+  expect (!s.is_changed (0) && s.is_changed (1) && !s.is_changed (2)
+              && s.stats ().refetched == 1,
+          "only the new object read");
+  expect (value (s, 1) == 104 && value (s, 2) == 555, "set contents");
+
+  // Forgotten, for example after writes.
+  s.invalidate ();
+  s.clear_stats ();
+  expect (s.update (next, 3) == 0 && s.stats ().refetched == 3,
+          "all read after invalidate");
+}
+
+static void
+check_failures (backend_t& backend)
+{
+  for (std::size_t i = 0; i < 3; ++i)
+    {
+      set_tcb (i, static_cast<uint32_t> (200 + i), 1);
+    }
+
+  snapshot_t s
+    { backend };
+  // The last one straddles the end of the region.
+  const target_addr_t bad = ram_base + ram_size_bytes - 16;
+  target_addr_t addrs[] =
+    { tcb (0), tcb (1), bad, tcb (2) };
+
+  expect (s.update (addrs, 4) < 0, "failure reported");
+  expect (s.is_valid (0) && s.is_valid (1) && !s.is_valid (2)
+              && s.is_valid (3),
+          "only the bad object not valid");
+  expect (value (s, 0) == 200 && value (s, 1) == 201 && value (s, 3) == 202,
+          "good objects read");
+
+  // The good ones are known; the bad one is read whole again.
+  s.clear_stats ();
+  expect (s.update (addrs, 4) < 0, "failure reported again");
+  expect (!s.is_changed (0) && !s.is_changed (1) && s.is_changed (2)
+              && !s.is_valid (2),
+          "bad object retried");
+
+  // Without it, everything is fine again.
+  target_addr_t good[] =
+    { tcb (0), tcb (1), tcb (2) };
+  s.clear_stats ();
+  expect (s.update (good, 3) == 0 && s.stats ().refetched == 0,
+          "recovered");
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  image = target.add_region (ram_base, ram_size_bytes);
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+
+  check_changes (backend);
+  check_failures (backend);
+
+  printf ("snapshot: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+
+
+/*
+ * Checks of the stack high-water mark scanner, over the simulated
+ * target, against a reference word by word scan.
+ *
+ * Stacks of random sizes and usages, including all fill and fully
+ * used stacks, are scanned in both modes, with small and default
+ * chunks, then grown, to exercise the cached paths of the bisect
+ * mode. A word written deep below the previous mark, past a window
+ * of fill, must still be found in linear mode, which does not cache.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-stack-scanner.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr uint32_t fill = 0xDEADBEEF;
+static constexpr target_addr_t stack_base = 0x20000000;
+static constexpr std::size_t max_stack_bytes = 8192;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what, std::size_t size_bytes,
+        std::size_t expected, std::size_t actual)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s, stack %zu bytes, expected %zu, got %zu\n", what,
+              size_bytes, expected, actual);
+      ++failures;
+    }
+}
+
+static uint32_t
+next_value (uint64_t& seed)
+{
+  seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+  return static_cast<uint32_t> (seed >> 32);
+}
+
+/**
+ * @brief The used bytes, from the first word that is not fill.
+ */
+static std::size_t
+reference_used (const uint8_t* stack, std::size_t size_bytes)
+{
+  for (std::size_t i = 0; i + 4 <= size_bytes; i += 4)
+    {
+      if (little_endian_codec::load_long (stack + i) != fill)
+        {
+          return size_bytes - i;
+        }
+    }
+  return 0;
+}
+
+/**
+ * @brief Fill the stack, then write random words from `mark` up;
+ *  the word at `mark` is never fill.
+ */
+static void
+paint (uint8_t* stack, std::size_t size_bytes, std::size_t mark,
+       uint64_t& seed)
+{
+  for (std::size_t i = 0; i + 4 <= size_bytes; i += 4)
+    {
+      uint32_t w = fill;
+      if (i >= mark)
+        {
+          // Some used words happen to hold the fill value.
+          w = (i != mark && next_value (seed) % 8 == 0) ?
+              fill : next_value (seed) | 1;
+        }
+      little_endian_codec::store (stack + i, w);
+    }
+}
+
+static void
+check_stack (backend_t& backend, uint8_t* image, std::size_t size_bytes,
+             std::size_t mark, std::size_t chunk_size_bytes,
+             uint64_t& seed)
+{
+  paint (image, size_bytes, mark, seed);
+  std::size_t expected = reference_used (image, size_bytes);
+
+  const stack_scan_mode modes[] =
+    { stack_scan_mode::linear, stack_scan_mode::bisect };
+  for (stack_scan_mode mode : modes)
+    {
+      const char* name = (mode == stack_scan_mode::linear) ?
+          "linear" : "bisect";
+
+      stack_scanner<backend_t> scanner
+        { backend, fill, true, chunk_size_bytes };
+      scanner.set_mode (mode);
+
+      std::size_t used = 0;
+      int ret = scanner.scan (stack_base, size_bytes, &used);
+      expect (ret == 0 && used == expected, name, size_bytes, expected, used);
+
+      ret = scanner.high_water_mark (1, stack_base, size_bytes, 0, &used);
+      expect (ret == 0 && used == expected, name, size_bytes, expected, used);
+
+      // Unchanged; served from the cache.
+      ret = scanner.high_water_mark (1, stack_base, size_bytes, 0, &used);
+      expect (ret == 0 && used == expected, "cached", size_bytes, expected,
+              used);
+
+      // The stack grows contiguously below the mark.
+      std::size_t old_mark = size_bytes - expected;
+      if (old_mark >= 4)
+        {
+          std::size_t grown = (next_value (seed) % (old_mark / 4)) * 4;
+          for (std::size_t i = grown; i < old_mark; i += 4)
+            {
+              little_endian_codec::store (image + i, next_value (seed) | 1);
+            }
+          std::size_t expected_grown = size_bytes - grown;
+          ret = scanner.high_water_mark (1, stack_base, size_bytes, 0, &used);
+          expect (ret == 0 && used == expected_grown, "cached grow",
+                  size_bytes, expected_grown, used);
+          paint (image, size_bytes, mark, seed);
+        }
+
+      // A word deep below the mark, past a window of fill, as left
+      // by a local array not fully written; only linear is exact.
+      if (mode == stack_scan_mode::linear && old_mark >= 128)
+        {
+          scanner.invalidate ();
+          scanner.high_water_mark (1, stack_base, size_bytes, 0, &used);
+
+          std::size_t deep = (next_value (seed) % ((old_mark - 64) / 4)) * 4;
+          little_endian_codec::store (image + deep, 0u);
+          std::size_t expected_deep = size_bytes - deep;
+          ret = scanner.high_water_mark (1, stack_base, size_bytes, 0, &used);
+          expect (ret == 0 && used == expected_deep, "linear hole",
+                  size_bytes, expected_deep, used);
+          paint (image, size_bytes, mark, seed);
+        }
+
+      if (mode == stack_scan_mode::linear)
+        {
+          std::size_t cached = scanner.stats ().cache_hits
+              + scanner.stats ().partial_scans;
+          expect (cached == 0, "linear not cached", size_bytes, 0, cached);
+        }
+    }
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  uint8_t* image = target.add_region (stack_base, max_stack_bytes);
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+
+  uint64_t seed = 1;
+  const std::size_t chunks[] =
+    { 64, stack_scanner<backend_t>::default_chunk_size_bytes };
+  for (std::size_t chunk_size_bytes : chunks)
+    {
+      for (std::size_t k = 0; k < 300; ++k)
+        {
+          std::size_t size_bytes = (1 + next_value (seed)
+              % (max_stack_bytes / 4)) * 4;
+          std::size_t words = size_bytes / 4;
+
+          // All fill, fully used, then random usages.
+          std::size_t mark;
+          if (k == 0)
+            {
+              mark = size_bytes;
+            }
+          else if (k == 1)
+            {
+              mark = 0;
+            }
+          else
+            {
+              mark = (next_value (seed) % (words + 1)) * 4;
+            }
+          check_stack (backend, image, size_bytes, mark, chunk_size_bytes,
+                       seed);
+        }
+    }
+
+  printf ("stack-scanner: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `target_struct` and `backend::read_struct()`, over
+ * the simulated target.
+ *
+ * A structure must be fetched with a single transaction, and its
+ * fields decoded at their offsets, signed or unsigned, with the
+ * byte order of the target, chosen at run time.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-struct.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr target_addr_t tcb_addr = ram_base + 0x40;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static rtos_plugin_symbols_t symbols[] =
+  {
+    { nullptr, 0, 0 } };
+
+struct tcb_layout : struct_layout<32>
+{
+  using state = field<uint8_t, 0>;
+  using delta = field<int16_t, 2>;
+  using next = field<uint32_t, 4>;
+  using ticks = field<uint64_t, 8>;
+  using offset = field<int32_t, 16>;
+  using name = byte_field<20, 8>;
+  // The last byte of the layout.
+  using flags = field<uint8_t, 31>;
+};
+
+/**
+ * @brief Store a value in a byte order.
+ */
+static void
+store (uint8_t* p, uint64_t value, std::size_t bytes, bool little_endian)
+{
+  for (std::size_t i = 0; i < bytes; ++i)
+    {
+      std::size_t shift = little_endian ? i : bytes - 1 - i;
+      p[i] = static_cast<uint8_t> (value >> (8 * shift));
+    }
+}
+
+/**
+ * @brief Build the image of a structure in a byte order.
+ */
+static void
+make_tcb (uint8_t* p, bool little_endian)
+{
+  std::memset (p, 0xEE, tcb_layout::size_bytes);
+  store (p + 0, 3, 1, little_endian);
+  store (p + 2, static_cast<uint16_t> (-2), 2, little_endian);
+  store (p + 4, 0x20001234, 4, little_endian);
+  store (p + 8, 0x0102030405060708ull, 8, little_endian);
+  store (p + 16, static_cast<uint32_t> (-100000), 4, little_endian);
+  std::memcpy (p + 20, "IDLE\0\0\0\0", 8);
+  store (p + 31, 0x81, 1, little_endian);
+}
+
+static bool
+has_fields (const target_struct<tcb_layout>& tcb)
+{
+  return tcb.get<tcb_layout::state> () == 3
+      && tcb.get<tcb_layout::delta> () == -2
+      && tcb.get<tcb_layout::next> () == 0x20001234
+      && tcb.get<tcb_layout::ticks> () == 0x0102030405060708ull
+      && tcb.get<tcb_layout::offset> () == -100000
+      && std::memcmp (tcb.bytes<tcb_layout::name> (), "IDLE", 5) == 0
+      && tcb.get<tcb_layout::flags> () == 0x81;
+}
+
+static void
+check_read (bool little_endian)
+{
+  simulated_target target
+    { little_endian };
+  uint8_t* image = target.add_region (ram_base, 256);
+  make_tcb (image + (tcb_addr - ram_base), little_endian);
+
+  backend_t backend
+    { simulated_target::api (), symbols };
+  expect (backend.is_target_little_endian () == little_endian,
+          "target byte order");
+
+  target_struct<tcb_layout> tcb;
+  // The byte order set by read_struct(), whatever it was.
+  tcb.set_little_endian (!little_endian);
+  target.clear_stats ();
+  expect (backend.read_struct (tcb_addr, tcb) == 0, "read");
+  expect (target.transactions () == 1
+              && target.stats ().bytes_read == tcb_layout::size_bytes,
+          "one transaction");
+  expect (has_fields (tcb),
+          little_endian ? "little endian fields" : "big endian fields");
+
+  // A copy keeps the byte order.
+  target_struct<tcb_layout> copy = tcb;
+  expect (has_fields (copy), "copy");
+
+  expect (backend.read_struct (ram_base + 240, tcb) < 0,
+          "read past the region fails");
+}
+
+static void
+check_local (void)
+{
+  static_assert(target_struct<tcb_layout>::size_bytes == 32, "size");
+  static_assert(tcb_layout::ticks::offset == 8
+                    && tcb_layout::ticks::width == 8,
+                "offset and width");
+
+  // Decoded from local bytes, without a backend.
+  target_struct<tcb_layout> tcb;
+  make_tcb (tcb.data (), false);
+  tcb.set_little_endian (false);
+  expect (has_fields (tcb), "big endian local");
+
+  tcb.set_little_endian (true);
+  expect (tcb.get<tcb_layout::next> () == 0x34120020
+              && tcb.get<tcb_layout::delta> () == -257,
+          "same bytes, other order");
+}
+
+int
+main (void)
+{
+  check_read (true);
+  check_read (false);
+  check_local ();
+
+  printf ("struct: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
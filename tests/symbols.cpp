@@ -0,0 +1,208 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the backend symbols lookups.
+ *
+ * Names sharing a bucket, or even the whole hash, must each find
+ * their own address, including the last entry of the table and
+ * probes wrapping past the end of the index. When the index
+ * cannot be allocated, lookups must fall back to a scan with the
+ * same results. Indices computed at compile time must match the
+ * table.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+
+#include "heap-target.h"
+
+#include <cstdint>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+// With 10 symbols the index has 32 slots.
+static constexpr const char* names[] =
+  {
+    // Same 32-bits FNV-1a hash, 0x76a0a70b.
+    "sym122789", "sym339192",
+    // All in the last bucket, so the probes wrap.
+    "OS2", "OS17", "OS66",
+    //
+    "pxCurrentTCB", "uxTopReadyPriority", "xTickCount", "xSuspendedTaskList",
+    // The last entry.
+    "xDelayedTaskList1" };
+
+static constexpr std::size_t symbols_count = sizeof(names) / sizeof(names[0]);
+
+static rtos_plugin_symbols_t symbols[symbols_count + 1];
+
+static void
+fill_symbols (void)
+{
+  for (std::size_t i = 0; i < symbols_count; ++i)
+    {
+      symbols[i] =
+        { names[i], 0, static_cast<rtos_plugin_target_addr_t> (0x20000000
+            + 0x100 * i) };
+    }
+  symbols[symbols_count] =
+    { nullptr, 0, 0 };
+}
+
+static bool
+all_found (backend_t& backend)
+{
+  bool ok = true;
+  for (std::size_t i = 0; i < symbols_count; ++i)
+    {
+      ok = ok
+          && (backend.get_symbol_address (names[i])
+              == 0x20000000 + 0x100 * i);
+    }
+  return ok;
+}
+
+static void
+check_index (heap_target& heap)
+{
+  static_assert(symbol_hash ("sym122789") == symbol_hash ("sym339192"),
+                "full hash collision");
+  static_assert((symbol_hash ("OS2") & 31) == 31
+                    && (symbol_hash ("OS17") & 31) == 31
+                    && (symbol_hash ("OS66") & 31) == 31,
+                "last bucket");
+
+  backend_t backend
+    { heap_target::api (), symbols };
+  heap.clear_stats ();
+
+  expect (all_found (backend), "all found with the index");
+  expect (heap.calls (server_function::malloc) == 1, "index built once");
+  expect (backend.get_symbol_address ("xDelayedTaskList1")
+              == 0x20000000 + 0x100 * (symbols_count - 1),
+          "last entry");
+  expect (backend.get_symbol_address ("sym339192") == 0x20000100,
+          "second of the same hash");
+  expect (backend.get_symbol_address ("missing") == 0
+              && backend.get_symbol_address ("") == 0
+              && backend.get_symbol_address ("OS") == 0
+              && backend.get_symbol_address ("xDelayedTaskList") == 0,
+          "missing names");
+  expect (heap.calls (server_function::malloc) == 1, "no more mallocs");
+}
+
+static void
+check_fallback (heap_target& heap)
+{
+  backend_t backend
+    { heap_target::api (), symbols };
+
+  heap.malloc_fails = true;
+  expect (all_found (backend), "all found by the scan");
+  expect (backend.get_symbol_address ("sym339192") == 0x20000100,
+          "same hash by the scan");
+  expect (backend.get_symbol_address ("missing") == 0,
+          "missing by the scan");
+
+  // The index is built at the next lookup.
+  heap.malloc_fails = false;
+  heap.clear_stats ();
+  expect (all_found (backend) && heap.calls (server_function::malloc) == 1,
+          "index built after failures");
+}
+
+static void
+check_compile_time (void)
+{
+  backend_t backend
+    { heap_target::api (), symbols };
+
+  constexpr std::size_t last = symbol_index (names, "xDelayedTaskList1");
+  constexpr std::size_t second = symbol_index (names, "sym339192");
+  static_assert(last == symbols_count - 1 && second == 1, "indices");
+
+  expect (backend.get_symbol_address<last> ()
+              == 0x20000000 + 0x100 * (symbols_count - 1),
+          "last by index");
+  expect (backend.get_symbol_address<second> () == 0x20000100,
+          "same hash by index");
+  expect (symbol_index (names, "missing") == symbols_count,
+          "not found at run time");
+}
+
+static void
+check_empty (void)
+{
+  static rtos_plugin_symbols_t none[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { heap_target::api (), none };
+  expect (backend.get_symbol_address ("anything") == 0, "empty table");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+  fill_symbols ();
+
+  check_index (heap);
+  check_fallback (heap);
+  check_compile_time ();
+  check_empty ();
+  expect (heap.blocks == 0, "no leaks");
+
+  printf ("symbols: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
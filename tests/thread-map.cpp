@@ -0,0 +1,240 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of `thread_map`, over a server adapter whose `malloc()`
+ * can fail.
+ *
+ * IDs that hash to the same slot, including the last one, must
+ * all be found; `clear()` must forget all entries without server
+ * calls; the table must double when the load factor would pass
+ * 1/2, keeping the entries; missing IDs must not be found.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-memory.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-thread-map.h>
+
+#include "heap-target.h"
+
+#include <cstdint>
+
+using namespace segger::drtm;
+
+using map_t = thread_map<allocator<thread_map_slot, rtos_plugin_server_api_t>>;
+
+using thread_id_t = rtos_plugin_thread_id_t;
+
+// With the initial 32 slots, all hash to the last slot.
+static constexpr thread_id_t last_slot_ids[] =
+  { 0x200002e0, 0x20000370, 0x20000400, 0x20000490 };
+// Hashes to the first slot.
+static constexpr thread_id_t first_slot_id = 0x20000010;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static thread_id_t
+id_at (std::size_t i)
+{
+  return static_cast<thread_id_t> (0x20000000 + 0x100 * i);
+}
+
+static void
+check_missing (heap_target& heap)
+{
+  map_t map
+    { heap_target::api () };
+
+  expect (map.find (first_slot_id) == map_t::npos && map.size () == 0,
+          "empty map");
+  expect (heap.calls (server_function::malloc) == 0, "empty map no table");
+  map.clear ();
+  expect (!map.contains (first_slot_id), "empty map cleared");
+
+  map.insert (last_slot_ids[0], 0);
+  expect (map.find (last_slot_ids[1]) == map_t::npos,
+          "missing in a used slot");
+  expect (map.find (first_slot_id) == map_t::npos, "missing in a free slot");
+}
+
+static void
+check_collisions (void)
+{
+  map_t map
+    { heap_target::api () };
+
+  // The probes wrap to the first slots.
+  expect (map.insert (last_slot_ids[0], 10) == 0
+              && map.insert (last_slot_ids[1], 11) == 0
+              && map.insert (last_slot_ids[2], 12) == 0,
+          "colliding inserts");
+  expect (map.insert (first_slot_id, 20) == 0, "insert after wrap");
+  expect (map.size () == 4, "collisions size");
+  expect (map.find (last_slot_ids[0]) == 10
+              && map.find (last_slot_ids[1]) == 11
+              && map.find (last_slot_ids[2]) == 12
+              && map.find (first_slot_id) == 20,
+          "colliding found");
+  expect (map.find (last_slot_ids[3]) == map_t::npos,
+          "colliding missing");
+
+  // Replace, without a new entry.
+  expect (map.insert (last_slot_ids[2], 42) == 0 && map.size () == 4
+              && map.find (last_slot_ids[2]) == 42,
+          "index replaced");
+}
+
+static void
+check_clear (heap_target& heap)
+{
+  map_t map
+    { heap_target::api () };
+
+  thread_id_t ids[8];
+  for (std::size_t i = 0; i < 8; ++i)
+    {
+      ids[i] = id_at (i);
+    }
+  expect (map.rebuild (ids, 8) == 0 && map.size () == 8, "rebuild");
+  expect (map.find (ids[5]) == 5, "rebuilt found");
+
+  heap.clear_stats ();
+  map.clear ();
+  expect (heap.calls (server_function::malloc) == 0
+              && heap.calls (server_function::free) == 0,
+          "clear without server calls");
+  expect (map.size () == 0, "cleared size");
+  bool none = true;
+  for (std::size_t i = 0; i < 8; ++i)
+    {
+      none = none && !map.contains (ids[i]);
+    }
+  expect (none, "cleared entries gone");
+
+  // Old slots must not be taken as used.
+  expect (map.insert (ids[3], 0) == 0 && map.size () == 1
+              && map.find (ids[3]) == 0 && !map.contains (ids[2]),
+          "insert after clear");
+
+  // In reverse order, reusing the table.
+  thread_id_t reversed[8];
+  for (std::size_t i = 0; i < 8; ++i)
+    {
+      reversed[i] = ids[7 - i];
+    }
+  expect (map.rebuild (reversed, 8) == 0 && map.find (ids[0]) == 7
+              && map.find (ids[7]) == 0,
+          "rebuild again");
+  expect (heap.calls (server_function::malloc) == 0, "table reused");
+}
+
+static void
+check_growth (heap_target& heap)
+{
+  {
+    map_t map
+      { heap_target::api () };
+
+    heap.clear_stats ();
+    for (std::size_t i = 0; i < 16; ++i)
+      {
+        map.insert (id_at (i), i);
+      }
+    expect (heap.calls (server_function::malloc) == 1 && heap.blocks == 1,
+            "16 entries in 32 slots");
+
+    // Past 1/2.
+    expect (map.insert (id_at (16), 16) == 0, "insert 17");
+    expect (heap.calls (server_function::malloc) == 2
+                && heap.calls (server_function::free) == 1
+                && heap.blocks == 1,
+            "grown");
+    bool ok = true;
+    for (std::size_t i = 0; i <= 16; ++i)
+      {
+        ok = ok && map.find (id_at (i)) == i;
+      }
+    expect (ok && map.size () == 17, "entries kept when growing");
+
+    // The table cannot grow; the map stays usable.
+    heap.malloc_fails = true;
+    for (std::size_t i = 17; i < 32; ++i)
+      {
+        map.insert (id_at (i), i);
+      }
+    expect (map.insert (id_at (32), 32) < 0, "failed growth reported");
+    expect (map.size () == 32 && map.find (id_at (31)) == 31
+                && !map.contains (id_at (32)),
+            "usable after failed growth");
+
+    thread_id_t ids[40];
+    for (std::size_t i = 0; i < 40; ++i)
+      {
+        ids[i] = id_at (i);
+      }
+    expect (map.rebuild (ids, 40) < 0, "failed rebuild reported");
+    heap.malloc_fails = false;
+    expect (map.rebuild (ids, 40) == 0 && map.find (ids[39]) == 39,
+            "rebuild after failure");
+  }
+  expect (heap.blocks == 0, "table freed");
+}
+
+int
+main (void)
+{
+  heap_target heap;
+
+  check_missing (heap);
+  check_collisions ();
+  check_clear (heap);
+  check_growth (heap);
+
+  printf ("thread-map: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
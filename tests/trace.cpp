@@ -0,0 +1,325 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the memory traffic recorder and replayer, over the
+ * simulated target.
+ *
+ * A session recorded through `trace_recorder` must replay with the
+ * same data and results, record by record. Extra and missing
+ * accesses must be served from the image and resynchronised,
+ * and malformed traces must be rejected, leaving the replayer
+ * empty. Messages must reach the real server whole, long ones
+ * formatted in a block of the real server heap.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-trace.h>
+
+#include "output-capture.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace segger::drtm;
+
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 4096;
+
+// Not mapped in the simulated target.
+static constexpr target_addr_t bad_addr = 0x10000000;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+/**
+ * @brief The results of a session, to compare the recorded and
+ *  the replayed ones.
+ */
+struct session_t
+{
+  int ret[7];
+  uint8_t bytes[16];
+  uint8_t byte;
+  uint16_t half;
+  uint32_t word;
+  uint32_t word_after_write;
+};
+
+/**
+ * @brief A fixed sequence of accesses, including a failed read
+ *  and a write read back.
+ */
+static session_t
+run_session (const rtos_plugin_server_api_t* api)
+{
+  session_t s;
+  std::memset (&s, 0, sizeof(s));
+
+  s.ret[0] = api->read_byte_array (ram_base + 16, &s.bytes[0],
+                                   sizeof(s.bytes));
+  s.ret[1] = api->read_byte (ram_base + 3, &s.byte);
+  s.ret[2] = api->read_short (ram_base + 6, &s.half);
+  s.ret[3] = api->read_long (ram_base + 8, &s.word);
+  uint32_t unused;
+  s.ret[4] = api->read_long (bad_addr, &unused);
+  api->write_long (ram_base + 64, 0xCAFEF00D);
+  s.ret[5] = api->read_long (ram_base + 64, &s.word_after_write);
+  s.ret[6] = api->write_byte_array (ram_base + 128, &s.bytes[0],
+                                    sizeof(s.bytes));
+  return s;
+}
+
+static constexpr std::size_t session_records = 8;
+
+static std::vector<uint8_t>
+record_session (session_t* out)
+{
+  simulated_target target;
+  uint8_t* image = target.add_region (ram_base, ram_size_bytes);
+  for (std::size_t i = 0; i < ram_size_bytes; ++i)
+    {
+      image[i] = static_cast<uint8_t> (i * 7 + 1);
+    }
+
+  FILE* f = tmpfile ();
+  std::vector<uint8_t> data;
+  if (f == nullptr)
+    {
+      return data;
+    }
+  {
+    trace_recorder recorder
+      { simulated_target::api (), f };
+    *out = run_session (trace_recorder::api ());
+    expect (recorder.is_ok (), "recorder ok");
+    expect (recorder.records () == session_records, "recorder records");
+  }
+
+  rewind (f);
+  uint8_t buf[256];
+  std::size_t n;
+  while ((n = fread (buf, 1, sizeof(buf), f)) > 0)
+    {
+      data.insert (data.end (), buf, buf + n);
+    }
+  fclose (f);
+  return data;
+}
+
+static void
+check_round_trip (const std::vector<uint8_t>& trace,
+                  const session_t& recorded)
+{
+  trace_replayer replayer;
+  expect (replayer.load (trace) == 0, "load");
+  expect (replayer.records () == session_records, "replayer records");
+  expect (replayer.is_little_endian (), "replayer endianness");
+
+  session_t replayed = run_session (trace_replayer::api ());
+  expect (std::memcmp (&recorded, &replayed, sizeof(recorded)) == 0,
+          "round trip data");
+  expect (recorded.ret[4] < 0 && replayed.ret[4] < 0, "failed read kept");
+  expect (replayed.word_after_write == 0xCAFEF00D, "write read back");
+
+  const trace_replayer::replay_stats_t& stats = replayer.replay_stats ();
+  expect (stats.matched == session_records && stats.skipped == 0
+              && stats.from_image == 0 && stats.unknown == 0,
+          "round trip stats");
+
+  // Again, after a rewind.
+  replayer.rewind ();
+  replayed = run_session (trace_replayer::api ());
+  expect (std::memcmp (&recorded, &replayed, sizeof(recorded)) == 0,
+          "rewind data");
+}
+
+static void
+check_resync (const std::vector<uint8_t>& trace, const session_t& recorded)
+{
+  trace_replayer replayer;
+  expect (replayer.load (trace) == 0, "load");
+  const rtos_plugin_server_api_t* api = trace_replayer::api ();
+
+  // An extra access, not in the trace, served from the image of
+  // the bytes seen in the whole trace.
+  uint32_t word = 0;
+  expect (api->read_long (ram_base + 16, &word) == 0
+              && word == little_endian_codec::load_long (&recorded.bytes[0]),
+          "extra access");
+  expect (replayer.replay_stats ().from_image == 1
+              && replayer.replay_stats ().matched == 0,
+          "extra access stats");
+
+  // The first two records are not replayed; the third one must
+  // still match, skipping them.
+  uint16_t half = 0;
+  expect (api->read_short (ram_base + 6, &half) == 0 && half == recorded.half,
+          "resync");
+  expect (replayer.replay_stats ().matched == 1
+              && replayer.replay_stats ().skipped == 2,
+          "resync stats");
+
+  // Bytes never seen in the trace.
+  uint8_t byte;
+  expect (api->read_byte (ram_base + 1024, &byte) < 0, "unknown fails");
+  replayer.set_fill_unknown (true);
+  expect (api->read_byte (ram_base + 1024, &byte) == 0 && byte == 0,
+          "unknown filled");
+}
+
+static void
+check_rejected (const std::vector<uint8_t>& trace)
+{
+  trace_replayer replayer;
+
+  std::vector<uint8_t> bad_magic = trace;
+  bad_magic[0] ^= 1;
+  expect (replayer.load (bad_magic) < 0, "bad magic rejected");
+  expect (replayer.records () == 0, "bad magic empty");
+
+  // A large valid record followed by a truncated one, loaded over
+  // a valid trace; nothing of either trace may be used.
+  expect (replayer.load (trace) == 0, "load");
+
+  std::vector<uint8_t> bad (trace.begin (),
+                            trace.begin ()
+                                + trace_format::header_size_bytes);
+  const std::size_t big_bytes = 4000;
+  uint8_t r[trace_format::record_size_bytes] =
+    { };
+  r[trace_format::kind_offset] =
+      static_cast<uint8_t> (server_function::read_byte_array);
+  little_endian_codec::store (&r[trace_format::addr_offset],
+                              uint32_t (ram_base));
+  little_endian_codec::store (&r[trace_format::length_offset],
+                              uint32_t (big_bytes));
+  bad.insert (bad.end (), r, r + sizeof(r));
+  bad.insert (bad.end (), big_bytes, 0x55);
+  bad.insert (bad.end (), r, r + sizeof(r) - 1);
+
+  expect (replayer.load (bad) < 0, "truncated rejected");
+  expect (replayer.records () == 0, "truncated empty");
+
+  std::vector<uint8_t> out (big_bytes);
+  expect (trace_replayer::api ()->read_byte_array (ram_base, out.data (),
+                                                   big_bytes) < 0,
+          "read after rejected load");
+
+  // A record longer than the data left.
+  std::vector<uint8_t> short_data (bad.begin (),
+                                   bad.begin ()
+                                       + trace_format::header_size_bytes
+                                       + sizeof(r) + big_bytes - 1);
+  expect (replayer.load (short_data) < 0, "short data rejected");
+  expect (replayer.records () == 0, "short data empty");
+}
+
+static void
+check_messages (output_capture& capture, trace_recorder& recorder)
+{
+  const rtos_plugin_server_api_t* api = trace_recorder::api ();
+
+  api->output_warning ("short %d", 1);
+  expect (capture.messages.size () == 1
+              && capture.messages[0].channel == server_function::output_warning
+              && capture.messages[0].text == "short 1",
+          "short message forwarded");
+  expect (capture.calls (server_function::malloc) == 0,
+          "short message on the stack");
+
+  std::string text (1000, 'x');
+  api->output_debug ("%s%%", text.c_str ());
+  text += '%';
+  expect (capture.messages.size () == 2
+              && capture.messages[1].channel == server_function::output_debug
+              && capture.messages[1].text == text,
+          "long message not truncated");
+  expect (capture.calls (server_function::malloc) == 1
+              && capture.calls (server_function::free) == 1,
+          "long message on the server heap");
+  expect (recorder.records () == 0, "messages not recorded");
+}
+
+static void
+check_output (void)
+{
+  output_capture capture;
+  FILE* f = tmpfile ();
+  {
+    trace_recorder recorder
+      { output_capture::api (), f };
+    check_messages (capture, recorder);
+  }
+  if (f != nullptr)
+    {
+      fclose (f);
+    }
+}
+
+int
+main (void)
+{
+  session_t recorded;
+  std::vector<uint8_t> trace = record_session (&recorded);
+  expect (trace.size () > trace_format::header_size_bytes, "trace written");
+
+  if (failures == 0)
+    {
+      check_round_trip (trace, recorded);
+      check_resync (trace, recorded);
+      check_rejected (trace);
+    }
+  check_output ();
+
+  printf ("trace: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
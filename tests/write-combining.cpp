@@ -0,0 +1,242 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2017 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The plug-in client API definitions (the `RTOS_*` functions) and the
+ * GDB server API definitions are compatible with the SEGGER GDBServer
+ * RTOS Plug-in SDK API definitions.
+ *
+ * All IP rights, title and interest in the GDBServer RTOS Plug-in SDK
+ * are and shall at all times remain with SEGGER.
+ *
+ * Copyright (c) 2004-2016 SEGGER Microcontroller GmbH & Co. KG
+ * Internet: www.segger.com        Support:  support@segger.com
+ */
+
+/*
+ * Checks of the backend write combining, over the simulated target.
+ *
+ * Writes collected between `begin_writes()` and `commit_writes()`
+ * must be merged into one transaction per contiguous range, with
+ * later writes winning, and ranges separated by gaps must stay
+ * apart. Sized writes must keep their access width, discarded
+ * writes must not reach the target, and cached reads of written
+ * lines must be dropped.
+ */
+
+#include <segger-jlink-rtos-plugin-sdk/drtm-backend.h>
+#include <segger-jlink-rtos-plugin-sdk/drtm-simulated-target.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace segger::drtm;
+
+using backend_t = backend<rtos_plugin_server_api_t, rtos_plugin_symbols_t>;
+using target_addr_t = rtos_plugin_target_addr_t;
+
+static constexpr target_addr_t ram_base = 0x20000000;
+static constexpr std::size_t ram_size_bytes = 1024;
+
+static int failures = 0;
+
+static void
+expect (bool condition, const char* what)
+{
+  if (!condition)
+    {
+      printf ("FAILED %s\n", what);
+      ++failures;
+    }
+}
+
+static const uint8_t ones[8] =
+  { 1, 1, 1, 1, 1, 1, 1, 1 };
+static const uint8_t twos[8] =
+  { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+static void
+check_merge (simulated_target& target, uint8_t* image, backend_t& backend)
+{
+  std::memset (image, 0, ram_size_bytes);
+  target.clear_stats ();
+
+  // Overlapping, issued out of address order; the later wins.
+  backend.begin_writes ();
+  expect (backend.write_byte_array (ram_base + 4, twos, 8) == 0, "queue");
+  expect (backend.write_byte_array (ram_base, ones, 8) == 0, "queue");
+  // Touching the previous range.
+  expect (backend.write_byte_array (ram_base + 12, ones, 4) == 0, "queue");
+  // Separated by a gap.
+  expect (backend.write_byte_array (ram_base + 64, twos, 4) == 0, "queue");
+  expect (target.transactions () == 0, "nothing written before commit");
+
+  expect (backend.commit_writes () == 0, "commit");
+  expect (!backend.is_write_combining (), "commit ends the batch");
+  expect (target.transactions () == 2
+              && target.calls (server_function::write_byte_array) == 2,
+          "one transaction per range");
+
+  const uint8_t expected[16] =
+    { 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 1, 1 };
+  expect (std::memcmp (image, expected, sizeof(expected)) == 0,
+          "later writes win");
+  expect (image[16] == 0 && image[63] == 0, "gap not written");
+  expect (std::memcmp (image + 64, twos, 4) == 0, "second range");
+
+  // A write to the same address, twice.
+  target.clear_stats ();
+  backend.begin_writes ();
+  backend.write_byte_array (ram_base + 128, ones, 4);
+  backend.write_byte_array (ram_base + 128, twos, 4);
+  expect (backend.commit_writes () == 0 && target.transactions () == 1
+              && std::memcmp (image + 128, twos, 4) == 0,
+          "same address, later wins");
+}
+
+static void
+check_widths (simulated_target& target, uint8_t* image, backend_t& backend)
+{
+  std::memset (image, 0, ram_size_bytes);
+
+  // Without a batch, the sized server functions are used.
+  target.clear_stats ();
+  backend.write_long (ram_base, 0x11223344);
+  backend.write_short (ram_base + 4, 0x5566);
+  backend.write_byte (ram_base + 6, 0x77);
+  expect (target.calls (server_function::write_long) == 1
+              && target.calls (server_function::write_short) == 1
+              && target.calls (server_function::write_byte) == 1
+              && target.calls (server_function::write_byte_array) == 0,
+          "direct sized writes");
+  expect (little_endian_codec::load_long (image) == 0x11223344
+              && little_endian_codec::load_short (image + 4) == 0x5566
+              && image[6] == 0x77,
+          "direct sized values");
+
+  // In a batch, sized writes keep their width and their order,
+  // even next to an array write.
+  target.clear_stats ();
+  backend.begin_writes ();
+  backend.write_byte_array (ram_base + 32, ones, 8);
+  backend.write_long (ram_base + 36, 0xAABBCCDD);
+  backend.write_short (ram_base + 38, 0x1234);
+  expect (backend.commit_writes () == 0, "commit sized");
+  expect (target.calls (server_function::write_long) == 1
+              && target.calls (server_function::write_short) == 1
+              && target.calls (server_function::write_byte_array) == 1,
+          "batched sized writes keep their width");
+  expect (little_endian_codec::load_long (image + 32) == 0x01010101
+              && little_endian_codec::load_long (image + 36) == 0x1234CCDD,
+          "batched sized writes in order");
+
+  // The checked variants report errors.
+  expect (backend.write_long_checked (0x10000000, 1) < 0,
+          "checked write fails");
+  expect (backend.write_long_checked (ram_base + 40, 0xCAFEF00D) == 0
+              && little_endian_codec::load_long (image + 40) == 0xCAFEF00D,
+          "checked write");
+}
+
+static void
+check_discard (simulated_target& target, uint8_t* image, backend_t& backend)
+{
+  std::memset (image, 0, ram_size_bytes);
+  target.clear_stats ();
+
+  backend.begin_writes ();
+  backend.write_byte_array (ram_base, ones, 8);
+  backend.write_long (ram_base + 8, 0xFFFFFFFF);
+  backend.discard_writes ();
+  expect (!backend.is_write_combining (), "discard ends the batch");
+  expect (backend.commit_writes () == 0, "commit after discard");
+  expect (target.transactions () == 0 && image[0] == 0 && image[8] == 0,
+          "discarded writes not written");
+
+  // The guard commits when leaving the scope.
+  {
+    backend_t::write_guard guard
+      { backend };
+    backend.write_byte_array (ram_base, ones, 8);
+    expect (target.transactions () == 0, "guard collects");
+  }
+  expect (target.transactions () == 1 && image[0] == 1, "guard commits");
+
+  // Failures are reported; the other ranges are still written.
+  backend.begin_writes ();
+  backend.write_byte_array (0x10000000, ones, 4);
+  backend.write_byte_array (ram_base + 100, twos, 4);
+  expect (backend.commit_writes () < 0 && image[100] == 2,
+          "failed range reported");
+}
+
+static void
+check_cache (simulated_target& target, uint8_t* image, backend_t& backend)
+{
+  std::memset (image, 0, ram_size_bytes);
+  expect (backend.enable_cache (64, 16) == 0, "enable cache");
+
+  uint32_t value = 1;
+  expect (backend.read_long (ram_base + 200, &value) == 0 && value == 0,
+          "cached read");
+
+  backend.begin_writes ();
+  backend.write_long (ram_base + 200, 0x12345678);
+  // Not seen before the commit.
+  backend.read_long (ram_base + 200, &value);
+  expect (value == 0, "pending writes not visible");
+  backend.commit_writes ();
+
+  target.clear_stats ();
+  expect (backend.read_long (ram_base + 200, &value) == 0
+              && value == 0x12345678,
+          "written line dropped");
+  expect (target.transactions () == 1, "line read again");
+
+  backend.disable_cache ();
+}
+
+int
+main (void)
+{
+  simulated_target target;
+  uint8_t* image = target.add_region (ram_base, ram_size_bytes);
+
+  static rtos_plugin_symbols_t symbols[] =
+    {
+      { nullptr, 0, 0 } };
+  backend_t backend
+    { simulated_target::api (), symbols };
+
+  check_merge (target, image, backend);
+  check_widths (target, image, backend);
+  check_discard (target, image, backend);
+  check_cache (target, image, backend);
+
+  printf ("write-combining: %s\n", (failures == 0) ? "passed" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}